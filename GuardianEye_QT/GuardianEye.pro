@@ -1,35 +1,85 @@
-QT       += core gui
+QT       += core gui network
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+# qmake CONFIG+=headless：不連結 QtWidgets、不編入 MainWindow，只能以無頭模式執行
+headless {
+    DEFINES += GUARDIAN_HEADLESS_ONLY
+} else {
+    greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+    SOURCES += mainwindow.cpp
+    HEADERS += mainwindow.h
+    FORMS += mainwindow.ui
+}
 
 CONFIG += c++17
 
+# 追蹤 span 預設編入 (執行期關閉)；qmake CONFIG+=notrace 可完全移除
+!notrace: DEFINES += GUARDIAN_TRACING
+
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
     main.cpp \
-    mainwindow.cpp \
+    guardiancore.cpp \
+    inferencebackend.cpp \
     pythonaimanager.cpp \
+    aiworkerprocess.cpp \
+    nativeinferencebackend.cpp \
     securitycontroller.cpp \
     blackboxinterface.cpp \
     mcp3008interface.cpp \
     environmentalcontroller.cpp \
-    emergencycontroller.cpp
+    emergencycontroller.cpp \
+    sensoracquisition.cpp \
+    signalfilter.cpp \
+    gpiomanager.cpp \
+    detectionfusion.cpp \
+    alarmstatemachine.cpp \
+    alarmactuator.cpp \
+    faceindex.cpp \
+    mjpegaviwriter.cpp \
+    eventrecorder.cpp \
+    snapshotservice.cpp \
+    httpserver.cpp \
+    mjpegstreamer.cpp \
+    statushub.cpp \
+    metrics.cpp \
+    tracing.cpp \
+    workerstream.cpp \
+    timerwheel.cpp
 
 HEADERS += \
-    mainwindow.h \
+    guardiancore.h \
+    inferencebackend.h \
     pythonaimanager.h \
+    aiworkerprocess.h \
+    nativeinferencebackend.h \
     securitycontroller.h \
     blackboxinterface.h \
     mcp3008interface.h \
     environmentalcontroller.h \
     hardwareinterface.h \
-    emergencycontroller.h
-
-FORMS += \
-    mainwindow.ui
+    emergencycontroller.h \
+    sensoracquisition.h \
+    signalfilter.h \
+    gpiomanager.h \
+    detectionfusion.h \
+    alarmstatemachine.h \
+    alarmactuator.h \
+    faceindex.h \
+    mjpegaviwriter.h \
+    eventrecorder.h \
+    snapshotservice.h \
+    httpserver.h \
+    mjpegstreamer.h \
+    statushub.h \
+    metrics.h \
+    tracing.h \
+    workerstream.h \
+    timerwheel.h \
+    mpscqueue.h \
+    spscring.h
 
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
@@ -37,4 +87,4 @@ else: unix:!android: target.path = /opt/$${TARGET}/bin
 !isEmpty(target.path): INSTALLS += target
 
 INCLUDEPATH += /usr/include/opencv4
-LIBS += -L/usr/lib/aarch64-linux-gnu -lopencv_core -lopencv_imgproc -lopencv_highgui -lopencv_videoio
+LIBS += -L/usr/lib/aarch64-linux-gnu -lopencv_core -lopencv_imgproc -lopencv_highgui -lopencv_videoio -lopencv_dnn
@@ -0,0 +1,177 @@
+#include "aiworkerprocess.h"
+#include "metrics.h"
+#include "tracing.h"
+#include "workerstream.h"
+#include <QDebug>
+#include <QJsonDocument>
+
+AiWorkerProcess::AiWorkerProcess(QObject *parent)
+    : QObject(parent), m_process(new QProcess(this)) {
+  connect(m_process, &QProcess::readyReadStandardOutput, this,
+          &AiWorkerProcess::handleReadyRead);
+
+  connect(m_process, &QProcess::readyReadStandardError, this, [this]() {
+    QByteArray err = m_process->readAllStandardError();
+    qDebug() << "Python Error Log:" << err;
+  });
+
+  connect(m_process,
+          QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+          &AiWorkerProcess::handleFinished);
+  connect(m_process, &QProcess::errorOccurred, this,
+          [this](QProcess::ProcessError error) {
+            // 程式無法執行時不會有 finished 訊號
+            if (error == QProcess::FailedToStart) {
+              qDebug() << "AiWorkerProcess: 無法啟動 python3";
+              setState(Stopped);
+              emit exited(-1, true);
+            }
+          });
+}
+
+AiWorkerProcess::~AiWorkerProcess() {
+  m_process->disconnect(this);
+  terminate();
+}
+
+void AiWorkerProcess::start(const QString &workingDir, const QString &script,
+                            const QString &cameraIndex, bool standby) {
+  if (m_state != Stopped)
+    return;
+
+  QStringList arguments;
+  arguments << script << "--qt_mode" << "--camera" << cameraIndex;
+  if (standby)
+    arguments << "--standby";
+
+  m_buffer.clear();
+  m_stopping = false;
+  m_process->setWorkingDirectory(workingDir);
+  m_process->start("python3", arguments);
+  m_started.start();
+  m_activity.start();
+  setState(Loading);
+}
+
+void AiWorkerProcess::activate() {
+  if (m_state != Standby)
+    return;
+  sendCommand(QJsonObject{{"cmd", "activate"}});
+  // 攝影機開啟前沒有影格，從現在起重新計算心跳
+  m_activity.restart();
+  setState(Loading);
+}
+
+bool AiWorkerProcess::sendCommand(const QJsonObject &cmd) {
+  if (m_process->state() != QProcess::Running)
+    return false;
+  QByteArray line = QJsonDocument(cmd).toJson(QJsonDocument::Compact);
+  line.append('\n');
+  return m_process->write(line) == line.size();
+}
+
+void AiWorkerProcess::terminate(int timeoutMs) {
+  if (m_process->state() == QProcess::NotRunning)
+    return;
+  m_stopping = true;
+  m_process->terminate();
+  if (!m_process->waitForFinished(timeoutMs)) {
+    m_process->kill();
+    m_process->waitForFinished(1000);
+  }
+}
+
+void AiWorkerProcess::kill() {
+  if (m_process->state() == QProcess::NotRunning)
+    return;
+  // 不等待：結束後由 finished 訊號通知
+  m_process->kill();
+}
+
+void AiWorkerProcess::setState(State state) {
+  if (m_state == state)
+    return;
+  m_state = state;
+  emit stateChanged(state);
+}
+
+void AiWorkerProcess::handleReadyRead() {
+  const QByteArray chunk = m_process->readAllStandardOutput();
+  if (m_recorder)
+    m_recorder->write(chunk);
+  feed(chunk);
+}
+
+void AiWorkerProcess::feed(const QByteArray &chunk) {
+  static MetricCounter &bytes = MetricsRegistry::instance().counter(
+      "guardian_ai_stdout_bytes_total", "Bytes read from the AI worker stdout");
+  static MetricCounter &lines = MetricsRegistry::instance().counter(
+      "guardian_ai_lines_total", "Lines parsed from the AI worker stdout");
+  // 邏輯執行緒內的整段同步處理 (切行、JSON、解碼、偵測分派)；繪圖在 GUI 執行緒
+  static MetricHistogram &chunkTime = MetricsRegistry::instance().histogram(
+      "guardian_ai_chunk_seconds",
+      "Time to process one stdout chunk through the logic-thread pipeline");
+
+  TRACE_SCOPE("ai.ipc_read");
+  MetricTimer timer(chunkTime);
+  bytes.inc(quint64(chunk.size()));
+  m_buffer.append(chunk);
+  int newlineIndex;
+  while ((newlineIndex = m_buffer.indexOf('\n')) != -1) {
+    QByteArray line = m_buffer.left(newlineIndex).trimmed();
+    m_buffer.remove(0, newlineIndex + 1);
+    if (!line.isEmpty()) {
+      lines.inc();
+      parseLine(line);
+    }
+  }
+}
+
+void AiWorkerProcess::parseLine(const QByteArray &line) {
+  static MetricCounter &nonJson = MetricsRegistry::instance().counter(
+      "guardian_ai_log_lines_total",
+      "Non-JSON lines from the AI worker (plain log output)");
+  static MetricHistogram &parseTime = MetricsRegistry::instance().histogram(
+      "guardian_ai_decode_seconds", "Time spent decoding preview frames",
+      "stage=\"json\"");
+
+  QJsonParseError error;
+  QJsonDocument doc;
+  {
+    TRACE_SCOPE("ai.json_parse");
+    MetricTimer timer(parseTime);
+    doc = QJsonDocument::fromJson(line, &error);
+  }
+  if (error.error != QJsonParseError::NoError) {
+    nonJson.inc();
+    // 如果不是 JSON，則當作普通日誌輸出 (不算心跳，卡住的讀取迴圈仍會印警告)
+    QString rawLine = QString::fromUtf8(line).trimmed();
+    if (!rawLine.isEmpty()) {
+      qDebug() << "Python AI Log:" << rawLine;
+    }
+    return;
+  }
+
+  QJsonObject obj = doc.object();
+  if (obj.contains("seq") || obj.contains("status"))
+    m_activity.restart();
+
+  if (obj.contains("status")) {
+    QString status = obj["status"].toString();
+    if (status == "standby")
+      setState(Standby);
+    else if (status == "running")
+      setState(Running);
+  }
+
+  emit messageReceived(obj);
+}
+
+void AiWorkerProcess::handleFinished(int exitCode,
+                                     QProcess::ExitStatus exitStatus) {
+  bool crashed = !m_stopping && !(exitStatus == QProcess::NormalExit &&
+                                  exitCode == 0);
+  m_stopping = false;
+  setState(Stopped);
+  emit exited(exitCode, crashed);
+}
@@ -0,0 +1,72 @@
+#ifndef AIWORKERPROCESS_H
+#define AIWORKERPROCESS_H
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QObject>
+#include <QProcess>
+
+class WorkerStreamRecorder;
+
+/**
+ * AiWorkerProcess
+ * 單一 vision_system.py 子行程的包裝：逐行解析 stdout 的 JSON、
+ * 追蹤生命週期 (Loading -> Standby -> Running) 與最後一次心跳，
+ * 並透過 stdin 傳送 JSON 指令 (例如 {"cmd":"activate"})
+ */
+class AiWorkerProcess : public QObject {
+  Q_OBJECT
+public:
+  enum State { Stopped, Loading, Standby, Running };
+  Q_ENUM(State)
+
+  explicit AiWorkerProcess(QObject *parent = nullptr);
+  ~AiWorkerProcess();
+
+  // standby = true 時只載入模型，等待 activate() 才開啟攝影機
+  void start(const QString &workingDir, const QString &script,
+             const QString &cameraIndex, bool standby);
+  void activate();
+  bool sendCommand(const QJsonObject &cmd);
+  void terminate(int timeoutMs = 3000);
+  void kill();
+
+  // 設定後，每次從 stdout 讀到的原始區塊都先寫入錄製檔 (不轉移擁有權)
+  void setRecorder(WorkerStreamRecorder *recorder) { m_recorder = recorder; }
+  // 餵入一段 stdout 原始資料：切行、解析 JSON 並送出 messageReceived；
+  // 重播錄製檔時不啟動行程，直接以此餵入
+  void feed(const QByteArray &chunk);
+
+  State state() const { return m_state; }
+  qint64 pid() const { return m_process->processId(); }
+  // 距離上一個影格 (含 seq 的 JSON) 或狀態訊息的時間；啟動前回傳 -1
+  qint64 msSinceActivity() const {
+    return m_activity.isValid() ? m_activity.elapsed() : -1;
+  }
+  qint64 msSinceStart() const {
+    return m_started.isValid() ? m_started.elapsed() : -1;
+  }
+
+signals:
+  void messageReceived(const QJsonObject &obj);
+  void stateChanged(AiWorkerProcess::State state);
+  void exited(int exitCode, bool crashed);
+
+private slots:
+  void handleReadyRead();
+  void handleFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+private:
+  QProcess *m_process;
+  QByteArray m_buffer;
+  State m_state = Stopped;
+  bool m_stopping = false;
+  QElapsedTimer m_activity;
+  QElapsedTimer m_started;
+  WorkerStreamRecorder *m_recorder = nullptr;
+
+  void setState(State state);
+  void parseLine(const QByteArray &line);
+};
+
+#endif // AIWORKERPROCESS_H
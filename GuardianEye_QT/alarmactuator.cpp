@@ -0,0 +1,152 @@
+#include "alarmactuator.h"
+#include "hardwareinterface.h"
+#include "metrics.h"
+#include "tracing.h"
+#include <QDebug>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+const int AlarmActuator::OWNED_PINS[AlarmActuator::OWNED_PIN_COUNT] = {
+    LED_RED, LED_BLUE, BUZZER};
+
+static qint64 monotonicNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return qint64(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+AlarmActuator::AlarmActuator(QObject *parent) : QThread(parent) {
+  for (int i = 0; i < OWNED_PIN_COUNT; i++)
+    m_pinValue[i] = -1;
+
+  m_blackboxFd = hardwareSimulated() ? -1 : open("/dev/blackbox", O_RDWR);
+  if (m_blackboxFd < 0 && !hardwareSimulated())
+    qDebug() << "AlarmActuator: 無法開啟 /dev/blackbox";
+  m_wakeFd = eventfd(0, EFD_CLOEXEC);
+}
+
+AlarmActuator::~AlarmActuator() {
+  stop();
+  wait();
+  if (m_wakeFd >= 0)
+    close(m_wakeFd);
+  if (m_blackboxFd >= 0)
+    close(m_blackboxFd);
+}
+
+bool AlarmActuator::lockMemory() {
+  if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+    qDebug() << "AlarmActuator: mlockall 失敗 (需要 CAP_IPC_LOCK)";
+    return false;
+  }
+  return true;
+}
+
+int AlarmActuator::pinIndex(int pin) {
+  for (int i = 0; i < OWNED_PIN_COUNT; i++) {
+    if (OWNED_PINS[i] == pin)
+      return i;
+  }
+  return -1;
+}
+
+bool AlarmActuator::ownsPin(int pin) { return pinIndex(pin) >= 0; }
+
+int AlarmActuator::knownValue(int pin) const {
+  int idx = pinIndex(pin);
+  return idx >= 0 ? m_pinValue[idx].load() : -1;
+}
+
+void AlarmActuator::setKnownValue(int pin, int value) {
+  int idx = pinIndex(pin);
+  if (idx >= 0)
+    m_pinValue[idx] = value;
+}
+
+bool AlarmActuator::submit(int pin, int value) {
+  Command cmd;
+  cmd.pin = pin;
+  cmd.value = value;
+  cmd.submitNs = monotonicNs();
+  if (!m_queue.push(cmd)) {
+    static MetricCounter &dropped = MetricsRegistry::instance().counter(
+        "guardian_alarm_actuator_dropped_total",
+        "Alarm GPIO commands dropped because the queue was full");
+    dropped.inc();
+    m_dropped++;
+    return false;
+  }
+  setKnownValue(pin, value);
+
+  uint64_t one = 1;
+  if (m_wakeFd >= 0)
+    (void)write(m_wakeFd, &one, sizeof(one));
+  return true;
+}
+
+void AlarmActuator::stop() {
+  m_running = false;
+  uint64_t one = 1;
+  if (m_wakeFd >= 0)
+    (void)write(m_wakeFd, &one, sizeof(one));
+}
+
+ActuatorStats AlarmActuator::stats() const {
+  ActuatorStats st;
+  st.commands = m_commands;
+  st.dropped = m_dropped;
+  st.lastLatencyNs = m_lastLatencyNs;
+  st.maxLatencyNs = m_maxLatencyNs;
+  return st;
+}
+
+void AlarmActuator::run() {
+  if (m_realtime) {
+    struct sched_param param;
+    param.sched_priority = m_priority;
+    int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (err != 0)
+      qDebug() << "AlarmActuator: 無法設定 SCHED_FIFO (錯誤" << err
+               << ")，使用一般排程";
+  }
+
+  // 在進入即時迴圈前註冊好指標，迴圈內只剩原子操作
+  MetricHistogram &latencyMetric = MetricsRegistry::instance().histogram(
+      "guardian_alarm_actuator_latency_seconds",
+      "Alarm GPIO latency from submit() to the blackbox ioctl returning");
+  Tracer::registerThread(); // 追蹤緩衝區也預先配置
+
+  struct pollfd pfd;
+  pfd.fd = m_wakeFd;
+  pfd.events = POLLIN;
+
+  while (m_running) {
+    if (poll(&pfd, 1, -1) < 0)
+      continue;
+    uint64_t count;
+    (void)read(m_wakeFd, &count, sizeof(count));
+
+    Command cmd;
+    while (m_queue.pop(cmd)) {
+      if (m_blackboxFd >= 0) {
+        struct gpio_command g;
+        g.pin = cmd.pin;
+        g.value = cmd.value;
+        TRACE_SCOPE("actuator.ioctl");
+        ioctl(m_blackboxFd, SET_GPIO_VALUE, &g);
+      }
+      qint64 latency = monotonicNs() - cmd.submitNs;
+      latencyMetric.observe(latency / 1e9);
+      m_commands++;
+      m_lastLatencyNs = latency;
+      if (latency > m_maxLatencyNs)
+        m_maxLatencyNs = latency;
+    }
+  }
+}
@@ -0,0 +1,74 @@
+#ifndef ALARMACTUATOR_H
+#define ALARMACTUATOR_H
+
+#include "mpscqueue.h"
+#include <QThread>
+#include <atomic>
+
+struct ActuatorStats {
+  quint64 commands = 0;
+  quint64 dropped = 0; // 佇列已滿
+  qint64 lastLatencyNs = 0;
+  qint64 maxLatencyNs = 0;
+};
+
+/**
+ * AlarmActuator
+ * 警報關鍵 GPIO (LED_RED/LED_BLUE/BUZZER) 的專屬高優先權執行緒：
+ * 自行開啟 /dev/blackbox，從預先配置的無鎖佇列取指令並立即寫入，
+ * 即使 GUI 執行緒被對話框或大量影格卡住，入侵到亮燈/鳴叫的延遲仍有上限
+ */
+class AlarmActuator : public QThread {
+  Q_OBJECT
+public:
+  explicit AlarmActuator(QObject *parent = nullptr);
+  ~AlarmActuator();
+
+  // 需在 start() 前設定；SCHED_FIFO 需要 CAP_SYS_NICE，失敗時維持一般排程
+  void setRealtime(bool enabled, int priority = 80) {
+    m_realtime = enabled;
+    m_priority = priority;
+  }
+  static bool lockMemory(); // mlockall，避免警報路徑發生 page fault
+
+  static bool ownsPin(int pin);
+
+  // 任意執行緒呼叫，不上鎖、不配置記憶體
+  bool submit(int pin, int value);
+  void stop();
+
+  // 最後一次送出的值 (-1 = 未知)，供 GpioManager 判斷是否為重複寫入
+  int knownValue(int pin) const;
+  void setKnownValue(int pin, int value);
+
+  ActuatorStats stats() const;
+
+protected:
+  void run() override;
+
+private:
+  struct Command {
+    int pin;
+    int value;
+    qint64 submitNs;
+  };
+
+  static const int OWNED_PIN_COUNT = 3;
+  static const int OWNED_PINS[OWNED_PIN_COUNT];
+  static int pinIndex(int pin);
+
+  MpscQueue<Command, 64> m_queue;
+  std::atomic<int> m_pinValue[OWNED_PIN_COUNT];
+  std::atomic<bool> m_running{true};
+  int m_blackboxFd = -1;
+  int m_wakeFd = -1;
+  bool m_realtime = false;
+  int m_priority = 80;
+
+  std::atomic<quint64> m_commands{0};
+  std::atomic<quint64> m_dropped{0};
+  std::atomic<qint64> m_lastLatencyNs{0};
+  std::atomic<qint64> m_maxLatencyNs{0};
+};
+
+#endif // ALARMACTUATOR_H
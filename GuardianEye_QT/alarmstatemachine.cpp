@@ -0,0 +1,172 @@
+#include "alarmstatemachine.h"
+#include "alarmactuator.h"
+#include "hardwareinterface.h"
+#include "metrics.h"
+#include "tracing.h"
+#include "securitycontroller.h"
+#include <QDebug>
+
+AlarmStateMachine::AlarmStateMachine(SecurityController *security,
+                                     QObject *parent)
+    : QObject(parent), m_security(security) {
+  qRegisterMetaType<AlarmStateMachine::State>("AlarmStateMachine::State");
+  qRegisterMetaType<DetectionEvent>("DetectionEvent");
+
+  m_elapsed.start();
+  m_clock = [this]() { return m_elapsed.nsecsElapsed(); };
+
+  // 預設值沿用原本 MainWindow 的冷卻時間：警報 60 秒、主人 10 秒
+  setRateLimit("pig", 1, 60);
+  setRateLimit("stranger", 1, 60);
+  setRateLimit("owner", 1, 10);
+}
+
+void AlarmStateMachine::setRateLimit(const QString &type, double capacity,
+                                     double refillSeconds) {
+  TokenBucket bucket;
+  bucket.capacity = capacity;
+  bucket.tokens = capacity;
+  bucket.refillPerNs = refillSeconds > 0 ? 1.0 / (refillSeconds * 1e9) : 0;
+  bucket.lastNs = m_clock();
+  m_buckets.insert(type, bucket);
+}
+
+bool AlarmStateMachine::takeToken(const QString &type) {
+  auto it = m_buckets.find(type);
+  if (it == m_buckets.end())
+    return true;
+
+  TokenBucket &b = it.value();
+  qint64 now = m_clock();
+  qint64 elapsed = qMax<qint64>(0, now - b.lastNs);
+  b.tokens = qMin(b.capacity, b.tokens + elapsed * b.refillPerNs);
+  b.lastNs = now;
+  if (b.tokens < 1.0) {
+    static MetricCounter &limited = MetricsRegistry::instance().counter(
+        "guardian_alarm_rate_limited_total",
+        "Detections suppressed by the per-type alarm rate limit");
+    limited.inc();
+    m_rateLimited++;
+    return false;
+  }
+  b.tokens -= 1.0;
+  return true;
+}
+
+void AlarmStateMachine::transition(State to, const QString &reason) {
+  if (to == m_state)
+    return;
+  State from = m_state;
+  m_state = to;
+  m_transitions++;
+  static MetricCounter &transitions = MetricsRegistry::instance().counter(
+      "guardian_alarm_transitions_total", "Alarm state machine transitions");
+  static MetricGauge &stateGauge = MetricsRegistry::instance().gauge(
+      "guardian_alarm_state",
+      "Alarm state (0 Idle, 1 StrangerAlarm, 2 PigCountdown, 3 Exploded)");
+  transitions.inc();
+  stateGauge.set(to);
+
+  if (to == Idle)
+    m_remoteCodeIssued = false;
+  // 警報期間鎖定主密碼，必須走遠端授權 + 現場隨機碼
+  if (m_security)
+    m_security->setAlarmActive(to != Idle);
+
+  emit stateChanged(from, to, reason);
+}
+
+void AlarmStateMachine::raise(const QString &type, const QString &reason) {
+  if (type == "pig") {
+    // 炸彈已啟動 (或已爆炸) 時不再重複觸發
+    if (m_state == PigCountdown || m_state == Exploded)
+      return;
+    transition(PigCountdown, reason);
+    if (m_actuator) {
+      m_actuator->submit(LED_RED, 1);
+      if (!m_muted)
+        m_actuator->submit(BUZZER, 1);
+    }
+  } else if (type == "stranger") {
+    // 陌生人警報不覆蓋更高等級的豬豬警報
+    if (m_state == Idle)
+      transition(StrangerAlarm, reason);
+    if (m_actuator)
+      m_actuator->submit(LED_BLUE, 1);
+  } else {
+    return;
+  }
+  // 警報種類只有少數幾種，查表成本只發生在警報當下
+  MetricsRegistry::instance()
+      .counter("guardian_alarm_raised_total", "Alarms raised by type",
+               QString("type=\"%1\"").arg(type))
+      .inc();
+  emit alarmRaised(type);
+}
+
+void AlarmStateMachine::handleDetection(const DetectionEvent &event) {
+  TRACE_SCOPE("alarm.handleDetection");
+  m_decisions++;
+  m_eventTimeNs = event.timestampMs * 1000000LL;
+  if (!event.entered)
+    return;
+
+  // 豬豬警報在倒數中直接忽略，不消耗 token
+  if (event.type == "pig" && (m_state == PigCountdown || m_state == Exploded))
+    return;
+  if (!takeToken(event.type))
+    return;
+
+  if (event.type == "owner") {
+    emit ownerArrived();
+  } else {
+    raise(event.type, QString("AI 偵測: %1 (%2)")
+                          .arg(event.type)
+                          .arg(event.peakConfidence, 0, 'f', 2));
+  }
+}
+
+void AlarmStateMachine::handleManualTrigger(const QString &type) {
+  TRACE_SCOPE("alarm.handleManualTrigger");
+  m_decisions++;
+  raise(type, QString("手動觸發: %1").arg(type));
+}
+
+void AlarmStateMachine::handlePasswordVerified(bool success) {
+  TRACE_SCOPE("alarm.handlePasswordVerified");
+  m_decisions++;
+  if (!success)
+    return;
+
+  // 已爆炸時驅動倒數已結束，沿用原行為改走開門流程
+  bool wasPig = (m_state == PigCountdown);
+  transition(Idle, "驗證成功");
+  emit unlockGranted(wasPig);
+}
+
+void AlarmStateMachine::handleRemoteUnlock() {
+  m_decisions++;
+  // 僅在警報中、且本次警報尚未發過驗證碼時產生
+  if (m_state == Idle || m_remoteCodeIssued || !m_security)
+    return;
+
+  m_remoteCodeIssued = true;
+  QString code = m_security->generateRandomCode(false); // 不在本地顯示驗證碼
+  emit remoteCodeGenerated(code);
+}
+
+void AlarmStateMachine::handleBombExploded() {
+  m_decisions++;
+  transition(Exploded, "倒數結束");
+}
+
+void AlarmStateMachine::handleBombDisarmed() {
+  m_decisions++;
+  if (m_state == PigCountdown || m_state == Exploded)
+    transition(Idle, "炸彈解除");
+}
+
+void AlarmStateMachine::reset() {
+  m_decisions++;
+  transition(Idle, "系統重置");
+}
@@ -0,0 +1,95 @@
+#ifndef ALARMSTATEMACHINE_H
+#define ALARMSTATEMACHINE_H
+
+#include "detectionfusion.h"
+#include <QElapsedTimer>
+#include <QMap>
+#include <QObject>
+#include <functional>
+
+class AlarmActuator;
+class SecurityController;
+
+/**
+ * AlarmStateMachine
+ * 集中管理警報狀態與轉換 (原本散落在 MainWindow 的 lambda 與 pollSensors)，
+ * 與 SecurityController 同在邏輯執行緒；以單調時鐘做每種類型的 token bucket
+ * 限流，不依賴任何 widget，UI 只訂閱狀態變化與動作請求
+ */
+class AlarmStateMachine : public QObject {
+  Q_OBJECT
+public:
+  enum State { Idle, StrangerAlarm, PigCountdown, Exploded };
+  Q_ENUM(State)
+
+  // 單調時鐘 (ns)，可在測試中替換
+  typedef std::function<qint64()> Clock;
+
+  explicit AlarmStateMachine(SecurityController *security = nullptr,
+                             QObject *parent = nullptr);
+
+  State state() const { return m_state; }
+  bool isAlarmActive() const { return m_state != Idle; }
+  void setClock(Clock clock) { m_clock = clock; }
+  // 最近一次 handleDetection 的事件時間 (ns)；重播時設為時鐘，
+  // 限流便依錄製時間軸而非處理當下的時間
+  qint64 eventTimeNs() const { return m_eventTimeNs; }
+
+  // 設定後，警報觸發時直接在本執行緒送出 LED/蜂鳴器指令，不等 GUI 執行緒
+  void setActuator(AlarmActuator *actuator) { m_actuator = actuator; }
+
+  // 每種偵測類型的限流：容量 capacity，每 refillSeconds 補一個 token
+  void setRateLimit(const QString &type, double capacity, double refillSeconds);
+
+  quint64 decisions() const { return m_decisions; }
+  quint64 transitions() const { return m_transitions; }
+  quint64 rateLimited() const { return m_rateLimited; }
+
+public slots:
+  void handleDetection(const DetectionEvent &event);
+  void handleManualTrigger(const QString &type); // F5/F6/遠端測試，不限流
+  void handlePasswordVerified(bool success);
+  void handleRemoteUnlock(); // 遠端已授權，需產生現場驗證碼
+  void handleBombExploded();
+  void handleBombDisarmed();
+  void reset();
+  void setMuted(bool muted) { m_muted = muted; }
+
+signals:
+  void stateChanged(AlarmStateMachine::State from, AlarmStateMachine::State to,
+                    const QString &reason);
+  void alarmRaised(const QString &type);      // 需執行警報硬體動作
+  void ownerArrived();                        // 需執行開門動作
+  void unlockGranted(bool wasPigAlarm);       // 密碼/隨機碼驗證通過
+  void remoteCodeGenerated(const QString &code);
+
+private:
+  struct TokenBucket {
+    double capacity = 1;
+    double refillPerNs = 0;
+    double tokens = 1;
+    qint64 lastNs = 0;
+  };
+
+  SecurityController *m_security;
+  AlarmActuator *m_actuator = nullptr;
+  bool m_muted = false;
+  State m_state = Idle;
+  Clock m_clock;
+  QElapsedTimer m_elapsed;
+  qint64 m_eventTimeNs = 0;
+  QMap<QString, TokenBucket> m_buckets;
+  bool m_remoteCodeIssued = false;
+
+  quint64 m_decisions = 0;
+  quint64 m_transitions = 0;
+  quint64 m_rateLimited = 0;
+
+  bool takeToken(const QString &type);
+  void raise(const QString &type, const QString &reason);
+  void transition(State to, const QString &reason);
+};
+
+Q_DECLARE_METATYPE(AlarmStateMachine::State)
+
+#endif // ALARMSTATEMACHINE_H
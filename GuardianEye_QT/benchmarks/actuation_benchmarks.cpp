@@ -0,0 +1,147 @@
+#include "alarmactuator.h"
+#include "alarmstatemachine.h"
+#include "pythonaimanager.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QMutex>
+#include <QThread>
+#include <QTimer>
+#include <algorithm>
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <time.h>
+#include <vector>
+
+/**
+ * GUI 執行緒卡住時的警報延遲：worker 每 33 ms 輸出一行 (8 幀有陌生人、
+ * 8 幀沒有)，量測「該行到達」到 AlarmActuator 送出 LED_BLUE 的時間
+ *   Arg 0：後端與狀態機在邏輯執行緒，主執行緒正常處理事件
+ *   Arg 1：同上，但主執行緒每輪卡住 500 ms (模擬對話框/大量重繪)
+ *   Arg 2：舊架構，後端留在主執行緒，同樣卡住 500 ms
+ * 到達時間依排程計算；執行緒卡住時，行會在管線中等待，延遲照實計入
+ */
+
+namespace {
+
+qint64 monotonicNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return qint64(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+QJsonObject strangerLine(quint64 seq, bool present) {
+  return QJsonObject{{"seq", double(seq)},
+                     {"pig_detected", false},
+                     {"person_detected", present},
+                     {"face_id", present ? "STRANGER" : "Unknown"},
+                     {"face_conf", present ? 0.8 : 0.0},
+                     {"face_bbox", QJsonArray{212, 96, 348, 260}}};
+}
+
+void BM_BlockedGuiActuation(benchmark::State &state) {
+  const int mode = int(state.range(0));
+  const bool onLogicThread = mode != 2;
+  const bool blockGui = mode != 0;
+  const qint64 frameNs = 33 * 1000000LL;
+
+  QThread logicThread;
+  PythonAiManager *manager = new PythonAiManager();
+  AlarmStateMachine *alarm = new AlarmStateMachine();
+  AlarmActuator actuator;
+  actuator.start();
+  alarm->setActuator(&actuator);
+  // 每次陌生人進入都送出 LED_BLUE，不受 60 秒限流影響
+  alarm->setRateLimit("stranger", 1e9, 1);
+  QObject::connect(manager, &InferenceBackend::detectionStateChanged, alarm,
+                   &AlarmStateMachine::handleDetection);
+
+  // 模擬 worker stdout：依排程「到達」的行，由後端所在執行緒讀取
+  QTimer *feeder = new QTimer();
+  feeder->setInterval(5);
+  std::atomic<qint64> arrivalNs{0};
+  const qint64 startNs = monotonicNs();
+  quint64 nextFrame = 0;
+  QObject::connect(feeder, &QTimer::timeout, manager,
+                   [&, manager]() {
+                     const qint64 now = monotonicNs();
+                     while (startNs + qint64(nextFrame) * frameNs <= now) {
+                       arrivalNs = startNs + qint64(nextFrame) * frameNs;
+                       manager->parseLine(
+                           strangerLine(nextFrame + 1, nextFrame % 16 < 8));
+                       nextFrame++;
+                     }
+                   });
+
+  QMutex mutex;
+  std::vector<qint64> latencies;
+  // alarmRaised 在 submit 之後於同一執行緒送出，此時指令已進入致動器佇列
+  QObject::connect(alarm, &AlarmStateMachine::alarmRaised, alarm,
+                   [&](const QString &) {
+                     const qint64 latency = monotonicNs() - arrivalNs;
+                     QMutexLocker lock(&mutex);
+                     latencies.push_back(latency);
+                   },
+                   Qt::DirectConnection);
+
+  if (onLogicThread) {
+    manager->moveToThread(&logicThread);
+    alarm->moveToThread(&logicThread);
+    feeder->moveToThread(&logicThread);
+    QObject::connect(&logicThread, &QThread::started, feeder,
+                     static_cast<void (QTimer::*)()>(&QTimer::start));
+    logicThread.start();
+  } else {
+    feeder->start();
+  }
+
+  auto pumpEvents = [](qint64 ms) {
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < ms)
+      QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+  };
+  for (auto _ : state) {
+    if (blockGui) {
+      QThread::msleep(500); // 主執行緒完全不處理事件
+      pumpEvents(100);
+    } else {
+      pumpEvents(600);
+    }
+  }
+
+  if (onLogicThread) {
+    QMetaObject::invokeMethod(feeder, "stop", Qt::BlockingQueuedConnection);
+    logicThread.quit();
+    logicThread.wait();
+  }
+  delete feeder;
+  delete alarm;
+  delete manager;
+  const ActuatorStats st = actuator.stats();
+
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&latencies](double p) {
+    return latencies.empty()
+               ? 0.0
+               : latencies[size_t(p * (latencies.size() - 1))] / 1e6;
+  };
+  if (latencies.empty())
+    state.SkipWithError("沒有任何陌生人警報送出");
+  state.counters["alarms"] = double(latencies.size());
+  state.counters["detect_to_submit_p50_ms"] = percentile(0.50);
+  state.counters["detect_to_submit_p99_ms"] = percentile(0.99);
+  state.counters["detect_to_submit_max_ms"] =
+      latencies.empty() ? 0.0 : latencies.back() / 1e6;
+  state.counters["submit_to_gpio_max_ms"] = st.maxLatencyNs / 1e6;
+}
+BENCHMARK(BM_BlockedGuiActuation)
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(2)
+    ->Iterations(10)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace
@@ -0,0 +1,93 @@
+#include "alarmstatemachine.h"
+#include "securitycontroller.h"
+#include <QElapsedTimer>
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <vector>
+
+/**
+ * AlarmStateMachine 的決策吞吐量與單次決策延遲 (不需要 widget 或硬體)
+ * 時鐘以 setClock 換成假時鐘，限流完全由測試控制
+ */
+
+namespace {
+
+DetectionEvent detection(const QString &type, bool entered, qint64 ms) {
+  DetectionEvent ev;
+  ev.type = type;
+  ev.entered = entered;
+  ev.peakConfidence = ev.meanConfidence = 0.8;
+  ev.timestampMs = ms;
+  return ev;
+}
+
+// 一輪完整的警報流程：陌生人 -> 驗證解除 -> 豬 (倒數中重複偵測被忽略)
+// -> 炸彈解除 -> 主人到達 -> 陌生人離開，共 7 次決策、4 次轉換
+// Arg 0：每輪假時鐘前進 61 秒，token 都已補滿
+// Arg 1：時鐘不動，第一輪之後的偵測都被限流 (量限流路徑本身的成本)
+void BM_AlarmDecisions(benchmark::State &state) {
+  const bool flood = state.range(0) != 0;
+  SecurityController security;
+  AlarmStateMachine machine(&security);
+  qint64 fakeNs = 0;
+  machine.setClock([&fakeNs]() { return fakeNs; });
+  machine.setRateLimit("pig", 1, 60);
+  machine.setRateLimit("stranger", 1, 60);
+  machine.setRateLimit("owner", 1, 10);
+
+  const int decisionsPerCycle = 7;
+  std::vector<qint64> latencies;
+  latencies.reserve(1 << 20);
+  QElapsedTimer timer;
+  timer.start();
+  auto timed = [&](auto &&decide) {
+    const qint64 t0 = timer.nsecsElapsed();
+    decide();
+    if (latencies.size() < latencies.capacity())
+      latencies.push_back(timer.nsecsElapsed() - t0);
+  };
+
+  qint64 ms = 0;
+  for (auto _ : state) {
+    timed([&] { machine.handleDetection(detection("stranger", true, ms)); });
+    timed([&] { machine.handlePasswordVerified(true); });
+    timed([&] { machine.handleDetection(detection("pig", true, ms)); });
+    timed([&] { machine.handleDetection(detection("pig", true, ms)); });
+    timed([&] { machine.handleBombDisarmed(); });
+    timed([&] { machine.handleDetection(detection("owner", true, ms)); });
+    timed([&] { machine.handleDetection(detection("stranger", false, ms)); });
+    if (machine.state() != AlarmStateMachine::Idle) {
+      state.SkipWithError("一輪流程結束後狀態不是 Idle");
+      break;
+    }
+    if (!flood) {
+      fakeNs += 61LL * 1000000000LL;
+      ms += 61000;
+    }
+  }
+
+  const quint64 cycles = state.iterations();
+  if (!flood && machine.transitions() != 4 * cycles)
+    state.SkipWithError("轉換次數不符 (限流或狀態判斷錯誤)");
+  if (flood && cycles > 1 && machine.rateLimited() == 0)
+    state.SkipWithError("時鐘不動時應該被限流");
+
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&latencies](double p) {
+    return latencies.empty()
+               ? 0.0
+               : double(latencies[size_t(p * (latencies.size() - 1))]);
+  };
+  state.counters["decisions/s"] = benchmark::Counter(
+      double(cycles * decisionsPerCycle), benchmark::Counter::kIsRate);
+  state.counters["transitions/s"] = benchmark::Counter(
+      double(machine.transitions()), benchmark::Counter::kIsRate);
+  state.counters["p50_ns"] = percentile(0.50);
+  state.counters["p99_ns"] = percentile(0.99);
+  state.counters["max_ns"] = latencies.empty() ? 0.0 : double(latencies.back());
+  state.counters["rate_limited"] = double(machine.rateLimited());
+  state.SetItemsProcessed(cycles * decisionsPerCycle);
+}
+BENCHMARK(BM_AlarmDecisions)->Arg(0)->Arg(1);
+
+} // namespace
@@ -0,0 +1,118 @@
+#include "nativeinferencebackend.h"
+#include "pythonaimanager.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <benchmark/benchmark.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+/**
+ * Python worker 與行程內 OpenCV DNN 後端的比較：冷啟動到第一個影格的時間、
+ * 常駐記憶體 (本行程 + 子行程) 與每幀的間隔/CPU 時間
+ * 需要實機的攝影機與模型 (vision_system.py / models/best_pig_model_v5n.onnx)，
+ * 找不到時以 SkipWithError 標示，不影響其他基準
+ *   ./guardian_benchmarks --benchmark_filter=BackendStartup
+ */
+
+namespace {
+
+qint64 residentBytes(const QString &pid) {
+  QFile statm(QString("/proc/%1/statm").arg(pid));
+  if (!statm.open(QIODevice::ReadOnly))
+    return 0;
+  const QList<QByteArray> fields = statm.readAll().split(' ');
+  return fields.size() > 1 ? fields[1].toLongLong() * sysconf(_SC_PAGESIZE)
+                           : 0;
+}
+
+// 本行程與其直接子行程 (python3 worker) 的 RSS 總和
+qint64 treeResidentBytes() {
+  const QString self = QString::number(getpid());
+  qint64 total = residentBytes(self);
+  for (const QString &pid : QDir("/proc").entryList(QDir::Dirs)) {
+    QFile stat(QString("/proc/%1/stat").arg(pid));
+    if (!pid.at(0).isDigit() || !stat.open(QIODevice::ReadOnly))
+      continue;
+    // "pid (comm) state ppid ..."，comm 可能含空白，從最後一個 ')' 之後解析
+    const QByteArray line = stat.readAll();
+    const QList<QByteArray> fields =
+        line.mid(line.lastIndexOf(')') + 2).split(' ');
+    if (fields.size() > 1 && fields[1] == self.toLatin1())
+      total += residentBytes(pid);
+  }
+  return total;
+}
+
+double cpuSeconds(int who) {
+  struct rusage ru;
+  getrusage(who, &ru);
+  return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec +
+         (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+// Arg 0 = PythonAiManager、1 = NativeInferenceBackend
+void BM_BackendStartup(benchmark::State &state) {
+  const bool native = state.range(0) != 0;
+  const int measuredFrames = 300;
+  const qint64 startupTimeoutMs = 180000;
+
+  for (auto _ : state) {
+    const qint64 rssBefore = treeResidentBytes();
+    const double cpuBefore =
+        cpuSeconds(RUSAGE_SELF) + cpuSeconds(RUSAGE_CHILDREN);
+    InferenceBackend *backend =
+        native ? static_cast<InferenceBackend *>(new NativeInferenceBackend())
+               : new PythonAiManager();
+    backend->setPreviewEnabled(false);
+    backend->setMinimumFrameRate(30); // 每幀都輸出壓縮影格，才量得到間隔
+
+    QString error;
+    int frames = 0;
+    qint64 firstFrameMs = -1, lastFrameMs = -1, rssRunning = 0;
+    QElapsedTimer timer;
+    QObject::connect(backend, &InferenceBackend::errorOccurred,
+                     [&error](QString msg) { error = msg; });
+    QObject::connect(backend, &InferenceBackend::compressedFrameReady,
+                     [&](const QByteArray &, quint64, qint64) {
+                       lastFrameMs = timer.elapsed();
+                       if (frames++ == 0)
+                         firstFrameMs = lastFrameMs;
+                     });
+
+    timer.start();
+    backend->start();
+    while (error.isEmpty() && frames <= measuredFrames) {
+      QCoreApplication::processEvents(QEventLoop::AllEvents, 50);
+      if (frames == 0 && timer.elapsed() > startupTimeoutMs)
+        error = "啟動逾時";
+      if (frames == measuredFrames / 2 && rssRunning == 0)
+        rssRunning = treeResidentBytes();
+    }
+    backend->stop();
+    delete backend;
+    QCoreApplication::processEvents(); // 讓 worker 的 deleteLater 執行完
+
+    if (!error.isEmpty()) {
+      state.SkipWithError(
+          QString("需要攝影機與模型：%1").arg(error).toUtf8().constData());
+      break;
+    }
+    const double cpu =
+        cpuSeconds(RUSAGE_SELF) + cpuSeconds(RUSAGE_CHILDREN) - cpuBefore;
+    state.counters["startup_s"] = firstFrameMs / 1000.0;
+    state.counters["rss_mb"] = (rssRunning - rssBefore) / 1048576.0;
+    state.counters["frame_interval_ms"] =
+        frames > 1 ? double(lastFrameMs - firstFrameMs) / (frames - 1) : 0;
+    state.counters["cpu_ms_per_frame"] = frames ? cpu * 1000.0 / frames : 0;
+  }
+}
+BENCHMARK(BM_BackendStartup)
+    ->Arg(0)
+    ->Arg(1)
+    ->Iterations(1)
+    ->UseRealTime()
+    ->Unit(benchmark::kSecond);
+
+} // namespace
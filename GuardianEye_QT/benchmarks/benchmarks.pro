@@ -0,0 +1,77 @@
+# GuardianEye 熱路徑微基準 (Google Benchmark)
+#   qmake && make && ./guardian_benchmarks \
+#       --benchmark_out=results.json --benchmark_out_format=json
+# 同一台機器前後兩次結果可用 Google Benchmark 附的 tools/compare.py 比較
+
+QT       += core gui network
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+TARGET = guardian_benchmarks
+
+# 與主程式相同的追蹤設定，量到的是實際出貨的程式碼路徑
+!notrace: DEFINES += GUARDIAN_TRACING
+
+INCLUDEPATH += .. ../..
+# fake_worker.py 等測試資源的位置
+DEFINES += GUARDIAN_BENCH_DIR=\\\"$$PWD\\\"
+
+SOURCES += \
+    guardian_benchmarks.cpp \
+    actuation_benchmarks.cpp \
+    alarm_benchmarks.cpp \
+    backend_benchmarks.cpp \
+    faceindex_benchmarks.cpp \
+    hardware_benchmarks.cpp \
+    recorder_benchmarks.cpp \
+    sensor_benchmarks.cpp \
+    stream_benchmarks.cpp \
+    supervisor_benchmarks.cpp \
+    trace_benchmarks.cpp \
+    ../inferencebackend.cpp \
+    ../pythonaimanager.cpp \
+    ../aiworkerprocess.cpp \
+    ../nativeinferencebackend.cpp \
+    ../detectionfusion.cpp \
+    ../faceindex.cpp \
+    ../eventrecorder.cpp \
+    ../mjpegaviwriter.cpp \
+    ../httpserver.cpp \
+    ../mjpegstreamer.cpp \
+    ../alarmstatemachine.cpp \
+    ../alarmactuator.cpp \
+    ../securitycontroller.cpp \
+    ../environmentalcontroller.cpp \
+    ../signalfilter.cpp \
+    ../mcp3008interface.cpp \
+    ../metrics.cpp \
+    ../tracing.cpp \
+    ../workerstream.cpp
+
+HEADERS += \
+    ../inferencebackend.h \
+    ../pythonaimanager.h \
+    ../aiworkerprocess.h \
+    ../nativeinferencebackend.h \
+    ../detectionfusion.h \
+    ../faceindex.h \
+    ../eventrecorder.h \
+    ../mjpegaviwriter.h \
+    ../httpserver.h \
+    ../mjpegstreamer.h \
+    synthetic_frames.h \
+    ../alarmstatemachine.h \
+    ../alarmactuator.h \
+    ../securitycontroller.h \
+    ../environmentalcontroller.h \
+    ../signalfilter.h \
+    ../mcp3008interface.h \
+    ../metrics.h \
+    ../tracing.h \
+    ../workerstream.h \
+    ../../blackbox_ring.h
+
+INCLUDEPATH += /usr/include/opencv4
+LIBS += -L/usr/lib/aarch64-linux-gnu -lopencv_core -lopencv_imgproc -lopencv_imgcodecs -lopencv_videoio -lopencv_dnn
+LIBS += -lbenchmark -lpthread -ldl
@@ -0,0 +1,151 @@
+#include "faceindex.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QMap>
+#include <QPair>
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <random>
+#include <vector>
+
+/**
+ * FaceIndex 查詢吞吐量：10、1k、100k 筆身分，全表掃描與粗分群 (nlist/nprobe)
+ * 查詢為某筆已登錄向量加上小幅雜訊，全表掃描時最近鄰必須是它本身，
+ * 分群時另外回報 recall (top-1 命中率)
+ */
+
+namespace {
+
+struct Dataset {
+  QString path;
+  std::vector<float> vectors; // count x DIM
+};
+
+// 單位向量 (face_recognition 的特徵大致落在單位球附近)
+void randomUnit(std::mt19937 &rng, float *out) {
+  std::normal_distribution<float> normal(0.f, 1.f);
+  double norm = 0;
+  for (int d = 0; d < FaceIndex::DIM; d++) {
+    out[d] = normal(rng);
+    norm += double(out[d]) * out[d];
+  }
+  const float inv = float(1.0 / std::sqrt(norm));
+  for (int d = 0; d < FaceIndex::DIM; d++)
+    out[d] *= inv;
+}
+
+// 同一組參數只建立一次索引檔，結束時刪除
+struct DatasetCache {
+  QMap<QPair<int, int>, Dataset> sets;
+  ~DatasetCache() {
+    for (const Dataset &ds : sets)
+      QFile::remove(ds.path);
+  }
+};
+
+const Dataset &dataset(int count, FaceIndex::DType dtype) {
+  static DatasetCache cache;
+  const QPair<int, int> key(count, int(dtype));
+  if (cache.sets.contains(key))
+    return cache.sets[key];
+
+  Dataset &ds = cache.sets[key];
+  ds.path = QDir::temp().filePath(
+      QString("guardian_bench_faces_%1_%2_%3.idx")
+          .arg(count)
+          .arg(int(dtype))
+          .arg(QCoreApplication::applicationPid()));
+  QFile::remove(ds.path);
+  ds.vectors.resize(size_t(count) * FaceIndex::DIM);
+  std::mt19937 rng(20240601u + count);
+  FaceIndex index;
+  index.open(ds.path, true, dtype);
+  for (int i = 0; i < count; i++) {
+    float *v = ds.vectors.data() + size_t(i) * FaceIndex::DIM;
+    randomUnit(rng, v);
+    index.enroll(QString("id%1").arg(i), v);
+  }
+  return ds;
+}
+
+// Args = {身分數, nlist (0 = 全表掃描), dtype (0 = float32, 1 = float16)}
+void BM_FaceIndexSearch(benchmark::State &state) {
+  const int count = int(state.range(0));
+  const int nlist = int(state.range(1));
+  const FaceIndex::DType dtype = FaceIndex::DType(state.range(2));
+  const Dataset &ds = dataset(count, dtype);
+
+  FaceIndex index;
+  if (!index.open(ds.path) || index.count() != count) {
+    state.SkipWithError("無法建立測試索引");
+    return;
+  }
+  index.buildClusters(nlist);
+  index.setProbe(8);
+
+  // 預先產生查詢 (已登錄向量 + 雜訊)，迴圈內不配置
+  const int queries = 1024;
+  std::vector<float> q(size_t(queries) * FaceIndex::DIM);
+  std::vector<int> expected(queries);
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<int> pick(0, count - 1);
+  std::normal_distribution<float> noise(0.f, 0.01f);
+  for (int i = 0; i < queries; i++) {
+    expected[i] = pick(rng);
+    for (int d = 0; d < FaceIndex::DIM; d++)
+      q[size_t(i) * FaceIndex::DIM + d] =
+          ds.vectors[size_t(expected[i]) * FaceIndex::DIM + d] + noise(rng);
+  }
+
+  int i = 0, hits = 0, total = 0;
+  for (auto _ : state) {
+    const QVector<FaceMatch> top =
+        index.search(q.data() + size_t(i) * FaceIndex::DIM, 1);
+    hits += !top.isEmpty() && top[0].id == expected[i];
+    total++;
+    i = (i + 1) % queries;
+  }
+
+  const double recall = total ? double(hits) / total : 0;
+  if (index.clusterCount() == 0 && recall < 1.0)
+    state.SkipWithError("全表掃描的最近鄰不是查詢來源");
+  state.counters["qps"] =
+      benchmark::Counter(double(total), benchmark::Counter::kIsRate);
+  state.counters["recall"] = recall;
+  state.counters["clusters"] = index.clusterCount();
+  state.SetItemsProcessed(total);
+}
+BENCHMARK(BM_FaceIndexSearch)
+    ->Args({10, 0, 0})
+    ->Args({1000, 0, 0})
+    ->Args({1000, 16, 0})
+    ->Args({100000, 0, 0})
+    ->Args({100000, 0, 1})
+    ->Args({100000, 256, 0})
+    ->Unit(benchmark::kMicrosecond);
+
+// 批次查詢 (同一影格多張臉)：Args = {身分數, 每批 query 數}
+void BM_FaceIndexSearchBatch(benchmark::State &state) {
+  const int count = int(state.range(0));
+  const int batch = int(state.range(1));
+  const Dataset &ds = dataset(count, FaceIndex::Float32);
+  FaceIndex index;
+  if (!index.open(ds.path)) {
+    state.SkipWithError("無法建立測試索引");
+    return;
+  }
+  std::vector<float> q(ds.vectors.begin(),
+                       ds.vectors.begin() + size_t(batch) * FaceIndex::DIM);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(index.searchBatch(q.data(), batch, 1));
+  state.counters["qps"] = benchmark::Counter(
+      double(state.iterations()) * batch, benchmark::Counter::kIsRate);
+  state.SetItemsProcessed(state.iterations() * batch);
+}
+BENCHMARK(BM_FaceIndexSearchBatch)
+    ->Args({100000, 1})
+    ->Args({100000, 8})
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace
@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+"""
+模擬 vision_system.py 的 worker (只用標準函式庫)，用來測試 PythonAiManager 的監督：
+與真正的 worker 相同的參數與 stdout 協定 (--qt_mode/--camera/--standby、status 行、
+每幀一行偵測 JSON)，並可依指令當機或卡死
+
+    GUARDIAN_AI_SCRIPT=$PWD/fake_worker.py GUARDIAN_AI_STANDBY=1 ./GuardianEye
+
+故障指令 (任一種)：
+  - stdin 一行 JSON：{"cmd": "crash"} / {"cmd": "hang"} / {"cmd": "exit"}
+  - FAKE_WORKER_CONTROL=<檔案>：每幀檢查，內容為 crash / hang / exit，讀到後刪除
+
+其他環境變數：
+  FAKE_WORKER_LOAD_MS      模擬載入模型的時間 (預設 2000)
+  FAKE_WORKER_FPS          影格率 (預設 30)
+  FAKE_WORKER_CRASH_AFTER  送出這麼多幀後自行當機 (0 = 不會)
+  FAKE_WORKER_HANG_AFTER   送出這麼多幀後卡住 (0 = 不會)
+"""
+import argparse
+import json
+import os
+import signal
+import sys
+import threading
+import time
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--qt_mode', action='store_true')
+parser.add_argument('--camera', type=str, default='0')
+parser.add_argument('--standby', action='store_true')
+args, _ = parser.parse_known_args()
+
+LOAD_MS = int(os.environ.get('FAKE_WORKER_LOAD_MS', '2000'))
+FPS = max(1, int(os.environ.get('FAKE_WORKER_FPS', '30')))
+CRASH_AFTER = int(os.environ.get('FAKE_WORKER_CRASH_AFTER', '0'))
+HANG_AFTER = int(os.environ.get('FAKE_WORKER_HANG_AFTER', '0'))
+CONTROL = os.environ.get('FAKE_WORKER_CONTROL')
+
+activated = threading.Event()
+fault = {'cmd': None}
+
+
+def emit(obj):
+    sys.stdout.write(json.dumps(obj) + '\n')
+    sys.stdout.flush()
+
+
+def crash():
+    # 與真正的當機相同：不清理、以訊號結束
+    os.kill(os.getpid(), signal.SIGSEGV)
+
+
+def hang():
+    # 行程仍在、stdin 仍可寫，但不再有影格 (像是卡住的攝影機讀取)
+    while True:
+        time.sleep(3600)
+
+
+def read_commands():
+    for line in sys.stdin:
+        try:
+            cmd = json.loads(line).get('cmd')
+        except ValueError:
+            continue
+        if cmd == 'activate':
+            activated.set()
+        elif cmd in ('crash', 'hang', 'exit'):
+            fault['cmd'] = cmd
+    sys.exit(0)  # 主控端已關閉 stdin
+
+
+def take_control_command():
+    if not CONTROL:
+        return None
+    try:
+        with open(CONTROL) as f:
+            cmd = f.read().strip()
+        os.remove(CONTROL)
+        return cmd
+    except (IOError, OSError):
+        return None
+
+
+emit({"status": "loading", "msg": "fake worker: loading models"})
+time.sleep(LOAD_MS / 1000.0)
+
+threading.Thread(target=read_commands, daemon=True).start()
+if args.standby:
+    emit({"status": "standby", "msg": "fake worker ready"})
+    activated.wait()
+
+emit({"status": "running", "msg": "fake worker running"})
+seq = 0
+while True:
+    seq += 1
+    emit({"seq": seq, "pig_detected": False, "pig_conf": 0.0, "pig_bbox": None,
+          "person_detected": False, "face_id": "Idle", "face_conf": 0.0,
+          "face_bbox": None, "face_label": None, "pid": os.getpid()})
+    cmd = fault['cmd'] or take_control_command()
+    if cmd == 'crash' or (CRASH_AFTER and seq >= CRASH_AFTER):
+        crash()
+    if cmd == 'hang' or (HANG_AFTER and seq >= HANG_AFTER):
+        hang()
+    if cmd == 'exit':
+        sys.exit(0)
+    time.sleep(1.0 / FPS)
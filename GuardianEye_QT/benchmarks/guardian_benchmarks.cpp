@@ -0,0 +1,285 @@
+#include "blackbox_ring.h"
+#include "mcp3008interface.h"
+#include "pythonaimanager.h"
+#include <QBuffer>
+#include <QFile>
+#include <QGuiApplication>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPixmap>
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <opencv2/imgproc.hpp>
+#include <stdlib.h>
+#include <unistd.h>
+
+/**
+ * GuardianEye 熱路徑微基準
+ * worker 輸出行預設以合成影格產生 (640x480、JPEG 品質 80，與 vision_system.py 相同)；
+ * ParseLine/Captured 另外重播 worker stdout 樣本 (一行一個 JSON，非 JSON 行略過)，
+ * 預設為 fixtures/worker_lines.jsonl，GUARDIAN_BENCH_LINES=<檔案> 改用其他擷取
+ */
+
+namespace {
+
+// 帶紋理的合成畫面，避免 JPEG 壓縮得不切實際地小
+QImage syntheticFrame(int width, int height) {
+  QImage img(width, height, QImage::Format_RGB888);
+  for (int y = 0; y < height; y++) {
+    uchar *line = img.scanLine(y);
+    for (int x = 0; x < width; x++) {
+      const unsigned h = unsigned(x * 2654435761u ^ y * 40503u);
+      line[x * 3 + 0] = uchar((x + (h & 31)) & 0xff);
+      line[x * 3 + 1] = uchar((y + ((h >> 5) & 31)) & 0xff);
+      line[x * 3 + 2] = uchar(((x ^ y) + ((h >> 10) & 31)) & 0xff);
+    }
+  }
+  return img;
+}
+
+QByteArray jpegBytes(const QImage &img, int quality = 80) {
+  QByteArray bytes;
+  QBuffer buffer(&bytes);
+  buffer.open(QIODevice::WriteOnly);
+  img.save(&buffer, "JPG", quality);
+  return bytes;
+}
+
+QByteArray workerLine(quint64 seq, bool withImage) {
+  static const QByteArray base64 =
+      jpegBytes(syntheticFrame(640, 480)).toBase64();
+  QJsonObject obj{{"seq", double(seq)},
+                  {"pig_detected", false},
+                  {"pig_conf", 0.0},
+                  {"pig_bbox", QJsonValue::Null},
+                  {"person_detected", true},
+                  {"face_id", "STRANGER"},
+                  {"face_conf", 0.82},
+                  {"face_bbox", QJsonArray{212, 96, 348, 260}},
+                  {"face_label", QJsonValue::Null}};
+  if (withImage)
+    obj.insert("img", QString::fromLatin1(base64));
+  return QJsonDocument(obj).toJson(QJsonDocument::Compact);
+}
+
+void runParseLines(benchmark::State &state, const QList<QByteArray> &lines) {
+  PythonAiManager manager;
+  // 預覽 credit 在畫出後才歸還：模擬立即畫完的 UI，否則兩張之後就不再解碼
+  QObject::connect(&manager, &InferenceBackend::frameReady, &manager,
+                   &InferenceBackend::previewFrameShown);
+  qint64 bytes = 0;
+  int i = 0;
+  for (auto _ : state) {
+    const QByteArray &line = lines[i];
+    i = (i + 1) % lines.size();
+    // 與 AiWorkerProcess::parseLine 相同：先解析 JSON 再交給 manager
+    manager.parseLine(QJsonDocument::fromJson(line).object());
+    bytes += line.size();
+  }
+  state.SetBytesProcessed(bytes);
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_ParseLineMetadata(benchmark::State &state) {
+  runParseLines(state, {workerLine(1, false), workerLine(2, false)});
+}
+BENCHMARK(BM_ParseLineMetadata);
+
+void BM_ParseLineWithImage(benchmark::State &state) {
+  runParseLines(state, {workerLine(1, true), workerLine(2, true)});
+}
+BENCHMARK(BM_ParseLineWithImage)->Unit(benchmark::kMicrosecond);
+
+// 陌生人信心度必須能通過融合門檻：Arg 為 face_conf x100
+// 50 = 距離剛好等於容忍值或取不到特徵時 (UNIDENTIFIED_CONFIDENCE) 校正後的值
+// 每次迭代 8 幀有人 + 8 幀無人，必須各產生一次 stranger 進入與離開
+void BM_StrangerFusion(benchmark::State &state) {
+  const double conf = state.range(0) / 100.0;
+  PythonAiManager manager;
+  int entered = 0;
+  QObject::connect(&manager, &InferenceBackend::detectionStateChanged,
+                   [&entered](const DetectionEvent &ev) {
+                     if (ev.type == "stranger" && ev.entered)
+                       entered++;
+                   });
+  QJsonObject present = QJsonDocument::fromJson(workerLine(0, false)).object();
+  present["face_conf"] = conf;
+  QJsonObject absent = present;
+  absent["person_detected"] = false;
+  absent["face_id"] = "Unknown";
+  quint64 seq = 0;
+  for (auto _ : state) {
+    for (int i = 0; i < 16; i++) {
+      QJsonObject &obj = i < 8 ? present : absent;
+      obj["seq"] = double(++seq);
+      manager.parseLine(obj);
+    }
+  }
+  if (entered != int(state.iterations()))
+    state.SkipWithError("陌生人未通過 DetectionFusion 門檻");
+  state.counters["entered"] = entered;
+  state.SetItemsProcessed(state.iterations() * 16);
+}
+BENCHMARK(BM_StrangerFusion)->Arg(50)->Arg(82);
+
+void BM_Base64JpegDecode(benchmark::State &state) {
+  const QByteArray base64 =
+      jpegBytes(syntheticFrame(int(state.range(0)), int(state.range(1))))
+          .toBase64();
+  for (auto _ : state) {
+    QImage img;
+    img.loadFromData(QByteArray::fromBase64(base64), "JPG");
+    benchmark::DoNotOptimize(img.constBits());
+  }
+  state.SetBytesProcessed(state.iterations() * base64.size());
+}
+BENCHMARK(BM_Base64JpegDecode)
+    ->Args({640, 480})
+    ->Args({1280, 720})
+    ->Unit(benchmark::kMicrosecond);
+
+// MainWindow::updateFrame 的縮放繪圖 (video_label 常見尺寸)
+void BM_ScaleForLabel(benchmark::State &state) {
+  const QImage img = syntheticFrame(640, 480);
+  const QSize labelSize(int(state.range(0)), int(state.range(1)));
+  for (auto _ : state) {
+    QPixmap pixmap = QPixmap::fromImage(img).scaled(
+        labelSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    benchmark::DoNotOptimize(pixmap.cacheKey());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ScaleForLabel)
+    ->Args({640, 480})
+    ->Args({800, 600})
+    ->Args({1024, 768})
+    ->Unit(benchmark::kMicrosecond);
+
+// CameraManager / NativeInferenceWorker 的預覽轉換：BGR -> RGB 後深拷貝成 QImage
+void BM_CvtColorQImageCopy(benchmark::State &state) {
+  cv::Mat frame(int(state.range(1)), int(state.range(0)), CV_8UC3);
+  cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(255));
+  cv::Mat rgb;
+  for (auto _ : state) {
+    cv::cvtColor(frame, rgb, cv::COLOR_BGR2RGB);
+    QImage img((const uchar *)rgb.data, rgb.cols, rgb.rows, int(rgb.step),
+               QImage::Format_RGB888);
+    QImage copy = img.copy();
+    benchmark::DoNotOptimize(copy.constBits());
+  }
+  state.SetBytesProcessed(state.iterations() * qint64(frame.total()) * 3);
+}
+BENCHMARK(BM_CvtColorQImageCopy)
+    ->Args({640, 480})
+    ->Args({1280, 720})
+    ->Unit(benchmark::kMicrosecond);
+
+// sysfs bit-bang：以暫存檔模擬 GPIO value 檔 (pwrite/pread 位移 0)，
+// 量到的是系統呼叫 + usleep(2) 時序，不含真實 sysfs 的 GPIO 驅動成本
+void BM_ReadAdcBitBang(benchmark::State &state) {
+  int fds[4];
+  for (int &fd : fds) {
+    char path[] = "/tmp/guardian_bench_gpioXXXXXX";
+    fd = mkstemp(path);
+    unlink(path);
+    if (fd < 0 || pwrite(fd, "0", 1, 0) != 1) {
+      state.SkipWithError("無法建立模擬 GPIO 檔");
+      return;
+    }
+  }
+  (void)pwrite(fds[2], "1", 1, 0); // MISO 恆為 1
+
+  Mcp3008Interface adc(fds[0], fds[1], fds[2], fds[3]);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(adc.readAdc(0));
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ReadAdcBitBang)->Unit(benchmark::kMicrosecond);
+
+// blackbox_driver.c 的日誌記錄環 (同一份 blackbox_ring.h，以使用者空間編譯)
+const char LOG_MESSAGE[] = "AI 模擬觸發: 發現小豬入侵 (最高警報)";
+
+struct BenchLog {
+  struct bb_record info[128], warning[64], critical[64];
+  struct bb_log log;
+  BenchLog() {
+    bb_log_init(&log);
+    bb_log_init_ring(&log, 0, info, 128);
+    bb_log_init_ring(&log, 1, warning, 64);
+    bb_log_init_ring(&log, 2, critical, 64);
+  }
+};
+
+void BM_BlackboxRingWrite(benchmark::State &state) {
+  static BenchLog bench;
+  for (auto _ : state) {
+    bb_log_write(&bench.log, 0, 0, LOG_MESSAGE);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BlackboxRingWrite);
+
+// 三個優先級都寫滿後依序號合併讀出
+void BM_BlackboxRingDrain(benchmark::State &state) {
+  static BenchLog bench;
+  qint64 records = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (int i = 0; i < 256; i++)
+      bb_log_write(&bench.log, i % 3, 0, LOG_MESSAGE);
+    state.ResumeTiming();
+    const struct bb_record *rec;
+    while ((rec = bb_log_peek(&bench.log)) != nullptr) {
+      benchmark::DoNotOptimize(rec->message[0]);
+      bb_log_pop(&bench.log, rec->seq);
+      records++;
+    }
+  }
+  state.SetItemsProcessed(records);
+}
+BENCHMARK(BM_BlackboxRingDrain);
+
+} // namespace
+
+int main(int argc, char **argv) {
+  // QPixmap 需要 QGuiApplication；沒有顯示器時改用 offscreen
+  if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+  QGuiApplication app(argc, argv);
+
+  // 未指定時使用隨原始碼提供的樣本；指定的檔案不可用視為錯誤
+  const bool explicitLines = qEnvironmentVariableIsSet("GUARDIAN_BENCH_LINES");
+  const QString capturedPath =
+      explicitLines
+          ? QString::fromLocal8Bit(qgetenv("GUARDIAN_BENCH_LINES"))
+          : QString(GUARDIAN_BENCH_DIR "/fixtures/worker_lines.jsonl");
+  QList<QByteArray> captured;
+  QFile file(capturedPath);
+  if (file.open(QIODevice::ReadOnly)) {
+    for (const QByteArray &line : file.readAll().split('\n')) {
+      if (line.trimmed().startsWith('{'))
+        captured.append(line.trimmed());
+    }
+  }
+  if (captured.isEmpty()) {
+    fprintf(stderr, "GUARDIAN_BENCH_LINES: %s 沒有可用的 JSON 行\n",
+            qPrintable(capturedPath));
+    if (explicitLines)
+      return 1;
+  } else {
+    benchmark::RegisterBenchmark("ParseLine/Captured",
+                                 [captured](benchmark::State &state) {
+                                   runParseLines(state, captured);
+                                 })
+        ->Unit(benchmark::kMicrosecond);
+  }
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
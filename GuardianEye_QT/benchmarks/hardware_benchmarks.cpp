@@ -0,0 +1,229 @@
+#include "mcp3008interface.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/gpio.h>
+#include <stdarg.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+/**
+ * 硬體介面的微基準 (不需要實體 SPI/GPIO)
+ * 結果不正確時以 SkipWithError 標示，報表中可直接看到失敗的組合
+ */
+
+namespace {
+
+// 模擬 spidev：攔截對 g_mockSpi.fd 的 ioctl，依 spidev_get_ioc_message 的規則
+// 解讀 SPI_IOC_MESSAGE(n) 的大小欄位 (溢位成 0 時與核心一樣回傳 0)，
+// 並對每個 MCP3008 指令回傳該通道的固定數值
+struct MockSpidev {
+  int fd = -1;
+  int messages = 0;
+  int transfers = 0;
+  int maxTransfersPerMessage = 0;
+  int badMessages = 0; // 大小不是 transfer 整數倍或為 0
+
+  static int valueFor(int channel) { return 100 * channel + 7; }
+
+  int message(unsigned long request, struct spi_ioc_transfer *xfers) {
+    const unsigned size = _IOC_SIZE(request);
+    if (_IOC_TYPE(request) != SPI_IOC_MAGIC || size == 0 ||
+        size % sizeof(struct spi_ioc_transfer) != 0) {
+      badMessages++;
+      if (size % sizeof(struct spi_ioc_transfer) != 0) {
+        errno = EINVAL;
+        return -1;
+      }
+      return 0;
+    }
+    const int n = int(size / sizeof(struct spi_ioc_transfer));
+    int bytes = 0;
+    for (int i = 0; i < n; i++) {
+      const uint8_t *tx = (const uint8_t *)(uintptr_t)xfers[i].tx_buf;
+      uint8_t *rx = (uint8_t *)(uintptr_t)xfers[i].rx_buf;
+      const int value = valueFor((tx[1] >> 4) & 0x7);
+      rx[0] = 0;
+      rx[1] = uint8_t((value >> 8) & 3);
+      rx[2] = uint8_t(value & 0xff);
+      bytes += int(xfers[i].len);
+    }
+    messages++;
+    transfers += n;
+    maxTransfersPerMessage = qMax(maxTransfersPerMessage, n);
+    return bytes;
+  }
+};
+
+MockSpidev g_mockSpi;
+
+// 模擬 gpiochip line 與接在上面的 MCP3008：在 SCK 上緣 (CS 低) 收 5 位元指令，
+// 之後每次讀 MISO 依序送出 null bit + 10-bit 數值 (通道 N 為 100N+7)
+struct MockGpioChip {
+  Mcp3008Interface::LineAbi abi = Mcp3008Interface::LineAbi::V2;
+  int outFd = -1;
+  int inFd = -1; // 只有 v1
+  quint64 out = 1ULL << 2;
+  int cmd = 0, cmdBits = 0, readBits = 0;
+  long long ioctls = 0;
+
+  void setOutputs(quint64 next) {
+    const quint64 SCK = 1, MOSI = 2, CS = 4;
+    if ((out & CS) && !(next & CS)) // 開始傳輸
+      cmd = cmdBits = readBits = 0;
+    if (!(next & CS) && !(out & SCK) && (next & SCK) && cmdBits < 5) {
+      cmd = (cmd << 1) | ((next & MOSI) ? 1 : 0);
+      cmdBits++;
+    }
+    out = next;
+  }
+
+  int misoBit() {
+    const int word = MockSpidev::valueFor(cmd & 7) << 1; // 12 bits，最高位為 null
+    const int k = readBits++;
+    return k < 12 ? (word >> (11 - k)) & 1 : 0;
+  }
+
+  bool handles(int fd) const { return fd >= 0 && (fd == outFd || fd == inFd); }
+
+  int ioctl(int fd, unsigned long request, void *arg) {
+    ioctls++;
+    if (abi == Mcp3008Interface::LineAbi::V1) {
+      struct gpiohandle_data *data = (struct gpiohandle_data *)arg;
+      if (fd == outFd && request == GPIOHANDLE_SET_LINE_VALUES_IOCTL) {
+        setOutputs(quint64(data->values[0] & 1) |
+                   quint64(data->values[1] & 1) << 1 |
+                   quint64(data->values[2] & 1) << 2);
+        return 0;
+      }
+      if (fd == inFd && request == GPIOHANDLE_GET_LINE_VALUES_IOCTL) {
+        memset(data, 0, sizeof(*data));
+        data->values[0] = uint8_t(misoBit());
+        return 0;
+      }
+    }
+#ifdef GPIO_V2_LINES_MAX
+    else {
+      struct gpio_v2_line_values *v = (struct gpio_v2_line_values *)arg;
+      if (request == GPIO_V2_LINE_SET_VALUES_IOCTL) {
+        setOutputs((out & ~v->mask) | (v->bits & v->mask & 0x7));
+        return 0;
+      }
+      if (request == GPIO_V2_LINE_GET_VALUES_IOCTL) {
+        v->bits = (quint64(misoBit()) << 3) & v->mask;
+        return 0;
+      }
+    }
+#endif
+    errno = ENOTTY;
+    return -1;
+  }
+};
+
+MockGpioChip g_mockGpio;
+
+} // namespace
+
+extern "C" int ioctl(int fd, unsigned long request, ...) __THROW {
+  va_list ap;
+  va_start(ap, request);
+  void *arg = va_arg(ap, void *);
+  va_end(ap);
+  if (fd >= 0 && fd == g_mockSpi.fd)
+    return g_mockSpi.message(request, (struct spi_ioc_transfer *)arg);
+  if (g_mockGpio.handles(fd))
+    return g_mockGpio.ioctl(fd, request, arg);
+
+  using IoctlFn = int (*)(int, unsigned long, ...);
+  static IoctlFn real = (IoctlFn)dlsym(RTLD_NEXT, "ioctl");
+  return real(fd, request, arg);
+}
+
+namespace {
+
+// scanChannels 對模擬 spidev：Args = {channelMask, oversample}
+// 0xFF x 64 = 512 次轉換，必須拆成多個 SPI_IOC_MESSAGE 才會成功
+void BM_AdcScanMockSpidev(benchmark::State &state) {
+  const quint8 mask = quint8(state.range(0));
+  const int oversample = int(state.range(1));
+  g_mockSpi = MockSpidev();
+  g_mockSpi.fd = open("/dev/null", O_RDWR);
+  if (g_mockSpi.fd < 0) {
+    state.SkipWithError("無法開啟 /dev/null");
+    return;
+  }
+
+  int channels = 0;
+  for (int ch = 0; ch < 8; ch++)
+    channels += (mask >> ch) & 1;
+
+  {
+    Mcp3008Interface adc(g_mockSpi.fd); // 解構時關閉 fd
+    for (auto _ : state) {
+      const QVector<AdcSample> samples = adc.scanChannels(mask, oversample);
+      bool ok = samples.size() == channels;
+      for (const AdcSample &s : samples)
+        ok = ok && s.value == MockSpidev::valueFor(s.channel);
+      if (!ok) {
+        state.SkipWithError("掃描結果錯誤 (SPI_IOC_MESSAGE 失敗或數值不符)");
+        break;
+      }
+    }
+  }
+
+  if (g_mockSpi.badMessages ||
+      g_mockSpi.maxTransfersPerMessage > Mcp3008Interface::MAX_XFERS_PER_MESSAGE)
+    state.SkipWithError("SPI_IOC_MESSAGE 大小超出 ioctl 編號可表示的範圍");
+  state.counters["xfers_per_scan"] =
+      state.iterations() ? double(g_mockSpi.transfers) / state.iterations()
+                         : 0;
+  state.counters["ioctls_per_scan"] =
+      state.iterations() ? double(g_mockSpi.messages) / state.iterations() : 0;
+  state.SetItemsProcessed(state.iterations() * channels);
+  g_mockSpi.fd = -1;
+}
+BENCHMARK(BM_AdcScanMockSpidev)
+    ->Args({0x01, 1})
+    ->Args({0xFF, 1})
+    ->Args({0xFF, 16})
+    ->Args({0xFF, Mcp3008Interface::MAX_OVERSAMPLE})
+    ->Unit(benchmark::kMicrosecond);
+
+// gpiochip bit-bang 對模擬 line：Arg = 0 為 v1 handle (TX2 的 4.9 核心)、
+// 1 為 v2 line request。量到的是 ioctl 次數與 spin 延遲，不含真實 GPIO 驅動
+void BM_ReadAdcGpioChip(benchmark::State &state) {
+  const bool v2 = state.range(0) != 0;
+#ifndef GPIO_V2_LINES_MAX
+  if (v2) {
+    state.SkipWithError("標頭沒有 gpiochip v2 定義");
+    return;
+  }
+#endif
+  g_mockGpio = MockGpioChip();
+  g_mockGpio.abi =
+      v2 ? Mcp3008Interface::LineAbi::V2 : Mcp3008Interface::LineAbi::V1;
+  g_mockGpio.outFd = open("/dev/null", O_RDWR);
+  g_mockGpio.inFd = v2 ? -1 : open("/dev/null", O_RDWR);
+
+  {
+    Mcp3008Interface adc(g_mockGpio.abi, g_mockGpio.outFd, g_mockGpio.inFd);
+    int channel = 0;
+    for (auto _ : state) {
+      const int value = adc.readAdc(channel);
+      if (value != MockSpidev::valueFor(channel)) {
+        state.SkipWithError("讀到的數值與模擬 MCP3008 不符");
+        break;
+      }
+      channel = (channel + 1) % 8;
+    }
+  }
+  state.counters["ioctls_per_sample"] =
+      state.iterations() ? double(g_mockGpio.ioctls) / state.iterations() : 0;
+  state.SetItemsProcessed(state.iterations());
+  g_mockGpio = MockGpioChip();
+}
+BENCHMARK(BM_ReadAdcGpioChip)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+} // namespace
@@ -0,0 +1,65 @@
+#include "eventrecorder.h"
+#include "synthetic_frames.h"
+#include <QDir>
+#include <QTemporaryDir>
+#include <benchmark/benchmark.h>
+
+/**
+ * 片段寫檔吞吐量：ClipWriter 把 300 張現成 JPEG (30 fps 下 10 秒) 包成 MJPEG AVI
+ * 並更新 index.jsonl，回報 MB/s 與每秒可寫入的影格數；寫檔執行緒的速度必須
+ * 遠高於擷取速率，否則 maxPendingBytes 會開始丟幀
+ *   Args = {寬, 高}
+ */
+
+namespace {
+
+void BM_ClipWrite(benchmark::State &state) {
+  const int frames = 300;
+  const QByteArray jpeg =
+      syntheticJpeg(int(state.range(0)), int(state.range(1)));
+  QTemporaryDir dir;
+  if (jpeg.isEmpty() || !dir.isValid()) {
+    state.SkipWithError("無法產生測試影格或暫存目錄");
+    return;
+  }
+
+  QVector<RecordedFrame> preRoll(frames / 3);
+  for (int i = 0; i < preRoll.size(); i++)
+    preRoll[i] = {jpeg, quint64(i), qint64(i) * 33};
+
+  qint64 bytes = 0;
+  int clip = 0;
+  for (auto _ : state) {
+    ClipWriter writer;
+    int written = 0;
+    QObject::connect(&writer, &ClipWriter::clipFinished,
+                     [&](const QString &, int n, qint64 size) {
+                       written = n;
+                       bytes += size;
+                     });
+    const QString path = dir.filePath(QString("clip_%1.avi").arg(clip++));
+    // 與 EventRecorder 相同：預錄一次交出，其餘逐幀追加
+    writer.begin(path, "bench", preRoll);
+    for (int i = preRoll.size(); i < frames; i++)
+      writer.append({jpeg, quint64(i), qint64(i) * 33});
+    writer.finish(0);
+    if (written != frames) {
+      state.SkipWithError("片段影格數不符");
+      break;
+    }
+    state.PauseTiming();
+    QFile::remove(path);
+    state.ResumeTiming();
+  }
+
+  state.counters["jpeg_kb"] = jpeg.size() / 1024.0;
+  state.counters["fps"] = benchmark::Counter(
+      double(state.iterations()) * frames, benchmark::Counter::kIsRate);
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_ClipWrite)
+    ->Args({640, 480})
+    ->Args({1280, 720})
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace
@@ -0,0 +1,110 @@
+#include "environmentalcontroller.h"
+#include <QFile>
+#include <benchmark/benchmark.h>
+
+/**
+ * 光感測軌跡重播：同一份軌跡分別交給原本的「每次數值改變就判斷」邏輯與
+ * EnvironmentalController (SignalFilter)，比較 LED_YELLOW 的 GPIO 寫入次數
+ * 預設為合成的 10 分鐘 10 Hz 軌跡 (300 -> 900 的黃昏漸變 + 雜訊與突波)；
+ * 設定 GUARDIAN_BENCH_LIGHT_TRACE=<檔案> 改用實際記錄 (每行 "毫秒 數值")
+ */
+
+namespace {
+
+struct LightSample {
+  qint64 ms;
+  int value;
+};
+
+QVector<LightSample> syntheticLightTrace() {
+  QVector<LightSample> trace;
+  quint32 seed = 12345;
+  auto noise = [&seed]() {
+    seed = seed * 1664525u + 1013904223u;
+    return int((seed >> 16) % 61) - 30; // ±30
+  };
+  const int samples = 10 * 60 * 10;
+  for (int i = 0; i < samples; i++) {
+    int value = 300 + 600 * i / samples + noise();
+    if (i % 97 == 0)
+      value += 250; // 偶發突波 (車燈、反光)
+    trace.append({qint64(i) * 100, qBound(0, value, 1023)});
+  }
+  return trace;
+}
+
+QVector<LightSample> loadLightTrace() {
+  const QByteArray path = qgetenv("GUARDIAN_BENCH_LIGHT_TRACE");
+  if (path.isEmpty())
+    return syntheticLightTrace();
+  QVector<LightSample> trace;
+  QFile file(QString::fromLocal8Bit(path));
+  if (file.open(QIODevice::ReadOnly)) {
+    for (QByteArray line : file.readAll().split('\n')) {
+      if (line.startsWith('#'))
+        continue;
+      const QList<QByteArray> fields =
+          line.replace(',', ' ').simplified().split(' ');
+      if (fields.size() >= 2)
+        trace.append({fields[0].toLongLong(), fields[1].toInt()});
+    }
+  }
+  return trace;
+}
+
+// 原本 updateLightLevel 的邏輯：數值一變就發 lightLevelChanged 與 GPIO
+int baselineGpioWrites(const QVector<LightSample> &trace, int *uiUpdates) {
+  int last = -1, writes = 0, updates = 0;
+  for (const LightSample &s : trace) {
+    if (s.value == last)
+      continue;
+    last = s.value;
+    updates++;
+    writes++; // 自動模式下每次都送出 LED_YELLOW
+  }
+  *uiUpdates = updates;
+  return writes;
+}
+
+void BM_LightTraceReplay(benchmark::State &state) {
+  const QVector<LightSample> trace = loadLightTrace();
+  if (trace.isEmpty()) {
+    state.SkipWithError("GUARDIAN_BENCH_LIGHT_TRACE 沒有可用的樣本");
+    return;
+  }
+  // 每批樣本數 (感測器執行緒一次送出的數量)
+  const int batch = int(state.range(0));
+
+  int gpioWrites = 0, uiUpdates = 0;
+  for (auto _ : state) {
+    EnvironmentalController controller;
+    gpioWrites = uiUpdates = 0;
+    QObject::connect(&controller, &EnvironmentalController::requestGpio,
+                     [&gpioWrites](int, int) { gpioWrites++; });
+    QObject::connect(&controller, &EnvironmentalController::lightLevelChanged,
+                     [&uiUpdates](int, const QString &) { uiUpdates++; });
+    QVector<AdcSample> samples;
+    for (int i = 0; i < trace.size(); i++) {
+      AdcSample s;
+      s.channel = 0;
+      s.value = trace[i].value;
+      s.timestampNs = trace[i].ms * 1000000LL;
+      samples.append(s);
+      if (samples.size() == batch || i == trace.size() - 1) {
+        controller.updateLightSamples(samples);
+        samples.clear();
+      }
+    }
+  }
+
+  int baselineUi = 0;
+  state.counters["samples"] = trace.size();
+  state.counters["gpio_writes_before"] = baselineGpioWrites(trace, &baselineUi);
+  state.counters["gpio_writes_after"] = gpioWrites;
+  state.counters["ui_updates_before"] = baselineUi;
+  state.counters["ui_updates_after"] = uiUpdates;
+  state.SetItemsProcessed(state.iterations() * trace.size());
+}
+BENCHMARK(BM_LightTraceReplay)->Arg(1)->Arg(10)->Unit(benchmark::kMillisecond);
+
+} // namespace
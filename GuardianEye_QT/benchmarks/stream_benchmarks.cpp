@@ -0,0 +1,117 @@
+#include "httpserver.h"
+#include "mjpegstreamer.h"
+#include "synthetic_frames.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTcpSocket>
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <sys/resource.h>
+#include <vector>
+
+/**
+ * MJPEG 多人觀看負載：本機 N 個客戶端連到 /stream.mjpg，以 30 fps 發布 640x480
+ * 影格，每輪 1 秒；回報每個客戶端實際收到的影格率、伺服器略過的比例、
+ * 總輸出頻寬與本行程 CPU 使用率 (含伺服器執行緒)
+ *   Args = {客戶端數, 低畫質 (?quality=low)}
+ * 使用 127.0.0.1:GUARDIAN_BENCH_HTTP_PORT (預設 18090)
+ */
+
+namespace {
+
+double cpuSeconds() {
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec +
+         (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+void pumpEvents(qint64 ms) {
+  QElapsedTimer timer;
+  timer.start();
+  while (timer.elapsed() < ms)
+    QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+}
+
+void BM_MjpegClients(benchmark::State &state) {
+  const int clients = int(state.range(0));
+  const bool low = state.range(1) != 0;
+  const QByteArray portEnv = qgetenv("GUARDIAN_BENCH_HTTP_PORT");
+  const quint16 port = portEnv.isEmpty() ? 18090 : quint16(portEnv.toUInt());
+  const QByteArray jpeg = syntheticJpeg(640, 480);
+
+  // 觀看者上限與頻寬設得足夠大，量的是伺服器本身的分送成本
+  MjpegStreamer::Config config;
+  config.maxClients = clients;
+  config.clientBytesPerSec = 64LL * 1024 * 1024;
+  config.totalBytesPerSec = 1024LL * 1024 * 1024;
+  HttpServer server;
+  MjpegStreamer *streamer = new MjpegStreamer(&server, config);
+  server.listen(QHostAddress::LocalHost, port);
+  pumpEvents(100);
+
+  qint64 received = 0;
+  std::vector<std::unique_ptr<QTcpSocket>> sockets;
+  const QByteArray path = low ? "/stream.mjpg?quality=low" : "/stream.mjpg";
+  for (int i = 0; i < clients; i++) {
+    sockets.emplace_back(new QTcpSocket());
+    QTcpSocket *socket = sockets.back().get();
+    QObject::connect(socket, &QTcpSocket::readyRead, [socket, &received]() {
+      received += socket->readAll().size();
+    });
+    socket->connectToHost(QHostAddress::LocalHost, port);
+    socket->write("GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  }
+  QElapsedTimer wait;
+  wait.start();
+  while (streamer->stats().clients < clients && wait.elapsed() < 5000)
+    QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+  if (streamer->stats().clients < clients) {
+    state.SkipWithError("客戶端無法全部連上 (埠號被占用？)");
+    return;
+  }
+
+  const StreamStats before = streamer->stats();
+  const qint64 receivedBefore = received;
+  const double cpuBefore = cpuSeconds();
+  QElapsedTimer elapsed;
+  elapsed.start();
+  quint64 seq = 0;
+  for (auto _ : state) {
+    // 每輪 1 秒、30 張影格 (實際擷取速率)
+    QElapsedTimer frameTimer;
+    frameTimer.start();
+    for (int i = 0; i < 30; i++) {
+      streamer->publishFrame(jpeg, ++seq, 0);
+      while (frameTimer.elapsed() < (i + 1) * 33)
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+    }
+  }
+  pumpEvents(100); // 收完最後一張
+  const double seconds = elapsed.elapsed() / 1000.0;
+  const double cpu = cpuSeconds() - cpuBefore;
+  const StreamStats after = streamer->stats();
+
+  const double sent = double(after.framesSent - before.framesSent);
+  const double dropped = double(after.framesDropped - before.framesDropped);
+  state.counters["client_fps"] = sent / clients / seconds;
+  state.counters["drop_ratio"] =
+      sent + dropped > 0 ? dropped / (sent + dropped) : 0;
+  state.counters["mb_per_s"] =
+      double(after.bytesSent - before.bytesSent) / 1048576.0 / seconds;
+  state.counters["received_mb_per_s"] =
+      (received - receivedBefore) / 1048576.0 / seconds;
+  state.counters["cpu_pct"] = cpu * 100.0 / seconds;
+
+  for (auto &socket : sockets)
+    socket->abort();
+}
+BENCHMARK(BM_MjpegClients)
+    ->Args({1, 0})
+    ->Args({50, 0})
+    ->Args({50, 1})
+    ->Iterations(5)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace
@@ -0,0 +1,115 @@
+#include "pythonaimanager.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <benchmark/benchmark.h>
+
+/**
+ * worker 當機/卡死後的復原時間：以 fake_worker.py (只用標準函式庫，不需攝影機與模型)
+ * 取代 vision_system.py，worker 開始輸出影格後寫入控制檔觸發故障，
+ * 量測到 PythonAiManager 回報影像恢復 (workerStatsChanged 的 down 變回 false) 為止
+ *   Args = {備援 (GUARDIAN_AI_STANDBY), 故障 (0 = 當機、1 = 卡死)}
+ * 卡死需等看門狗逾時 (5 s)，冷啟動包含模擬的模型載入時間 (FAKE_WORKER_LOAD_MS)
+ *   ./guardian_benchmarks --benchmark_filter=WorkerRecovery
+ */
+
+namespace {
+
+const int kFakeLoadMs = 2000;
+
+QString fakeWorkerPath() {
+  return QDir(QStringLiteral(GUARDIAN_BENCH_DIR)).filePath("fake_worker.py");
+}
+
+void BM_WorkerRecovery(benchmark::State &state) {
+  const bool standby = state.range(0) != 0;
+  const bool hang = state.range(1) != 0;
+  const qint64 timeoutMs = 60000;
+  if (!QFile::exists(fakeWorkerPath())) {
+    state.SkipWithError("找不到 benchmarks/fake_worker.py");
+    return;
+  }
+  const QString control = QDir::temp().filePath(
+      QString("guardian_fake_worker_%1.ctl")
+          .arg(QCoreApplication::applicationPid()));
+
+  // PythonAiManager 在建構時讀取設定，worker 由 QProcess 繼承環境變數
+  qputenv("GUARDIAN_AI_SCRIPT", fakeWorkerPath().toLocal8Bit());
+  qputenv("GUARDIAN_AI_STANDBY", standby ? "1" : "0");
+  qputenv("FAKE_WORKER_CONTROL", control.toLocal8Bit());
+  qputenv("FAKE_WORKER_LOAD_MS", QByteArray::number(kFakeLoadMs));
+
+  AiWorkerStats last;
+  QString error;
+  for (auto _ : state) {
+    QFile::remove(control);
+    PythonAiManager manager;
+    manager.setPreviewEnabled(false);
+    bool running = false, wentDown = false, recovered = false;
+    QObject::connect(&manager, &InferenceBackend::statusChanged,
+                     [&running](const QString &msg) {
+                       running |= msg == "fake worker running";
+                     });
+    QObject::connect(&manager, &InferenceBackend::errorOccurred,
+                     [&error](QString msg) { error = msg; });
+    QObject::connect(&manager, &PythonAiManager::workerStatsChanged,
+                     [&](const AiWorkerStats &st) {
+                       wentDown |= st.down;
+                       recovered = wentDown && !st.down;
+                       last = st;
+                     });
+
+    QElapsedTimer timer;
+    timer.start();
+    manager.start();
+    while (error.isEmpty() && !running && timer.elapsed() < timeoutMs)
+      QCoreApplication::processEvents(QEventLoop::AllEvents, 20);
+    // 備援與主要 worker 同時啟動，狀態訊息不會轉發；多等一段時間讓它進入 standby
+    const qint64 settleUntil = timer.elapsed() + (standby ? 1000 : 100);
+    while (timer.elapsed() < settleUntil)
+      QCoreApplication::processEvents(QEventLoop::AllEvents, 20);
+
+    // 觸發故障，worker 在下一幀讀取控制檔
+    QFile ctl(control);
+    if (ctl.open(QIODevice::WriteOnly))
+      ctl.write(hang ? "hang" : "crash");
+    ctl.close();
+    timer.restart();
+    while (error.isEmpty() && !recovered && timer.elapsed() < timeoutMs)
+      QCoreApplication::processEvents(QEventLoop::AllEvents, 20);
+    const qint64 recoveryMs = timer.elapsed();
+
+    manager.stop();
+    QCoreApplication::processEvents(); // 讓 worker 的 deleteLater 執行完
+    if (!recovered) {
+      if (error.isEmpty())
+        error = "worker 故障後沒有恢復影像";
+      break;
+    }
+    state.SetIterationTime(recoveryMs / 1000.0);
+  }
+  QFile::remove(control);
+  qunsetenv("GUARDIAN_AI_SCRIPT");
+  qunsetenv("GUARDIAN_AI_STANDBY");
+
+  if (!error.isEmpty()) {
+    state.SkipWithError(error.toUtf8().constData());
+    return;
+  }
+  state.counters["downtime_ms"] = double(last.lastDowntimeMs);
+  state.counters["crashes"] = double(last.crashes);
+  state.counters["hangs"] = double(last.hangs);
+  state.counters["restarts"] = double(last.restarts);
+  state.counters["failovers"] = double(last.failovers);
+}
+BENCHMARK(BM_WorkerRecovery)
+    ->Args({0, 0})
+    ->Args({1, 0})
+    ->Args({0, 1})
+    ->Args({1, 1})
+    ->Iterations(3)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace
@@ -0,0 +1,29 @@
+#ifndef SYNTHETIC_FRAMES_H
+#define SYNTHETIC_FRAMES_H
+
+#include <QBuffer>
+#include <QImage>
+#include <QPainter>
+
+// 有漸層與文字的影像，壓縮後大小接近實際攝影機畫面
+inline QByteArray syntheticJpeg(int width, int height, int quality = 80) {
+  QImage img(width, height, QImage::Format_RGB888);
+  for (int y = 0; y < height; y++) {
+    uchar *line = img.scanLine(y);
+    for (int x = 0; x < width; x++) {
+      line[x * 3] = uchar(x * 255 / width);
+      line[x * 3 + 1] = uchar(y * 255 / height);
+      line[x * 3 + 2] = uchar((x ^ y) & 0xff);
+    }
+  }
+  QPainter painter(&img);
+  painter.drawText(img.rect(), Qt::AlignCenter, "GuardianEye");
+  painter.end();
+  QByteArray jpeg;
+  QBuffer buffer(&jpeg);
+  buffer.open(QIODevice::WriteOnly);
+  img.save(&buffer, "JPG", quality);
+  return jpeg;
+}
+
+#endif // SYNTHETIC_FRAMES_H
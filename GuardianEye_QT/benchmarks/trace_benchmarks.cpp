@@ -0,0 +1,65 @@
+#include "tracing.h"
+#include <QThread>
+#include <benchmark/benchmark.h>
+
+/**
+ * 追蹤的熱路徑成本與執行緒生命週期：
+ *   TraceRecord：已取得緩衝區的執行緒記錄一個 span (開啟/關閉)
+ *   TraceThreadChurn：反覆建立只記錄一次就結束的執行緒 (QThreadPool 的短命工作者)，
+ *   結束的執行緒必須歸還緩衝區，總數不能隨建立過的執行緒數增加
+ */
+
+namespace {
+
+void BM_TraceRecord(benchmark::State &state) {
+  const bool enabled = state.range(0) != 0;
+  Tracer::setEnabled(enabled);
+  Tracer::registerThread();
+  for (auto _ : state) {
+    TraceScope scope("bench.record");
+    benchmark::ClobberMemory();
+  }
+  Tracer::setEnabled(false);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TraceRecord)->Arg(0)->Arg(1);
+
+class OneSpanThread : public QThread {
+protected:
+  void run() override { TraceScope scope("bench.thread"); }
+};
+
+// Arg = 每輪同時存在的執行緒數
+void BM_TraceThreadChurn(benchmark::State &state) {
+  const int concurrent = int(state.range(0));
+  Tracer::setEnabled(true);
+  const int ringsBefore = Tracer::ringCount();
+  int threads = 0;
+  for (auto _ : state) {
+    QVector<OneSpanThread *> batch;
+    for (int i = 0; i < concurrent; i++) {
+      batch.append(new OneSpanThread);
+      batch.last()->start();
+    }
+    for (OneSpanThread *thread : batch) {
+      thread->wait();
+      delete thread;
+    }
+    threads += concurrent;
+  }
+  Tracer::setEnabled(false);
+
+  const int ringsAfter = Tracer::ringCount();
+  // 上限：預先配置的數量或同時存在的執行緒數 (加上本執行緒)
+  if (ringsAfter > qMax(ringsBefore, concurrent + 1) + 1)
+    state.SkipWithError("結束的執行緒沒有歸還追蹤緩衝區");
+  state.counters["threads"] = threads;
+  state.counters["rings"] = ringsAfter;
+  state.counters["ring_mb"] = ringsAfter * 8192.0 * 24 / 1048576.0;
+}
+BENCHMARK(BM_TraceThreadChurn)
+    ->Arg(1)
+    ->Arg(32)
+    ->Unit(benchmark::kMicrosecond);
+
+} // namespace
@@ -1,10 +1,32 @@
 #include "blackboxinterface.h"
+#include "metrics.h"
+#include "tracing.h"
 #include <QDebug>
 #include <QFile>
+#include <errno.h>
 #include <fcntl.h>
 #include <unistd.h>
 
 BlackboxInterface::BlackboxInterface(QObject *parent) : QObject(parent) {
+  static const char *const COMMAND_NAMES[CmdCount] = {
+      "log_event",       "set_gpio",       "set_gpio_batch",
+      "start_emergency", "stop_emergency", "get_emergency_status",
+      "get_driver_stats"};
+  MetricsRegistry &metrics = MetricsRegistry::instance();
+  for (int i = 0; i < CmdCount; i++) {
+    const QString labels = QString("cmd=\"%1\"").arg(COMMAND_NAMES[i]);
+    m_ioctlLatency[i] = &metrics.histogram(
+        "guardian_blackbox_ioctl_seconds",
+        "Latency of /dev/blackbox ioctl calls", labels);
+    m_ioctlErrors[i] = &metrics.counter("guardian_blackbox_ioctl_errors_total",
+                                        "Failed /dev/blackbox ioctl calls",
+                                        labels);
+  }
+
+  if (hardwareSimulated()) {
+    qDebug() << "BlackboxInterface: 模擬硬體模式，不開啟 /dev/blackbox";
+    return;
+  }
   m_fd = open("/dev/blackbox", O_RDWR);
   if (m_fd < 0) {
     qDebug() << "BlackboxInterface: 無法開啟 /dev/blackbox";
@@ -16,6 +38,24 @@ BlackboxInterface::~BlackboxInterface() {
     close(m_fd);
 }
 
+int BlackboxInterface::timedIoctl(IoctlCommand command, unsigned long request,
+                                  void *arg) {
+  static const char *const TRACE_NAMES[CmdCount] = {
+      "ioctl.log_event",       "ioctl.set_gpio",
+      "ioctl.set_gpio_batch",  "ioctl.start_emergency",
+      "ioctl.stop_emergency",  "ioctl.get_emergency_status",
+      "ioctl.get_driver_stats"};
+  int ret;
+  {
+    TRACE_SCOPE(TRACE_NAMES[command]);
+    MetricTimer timer(*m_ioctlLatency[command]);
+    ret = ioctl(m_fd, request, arg);
+  }
+  if (ret < 0)
+    m_ioctlErrors[command]->inc();
+  return ret;
+}
+
 void BlackboxInterface::logEvent(const QString &message, int priority) {
   if (m_fd < 0)
     return;
@@ -25,7 +65,7 @@ void BlackboxInterface::logEvent(const QString &message, int priority) {
   event.message[255] = '\0';
   event.priority = priority;
 
-  if (ioctl(m_fd, LOG_EVENT, &event) < 0) {
+  if (timedIoctl(CmdLogEvent, LOG_EVENT, &event) < 0) {
     qDebug() << "BlackboxInterface: ioctl 寫入失敗";
   }
 }
@@ -38,11 +78,42 @@ void BlackboxInterface::setGpio(int pin, int value) {
   cmd.pin = pin;
   cmd.value = value;
 
-  if (ioctl(m_fd, SET_GPIO_VALUE, &cmd) < 0) {
+  if (timedIoctl(CmdSetGpio, SET_GPIO_VALUE, &cmd) < 0) {
     qDebug() << "BlackboxInterface: GPIO ioctl 失敗";
   }
 }
 
+void BlackboxInterface::setGpioBatch(const QVector<QPair<int, int>> &writes) {
+  if (m_fd < 0 || writes.isEmpty())
+    return;
+
+  if (m_batchSupported) {
+    for (int start = 0; start < writes.size(); start += GPIO_BATCH_MAX) {
+      struct gpio_batch batch;
+      batch.count = qMin(GPIO_BATCH_MAX, writes.size() - start);
+      for (int i = 0; i < batch.count; i++) {
+        batch.cmds[i].pin = writes[start + i].first;
+        batch.cmds[i].value = writes[start + i].second;
+      }
+      if (timedIoctl(CmdSetGpioBatch, SET_GPIO_BATCH, &batch) < 0) {
+        if (errno != EINVAL || start > 0) {
+          qDebug() << "BlackboxInterface: GPIO 批次 ioctl 失敗";
+          return;
+        }
+        // 舊版驅動不支援批次指令，改回逐一設定
+        qDebug() << "BlackboxInterface: 驅動不支援 SET_GPIO_BATCH，改用逐一設定";
+        m_batchSupported = false;
+        break;
+      }
+    }
+    if (m_batchSupported)
+      return;
+  }
+
+  for (const auto &w : writes)
+    setGpio(w.first, w.second);
+}
+
 QString BlackboxInterface::readLogs() {
   QFile file("/dev/blackbox");
   if (!file.open(QIODevice::ReadOnly)) {
@@ -54,26 +125,126 @@ QString BlackboxInterface::readLogs() {
 void BlackboxInterface::startEmergency(int minutes) {
   if (m_fd < 0)
     return;
-  if (ioctl(m_fd, START_EMERGENCY, &minutes) < 0) {
+  if (timedIoctl(CmdStartEmergency, START_EMERGENCY, &minutes) < 0) {
     qDebug() << "BlackboxInterface: START_EMERGENCY ioctl 失敗";
+    return;
   }
+  emit emergencyStateChanged(true);
 }
 
 void BlackboxInterface::stopEmergency() {
   if (m_fd < 0)
     return;
-  if (ioctl(m_fd, STOP_EMERGENCY) < 0) {
+  if (timedIoctl(CmdStopEmergency, STOP_EMERGENCY, nullptr) < 0) {
     qDebug() << "BlackboxInterface: STOP_EMERGENCY ioctl 失敗";
+    return;
   }
+  emit emergencyStateChanged(false);
 }
 
 int BlackboxInterface::getRemainingSeconds() {
   if (m_fd < 0)
     return 0;
   int seconds = 0;
-  if (ioctl(m_fd, GET_EMERGENCY_STATUS, &seconds) < 0) {
+  if (timedIoctl(CmdEmergencyStatus, GET_EMERGENCY_STATUS, &seconds) < 0) {
     qDebug() << "BlackboxInterface: GET_EMERGENCY_STATUS ioctl 失敗";
     return 0;
   }
   return seconds;
 }
+
+// 驅動的計數是累計值 (模組重新載入時歸零)，轉成增量累加到本程序的 counter
+static void addDelta(MetricCounter &counter, unsigned long long now,
+                     unsigned long long &last) {
+  counter.inc(now >= last ? now - last : now);
+  last = now;
+}
+
+bool BlackboxInterface::publishDriverStats() {
+  static const char *const PRIO_NAMES[BB_STATS_PRIO_COUNT] = {
+      "info", "warning", "critical"};
+  // 與驅動的 ioctl_names 相同，索引為 _IOC_NR
+  static const char *const IOCTL_NAMES[BB_STATS_IOCTL_SLOTS] = {
+      nullptr,
+      "log_event",
+      "clear_log",
+      "set_gpio",
+      "start_emergency",
+      "stop_emergency",
+      "get_emergency_status",
+      "set_gpio_batch",
+      "get_log_stats",
+      "get_driver_stats",
+  };
+
+  if (m_fd < 0 || !m_driverStatsSupported)
+    return false;
+
+  blackbox_stats st;
+  if (timedIoctl(CmdDriverStats, GET_DRIVER_STATS, &st) < 0) {
+    if (errno == EINVAL || errno == ENOTTY) {
+      qDebug() << "BlackboxInterface: 驅動不支援 GET_DRIVER_STATS，停止讀取統計";
+      m_driverStatsSupported = false;
+      return false;
+    }
+    qDebug() << "BlackboxInterface: GET_DRIVER_STATS ioctl 失敗";
+    return true;
+  }
+
+  MetricsRegistry &metrics = MetricsRegistry::instance();
+  blackbox_stats &last = m_lastDriverStats;
+  // 第一次讀到的是驅動載入以來的累計值，只當基準，不計入本程序的 counter
+  if (!m_driverStatsSeeded) {
+    last = st;
+    m_driverStatsSeeded = true;
+  }
+  for (int p = 0; p < BB_STATS_PRIO_COUNT; p++) {
+    const QString labels = QString("priority=\"%1\"").arg(PRIO_NAMES[p]);
+    addDelta(metrics.counter("guardian_driver_events_total",
+                             "Events written to the blackbox driver log",
+                             labels),
+             st.events[p], last.events[p]);
+    addDelta(metrics.counter("guardian_driver_overwritten_total",
+                             "Unread driver log records overwritten when full",
+                             labels),
+             st.overwritten[p], last.overwritten[p]);
+    metrics
+        .gauge("guardian_driver_log_capacity_records",
+               "Driver log capacity in records per CPU", labels)
+        .set(st.capacity[p]);
+    metrics
+        .gauge("guardian_driver_log_used_records",
+               "Unread records in the driver log", labels)
+        .set(st.used[p]);
+  }
+  addDelta(metrics.counter("guardian_driver_dropped_bytes_total",
+                           "Message bytes lost to driver log overwrites"),
+           st.dropped_bytes, last.dropped_bytes);
+  addDelta(metrics.counter("guardian_driver_reads_total",
+                           "read() calls on /dev/blackbox"),
+           st.reads, last.reads);
+  addDelta(metrics.counter("guardian_driver_read_bytes_total",
+                           "Bytes returned by /dev/blackbox reads"),
+           st.read_bytes, last.read_bytes);
+  for (int nr = 1; nr < BB_STATS_IOCTL_SLOTS; nr++) {
+    const QString labels = QString("cmd=\"%1\"").arg(IOCTL_NAMES[nr]);
+    addDelta(metrics.counter("guardian_driver_ioctl_calls_total",
+                             "ioctl calls handled by the driver (all clients)",
+                             labels),
+             st.ioctl_calls[nr], last.ioctl_calls[nr]);
+    addDelta(metrics.counter("guardian_driver_ioctl_nanoseconds_total",
+                             "Time spent in driver ioctl handlers", labels),
+             st.ioctl_ns[nr], last.ioctl_ns[nr]);
+  }
+  addDelta(metrics.counter("guardian_driver_emergency_timer_fires_total",
+                           "Driver emergency countdown timer callbacks"),
+           st.emergency_timer_fires, last.emergency_timer_fires);
+  addDelta(metrics.counter("guardian_driver_printk_suppressed_total",
+                           "Per-event kernel log lines dropped by rate limit"),
+           st.printk_suppressed, last.printk_suppressed);
+  metrics
+      .gauge("guardian_driver_lock_max_hold_seconds",
+             "Longest hold of the driver log spinlock")
+      .set(st.lock_max_hold_ns / 1e9);
+  return true;
+}
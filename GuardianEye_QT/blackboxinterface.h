@@ -3,7 +3,12 @@
 
 #include "hardwareinterface.h"
 #include <QObject>
+#include <QPair>
 #include <QString>
+#include <QVector>
+
+class MetricCounter;
+class MetricHistogram;
 
 class BlackboxInterface : public QObject {
   Q_OBJECT
@@ -14,6 +19,7 @@ public:
 public slots:
   void logEvent(const QString &message, int priority);
   void setGpio(int pin, int value);
+  void setGpioBatch(const QVector<QPair<int, int>> &writes);
   QString readLogs();
 
   // 緊急倒數功能
@@ -21,8 +27,36 @@ public slots:
   void stopEmergency();
   int getRemainingSeconds();
 
+  // 讀取驅動統計並更新 guardian_driver_* 指標；
+  // 沒有驅動或驅動不支援 GET_DRIVER_STATS 時回傳 false
+  bool publishDriverStats();
+
+signals:
+  // 驅動的緊急計時器會自行控制 LED_RED/BUZZER/EXPLOSION_TRIGGER
+  void emergencyStateChanged(bool active);
+
 private:
   int m_fd = -1;
+  bool m_batchSupported = true;
+  bool m_driverStatsSupported = true;
+  blackbox_stats m_lastDriverStats = {}; // 上次讀到的累計值，換算成增量
+  bool m_driverStatsSeeded = false;      // 已讀過一次，m_lastDriverStats 有效
+
+  // 每種 ioctl 各自的次數/延遲/失敗統計
+  enum IoctlCommand {
+    CmdLogEvent,
+    CmdSetGpio,
+    CmdSetGpioBatch,
+    CmdStartEmergency,
+    CmdStopEmergency,
+    CmdEmergencyStatus,
+    CmdDriverStats,
+    CmdCount
+  };
+  MetricHistogram *m_ioctlLatency[CmdCount];
+  MetricCounter *m_ioctlErrors[CmdCount];
+
+  int timedIoctl(IoctlCommand command, unsigned long request, void *arg);
 };
 
 #endif // BLACKBOXINTERFACE_H
@@ -0,0 +1,116 @@
+#include "detectionfusion.h"
+
+DetectionFusion::DetectionFusion() : DetectionFusion(Config()) {}
+
+DetectionFusion::DetectionFusion(const Config &config) : m_config(config) {
+  if (m_config.windowSize < 1)
+    m_config.windowSize = 1;
+  m_config.enterVotes = qBound(1, m_config.enterVotes, m_config.windowSize);
+}
+
+DetectionFusion::Track &DetectionFusion::track(const QString &type) {
+  auto it = m_tracks.find(type);
+  if (it == m_tracks.end()) {
+    Track t;
+    t.confidences.fill(0.0, m_config.windowSize);
+    t.boxes.resize(m_config.windowSize);
+    t.seqs.fill(0, m_config.windowSize);
+    it = m_tracks.insert(type, t);
+  }
+  return it.value();
+}
+
+QVector<DetectionEvent>
+DetectionFusion::update(const QVector<DetectionObservation> &observations,
+                        quint64 frameSeq, qint64 timestampMs) {
+  QVector<DetectionEvent> events;
+
+  for (const DetectionObservation &obs : observations)
+    track(obs.type);
+
+  for (auto it = m_tracks.begin(); it != m_tracks.end(); ++it) {
+    Track &t = it.value();
+
+    // 本幀此類別的結果 (同類別多筆時取信心度最高者)
+    double conf = 0;
+    QRect box;
+    for (const DetectionObservation &obs : observations) {
+      if (obs.type == it.key() && obs.confidence > conf) {
+        conf = obs.confidence;
+        box = obs.bbox;
+      }
+    }
+
+    // 推入滑動視窗
+    if (t.confidences[t.pos] > 0)
+      t.hits--;
+    t.confidences[t.pos] = conf;
+    t.boxes[t.pos] = box;
+    t.seqs[t.pos] = frameSeq;
+    if (conf > 0)
+      t.hits++;
+    t.pos = (t.pos + 1) % m_config.windowSize;
+
+    if (t.active && conf > 0) {
+      t.episodeSum += conf;
+      t.episodeHits++;
+      if (conf > t.peak) {
+        t.peak = conf;
+        t.peakBox = box;
+        t.peakSeq = frameSeq;
+      }
+    }
+
+    if (!t.active && t.hits >= m_config.enterVotes) {
+      double sum = 0;
+      t.peak = 0;
+      for (int i = 0; i < m_config.windowSize; i++) {
+        sum += t.confidences[i];
+        if (t.confidences[i] > t.peak) {
+          t.peak = t.confidences[i];
+          t.peakBox = t.boxes[i];
+          t.peakSeq = t.seqs[i];
+        }
+      }
+      double mean = sum / t.hits;
+      if (mean < m_config.minConfidence)
+        continue;
+
+      t.active = true;
+      t.episodeSum = sum;
+      t.episodeHits = t.hits;
+
+      DetectionEvent ev;
+      ev.type = it.key();
+      ev.entered = true;
+      ev.peakConfidence = t.peak;
+      ev.meanConfidence = mean;
+      ev.bbox = t.peakBox;
+      ev.bboxSeq = t.peakSeq;
+      ev.frameSeq = frameSeq;
+      ev.timestampMs = timestampMs;
+      events.append(ev);
+    } else if (t.active && t.hits <= m_config.leaveVotes) {
+      t.active = false;
+
+      DetectionEvent ev;
+      ev.type = it.key();
+      ev.entered = false;
+      ev.peakConfidence = t.peak;
+      ev.meanConfidence = t.episodeHits ? t.episodeSum / t.episodeHits : 0;
+      ev.bbox = t.peakBox;
+      ev.bboxSeq = t.peakSeq;
+      ev.frameSeq = frameSeq;
+      ev.timestampMs = timestampMs;
+      events.append(ev);
+    }
+  }
+  return events;
+}
+
+bool DetectionFusion::isActive(const QString &type) const {
+  auto it = m_tracks.constFind(type);
+  return it != m_tracks.constEnd() && it.value().active;
+}
+
+void DetectionFusion::reset() { m_tracks.clear(); }
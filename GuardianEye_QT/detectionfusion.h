@@ -0,0 +1,77 @@
+#ifndef DETECTIONFUSION_H
+#define DETECTIONFUSION_H
+
+#include <QMap>
+#include <QMetaType>
+#include <QRect>
+#include <QString>
+#include <QVector>
+
+// 單幀中某一類別的偵測結果 (由 AI 後端解析而來)
+struct DetectionObservation {
+  QString type; // "owner" / "stranger" / "pig"
+  double confidence = 0;
+  QRect bbox;
+};
+
+// 融合後的狀態轉換事件：某類別進入或離開畫面
+struct DetectionEvent {
+  QString type;
+  bool entered = false;
+  double peakConfidence = 0;
+  double meanConfidence = 0; // 進入時為視窗內平均，離開時為整段平均
+  QRect bbox;                // 峰值信心度當下的框
+  quint64 bboxSeq = 0;       // bbox 所屬的影格序號
+  quint64 frameSeq = 0;      // 觸發此事件的影格序號
+  qint64 timestampMs = 0;
+};
+Q_DECLARE_METATYPE(DetectionEvent)
+
+/**
+ * DetectionFusion
+ * 每個類別維護最近 M 幀的滑動視窗，M 幀中至少 N 幀命中且平均信心度
+ * 足夠才視為「進入」，命中數降到 leaveVotes 以下才視為「離開」，
+ * 藉此濾掉單幀誤判並把逐幀訊號收斂為少量的狀態轉換事件
+ */
+class DetectionFusion {
+public:
+  struct Config {
+    int windowSize = 8;         // M
+    int enterVotes = 4;         // N
+    int leaveVotes = 1;         // 命中數 <= 此值即離開
+    double minConfidence = 0.5; // 進入所需的視窗平均信心度
+  };
+
+  DetectionFusion();
+  explicit DetectionFusion(const Config &config);
+
+  // 餵入一幀的所有偵測結果，回傳本幀產生的狀態轉換 (通常為空)
+  QVector<DetectionEvent>
+  update(const QVector<DetectionObservation> &observations, quint64 frameSeq,
+         qint64 timestampMs);
+
+  bool isActive(const QString &type) const;
+  void reset();
+
+private:
+  struct Track {
+    QVector<double> confidences; // 環形視窗，0 表示該幀未命中
+    QVector<QRect> boxes;
+    QVector<quint64> seqs;
+    int pos = 0;
+    int hits = 0;
+    bool active = false;
+    double peak = 0;
+    QRect peakBox;
+    quint64 peakSeq = 0;
+    double episodeSum = 0;
+    int episodeHits = 0;
+  };
+
+  Config m_config;
+  QMap<QString, Track> m_tracks;
+
+  Track &track(const QString &type);
+};
+
+#endif // DETECTIONFUSION_H
@@ -1,20 +1,37 @@
 #include "emergencycontroller.h"
+#include "metrics.h"
+#include "timerwheel.h"
+#include "tracing.h"
 #include <QDebug>
 
+static MetricCounter &emergencyEvents(const char *event) {
+  return MetricsRegistry::instance().counter(
+      "guardian_emergency_events_total", "Emergency countdown transitions",
+      QString("event=\"%1\"").arg(event));
+}
+
+static MetricGauge &remainingGauge() {
+  static MetricGauge &gauge = MetricsRegistry::instance().gauge(
+      "guardian_emergency_remaining_seconds",
+      "Seconds left on the emergency countdown (0 = inactive)");
+  return gauge;
+}
+
 EmergencyController::EmergencyController(BlackboxInterface *interface,
-                                         QObject *parent)
+                                         TimerWheel *timers, QObject *parent)
     : QObject(parent), m_interface(interface) {
 
-  // 設置輪詢定時器，每 500ms 檢查一次驅動狀態，保持 UI 同步
-  m_pollTimer = new QTimer(this);
-  connect(m_pollTimer, &QTimer::timeout, this,
-          &EmergencyController::pollDriverStatus);
-  m_pollTimer->start(500);
+  // 每 500ms 檢查一次驅動狀態，保持 UI 同步；
+  // 允許晚 100ms，與每秒的日誌/感測器輪詢共用喚醒
+  timers->scheduleRepeating(
+      "emergency.poll", 500, this, [this]() { pollDriverStatus(); }, 100);
 }
 
 void EmergencyController::triggerPigBomb(int minutes) {
   qDebug() << "💣 EmergencyController: Triggering Pig Bomb for" << minutes
            << "minutes";
+  static MetricCounter &triggered = emergencyEvents("triggered");
+  triggered.inc();
   m_interface->startEmergency(minutes);
   m_isActive = true;
   m_interface->logEvent("小豬炸彈倒數啟動", 2); // CRITICAL priority
@@ -25,9 +42,12 @@ void EmergencyController::disarmBomb() {
     return;
 
   qDebug() << "🛡️ EmergencyController: Disarming Bomb";
+  static MetricCounter &disarmed = emergencyEvents("disarmed");
+  disarmed.inc();
   m_interface->stopEmergency();
   m_isActive = false;
   m_lastRemainingSeconds = 0;
+  remainingGauge().set(0);
   m_interface->logEvent("炸彈解除成功", 1); // WARNING priority
   emit bombDisarmed();
 }
@@ -39,6 +59,7 @@ int EmergencyController::getRemainingSeconds() const {
 }
 
 void EmergencyController::pollDriverStatus() {
+  TRACE_SCOPE("emergency.pollDriverStatus");
   int seconds = m_interface->getRemainingSeconds();
 
   // 狀態變化偵測
@@ -49,13 +70,17 @@ void EmergencyController::pollDriverStatus() {
 
     if (seconds != m_lastRemainingSeconds) {
       m_lastRemainingSeconds = seconds;
+      remainingGauge().set(seconds);
       emit countdownUpdated(seconds, formatTime(seconds));
     }
   } else {
     // 如果秒數變為 0 且原本是啟動狀態
     if (m_isActive) {
+      static MetricCounter &exploded = emergencyEvents("exploded");
+      exploded.inc();
       m_isActive = false;
       m_lastRemainingSeconds = 0;
+      remainingGauge().set(0);
       emit bombExploded();
       qDebug() << "💥 EmergencyController: BOMB EXPLODED!";
     }
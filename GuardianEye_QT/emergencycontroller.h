@@ -3,8 +3,8 @@
 
 #include "blackboxinterface.h"
 #include <QObject>
-#include <QTimer>
 
+class TimerWheel;
 
 /**
  * EmergencyController (OOP)
@@ -13,8 +13,8 @@
 class EmergencyController : public QObject {
   Q_OBJECT
 public:
-  explicit EmergencyController(BlackboxInterface *interface,
-                               QObject *parent = nullptr);
+  EmergencyController(BlackboxInterface *interface, TimerWheel *timers,
+                      QObject *parent = nullptr);
 
   // 業務邏輯接口
   void triggerPigBomb(int minutes = 5);
@@ -32,7 +32,6 @@ private slots:
 
 private:
   BlackboxInterface *m_interface;
-  QTimer *m_pollTimer;
   int m_lastRemainingSeconds = 0;
   bool m_isActive = false;
 
@@ -1,25 +1,45 @@
 #include "environmentalcontroller.h"
 #include "hardwareinterface.h"
+#include "tracing.h"
+#include <QElapsedTimer>
+
+static SignalFilter::Config lightFilterConfig() {
+  SignalFilter::Config config;
+  config.medianWindow = 5;
+  config.emaAlpha = 0.3;
+  config.thresholds << 500 << 800;
+  config.hysteresis = 40;
+  config.minDwellMs = 2000;
+  return config;
+}
 
 EnvironmentalController::EnvironmentalController(QObject *parent)
-    : QObject(parent) {}
+    : QObject(parent), m_lightFilter(lightFilterConfig()) {}
 
 void EnvironmentalController::updateLightLevel(int value) {
-  if (value == m_lastValue)
+  QElapsedTimer clock;
+  clock.start();
+  AdcSample sample;
+  sample.channel = 0;
+  sample.value = value;
+  sample.timestampNs = clock.msecsSinceReference() * 1000000LL;
+  updateLightSamples(QVector<AdcSample>() << sample);
+}
+
+void EnvironmentalController::updateLightSamples(
+    const QVector<AdcSample> &samples) {
+  TRACE_SCOPE("env.updateLightSamples");
+  // 只有濾波後的 level 改變時才更新 UI 與硬體
+  if (!m_lightFilter.ingest(samples))
     return;
-  m_lastValue = value;
 
-  QString mode = (value < 500) ? "白天" : (value < 800) ? "黃昏" : "夜晚";
-  emit lightLevelChanged(value, mode);
+  static const char *modes[] = {"白天", "黃昏", "夜晚"};
+  emit lightLevelChanged(m_lightFilter.value(),
+                         QString::fromUtf8(modes[m_lightFilter.level()]));
 
   // 自動夜燈邏輯 (項目三)
-  if (m_autoMode) {
-    if (value < 500) {
-      emit requestGpio(LED_YELLOW, 0);
-    } else {
-      emit requestGpio(LED_YELLOW, 1);
-    }
-  }
+  if (m_autoMode)
+    applyLightLevel();
 }
 
 void EnvironmentalController::setAutoMode(bool enabled) {
@@ -28,19 +48,25 @@ void EnvironmentalController::setAutoMode(bool enabled) {
     emit autoModeChanged(m_autoMode);
 
     // 如果切換回自動模式，立即套用當前亮度的設定
-    if (m_autoMode && m_lastValue != -1) {
-      if (m_lastValue < 500) {
-        emit requestGpio(LED_YELLOW, 0);
-      } else {
-        emit requestGpio(LED_YELLOW, 1);
-      }
-    }
+    if (m_autoMode && m_lightFilter.hasValue())
+      applyLightLevel();
   }
 }
 
 void EnvironmentalController::setManualLed(bool on) {
   if (!m_autoMode) {
     m_manualLedState = on;
-    emit requestGpio(LED_YELLOW, m_manualLedState ? 1 : 0);
+    requestYellowLed(m_manualLedState ? 1 : 0);
   }
 }
+
+void EnvironmentalController::applyLightLevel() {
+  requestYellowLed(m_lightFilter.level() > 0 ? 1 : 0);
+}
+
+void EnvironmentalController::requestYellowLed(int value) {
+  if (value == m_yellowLed)
+    return;
+  m_yellowLed = value;
+  emit requestGpio(LED_YELLOW, value);
+}
@@ -1,6 +1,7 @@
 #ifndef ENVIRONMENTALCONTROLLER_H
 #define ENVIRONMENTALCONTROLLER_H
 
+#include "signalfilter.h"
 #include <QObject>
 
 class EnvironmentalController : public QObject {
@@ -10,6 +11,7 @@ public:
 
 public slots:
   void updateLightLevel(int value);
+  void updateLightSamples(const QVector<AdcSample> &samples);
   void setAutoMode(bool enabled);
   void setManualLed(bool on);
 
@@ -19,9 +21,14 @@ signals:
   void requestGpio(int pin, int value);
 
 private:
-  int m_lastValue = -1;
+  // 光敏電阻濾波：level 0=白天 (<500), 1=黃昏 (<800), 2=夜晚
+  SignalFilter m_lightFilter;
+  int m_yellowLed = -1; // 最後一次要求的黃燈狀態，-1 = 尚未設定
   bool m_autoMode = true;
   bool m_manualLedState = false;
+
+  void applyLightLevel();
+  void requestYellowLed(int value);
 };
 
 #endif // ENVIRONMENTALCONTROLLER_H
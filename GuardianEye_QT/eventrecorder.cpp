@@ -0,0 +1,220 @@
+#include "eventrecorder.h"
+#include <QBuffer>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTimer>
+
+// --- ClipWriter (寫檔執行緒) ---
+
+void ClipWriter::begin(const QString &path, const QString &reason,
+                       const QVector<RecordedFrame> &preRoll) {
+  m_path = path;
+  m_reason = reason;
+  m_firstMs = 0;
+  m_lastMs = 0;
+  for (const RecordedFrame &frame : preRoll)
+    write(frame);
+}
+
+void ClipWriter::append(const RecordedFrame &frame) { write(frame); }
+
+void ClipWriter::write(const RecordedFrame &frame) {
+  pendingBytes -= frame.jpeg.size();
+
+  if (!m_avi.isOpen()) {
+    // 只讀 JPEG 檔頭取得尺寸，不解碼
+    QBuffer buffer;
+    buffer.setData(frame.jpeg);
+    QImageReader reader(&buffer, "JPG");
+    QSize size = reader.size();
+    if (!size.isValid() || !m_avi.open(m_path, size.width(), size.height()))
+      return;
+    m_firstMs = frame.timestampMs;
+  }
+  if (m_avi.writeFrame(frame.jpeg))
+    m_lastMs = frame.timestampMs;
+}
+
+void ClipWriter::finish(quint64 dropped) {
+  if (!m_avi.isOpen()) {
+    qDebug() << "ClipWriter: 片段沒有任何影格，略過" << m_path;
+    return;
+  }
+
+  const int frames = m_avi.frameCount();
+  const qint64 spanMs = m_lastMs - m_firstMs;
+  const double fps = (frames > 1 && spanMs > 0)
+                         ? (frames - 1) * 1000.0 / spanMs
+                         : 0;
+  const qint64 bytes = m_avi.bytesWritten();
+  if (!m_avi.close(fps)) {
+    qDebug() << "ClipWriter: 寫入失敗" << m_path;
+    return;
+  }
+
+  // 片段索引：每行一筆 JSON，供 Web 端或事後查詢
+  QFile index(QFileInfo(m_path).absoluteDir().filePath("index.jsonl"));
+  if (index.open(QIODevice::WriteOnly | QIODevice::Append)) {
+    QJsonObject entry{{"file", QFileInfo(m_path).fileName()},
+                      {"reason", m_reason},
+                      {"start_ms", m_firstMs},
+                      {"end_ms", m_lastMs},
+                      {"frames", frames},
+                      {"fps", fps},
+                      {"bytes", bytes},
+                      {"dropped", double(dropped)}};
+    index.write(QJsonDocument(entry).toJson(QJsonDocument::Compact));
+    index.write("\n");
+  }
+
+  qDebug() << "ClipWriter: 已儲存" << m_path << frames << "幀"
+           << QString::number(fps, 'f', 1) << "fps";
+  emit clipFinished(m_path, frames, bytes);
+}
+
+// --- EventRecorder ---
+
+EventRecorder::EventRecorder(QObject *parent)
+    : EventRecorder(Config(), parent) {}
+
+EventRecorder::EventRecorder(const Config &config, QObject *parent)
+    : QObject(parent), m_config(config), m_finishTimer(new QTimer(this)),
+      m_thread(new QThread(this)), m_writer(new ClipWriter()) {
+  QDir().mkpath(m_config.clipDir);
+
+  m_finishTimer->setSingleShot(true);
+  connect(m_finishTimer, &QTimer::timeout, this, &EventRecorder::finishClip);
+
+  m_writer->moveToThread(m_thread);
+  connect(m_thread, &QThread::finished, m_writer, &QObject::deleteLater);
+  connect(m_writer, &ClipWriter::clipFinished, this,
+          &EventRecorder::clipFinished);
+  m_thread->start(QThread::LowPriority);
+}
+
+EventRecorder::~EventRecorder() {
+  // 排在已送出的影格之後收尾，確保片段完整寫入後才結束寫檔執行緒
+  ClipWriter *writer = m_writer;
+  const bool recording = m_recording;
+  const quint64 dropped = m_clipDropped;
+  QTimer::singleShot(0, writer, [writer, recording, dropped]() {
+    if (recording)
+      writer->finish(dropped);
+    QThread::currentThread()->quit();
+  });
+  m_thread->wait();
+}
+
+RecorderStats EventRecorder::stats() const {
+  RecorderStats s;
+  s.bufferedFrames = m_ring.size();
+  s.bufferedBytes = m_ringBytes;
+  s.pendingBytes = m_writer->pendingBytes.load();
+  s.evicted = m_evicted;
+  s.dropped = m_dropped;
+  s.clipsWritten = m_clipsWritten;
+  return s;
+}
+
+void EventRecorder::addFrame(const QByteArray &jpeg, quint64 seq,
+                             qint64 timestampMs) {
+  if (jpeg.isEmpty())
+    return;
+
+  RecordedFrame frame;
+  frame.jpeg = jpeg;
+  frame.seq = seq;
+  frame.timestampMs = timestampMs;
+
+  m_ring.enqueue(frame);
+  m_ringBytes += jpeg.size();
+  trimRing(timestampMs);
+
+  if (m_recording)
+    sendToWriter(frame);
+}
+
+void EventRecorder::trimRing(qint64 newestMs) {
+  // 先依時間，再依位元組上限從最舊的丟起
+  while (!m_ring.isEmpty() &&
+         m_ring.head().timestampMs < newestMs - m_config.preRollMs) {
+    m_ringBytes -= m_ring.dequeue().jpeg.size();
+  }
+  while (m_ring.size() > 1 && m_ringBytes > m_config.maxBufferBytes) {
+    m_ringBytes -= m_ring.dequeue().jpeg.size();
+    m_evicted++;
+  }
+}
+
+void EventRecorder::sendToWriter(const RecordedFrame &frame) {
+  if (m_writer->pendingBytes.load() + frame.jpeg.size() >
+      m_config.maxPendingBytes) {
+    m_dropped++;
+    m_clipDropped++;
+    return;
+  }
+  m_writer->pendingBytes += frame.jpeg.size();
+  ClipWriter *writer = m_writer;
+  QTimer::singleShot(0, writer, [writer, frame]() { writer->append(frame); });
+}
+
+void EventRecorder::trigger(const QString &reason) {
+  const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+  if (m_recording) {
+    // 錄影中再次觸發：延長結束時間，但不超過片段上限
+    qint64 end = qMin(now + m_config.postRollMs,
+                      m_clipStartMs + m_config.maxClipMs);
+    m_finishTimer->start(int(qMax<qint64>(0, end - now)));
+    return;
+  }
+
+  // 與快照相同精確到毫秒；同一毫秒內的片段再加序號，不會互相覆寫
+  QString stamp = QDateTime::fromMSecsSinceEpoch(now).toString(
+      "yyyyMMdd_HHmmss_zzz");
+  m_stampSeq = stamp == m_lastClipStamp ? m_stampSeq + 1 : 0;
+  m_lastClipStamp = stamp;
+  if (m_stampSeq)
+    stamp += QString("_%1").arg(m_stampSeq);
+  QString path = QDir(m_config.clipDir)
+                     .filePath(QString("%1_%2.avi").arg(stamp).arg(reason));
+
+  // 預錄影格只複製 QByteArray 的參照
+  QVector<RecordedFrame> preRoll;
+  preRoll.reserve(m_ring.size());
+  qint64 bytes = 0;
+  for (const RecordedFrame &frame : m_ring) {
+    preRoll.append(frame);
+    bytes += frame.jpeg.size();
+  }
+  m_writer->pendingBytes += bytes;
+
+  m_recording = true;
+  m_clipStartMs = preRoll.isEmpty() ? now : preRoll.first().timestampMs;
+  m_clipDropped = 0;
+  m_finishTimer->start(int(m_config.postRollMs));
+
+  qDebug() << "EventRecorder: 開始錄影" << path << "預錄" << preRoll.size()
+           << "幀";
+  ClipWriter *writer = m_writer;
+  QTimer::singleShot(0, writer, [writer, path, reason, preRoll]() {
+    writer->begin(path, reason, preRoll);
+  });
+}
+
+void EventRecorder::finishClip() {
+  if (!m_recording)
+    return;
+  m_recording = false;
+  m_finishTimer->stop();
+  m_clipsWritten++;
+
+  ClipWriter *writer = m_writer;
+  const quint64 dropped = m_clipDropped;
+  QTimer::singleShot(0, writer, [writer, dropped]() { writer->finish(dropped); });
+}
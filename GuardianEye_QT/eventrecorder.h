@@ -0,0 +1,113 @@
+#ifndef EVENTRECORDER_H
+#define EVENTRECORDER_H
+
+#include "mjpegaviwriter.h"
+#include <QByteArray>
+#include <QObject>
+#include <QQueue>
+#include <QThread>
+#include <atomic>
+
+class QTimer;
+
+struct RecordedFrame {
+  QByteArray jpeg; // 與 AI 後端共享的資料，不複製
+  quint64 seq = 0;
+  qint64 timestampMs = 0;
+};
+
+struct RecorderStats {
+  int bufferedFrames = 0;
+  qint64 bufferedBytes = 0;
+  qint64 pendingBytes = 0;  // 已交給寫檔執行緒但尚未寫入
+  quint64 evicted = 0;      // 因記憶體上限被提早丟棄的預錄影格
+  quint64 dropped = 0;      // 寫檔積壓超過上限而未寫入的影格
+  quint64 clipsWritten = 0;
+};
+
+/**
+ * ClipWriter
+ * 在背景執行緒把影格寫成 MJPEG AVI 並追加到 index.jsonl，
+ * 擷取/GUI 執行緒只負責把 QByteArray 交過來
+ */
+class ClipWriter : public QObject {
+  Q_OBJECT
+public:
+  explicit ClipWriter(QObject *parent = nullptr) : QObject(parent) {}
+
+  void begin(const QString &path, const QString &reason,
+             const QVector<RecordedFrame> &preRoll);
+  void append(const RecordedFrame &frame);
+  void finish(quint64 dropped);
+
+  std::atomic<qint64> pendingBytes{0};
+
+signals:
+  void clipFinished(const QString &path, int frames, qint64 bytes);
+
+private:
+  MjpegAviWriter m_avi;
+  QString m_path;
+  QString m_reason;
+  qint64 m_firstMs = 0;
+  qint64 m_lastMs = 0;
+
+  void write(const RecordedFrame &frame);
+};
+
+/**
+ * EventRecorder
+ * 以位元組與秒數雙重上限的環形緩衝保存最近的 JPEG 影格 (預錄)，
+ * 警報觸發時把預錄加上之後 postRoll 秒的影格交給 ClipWriter 存成片段；
+ * 觸發期間再次觸發會延長錄影，但總長不超過 maxClipMs
+ */
+class EventRecorder : public QObject {
+  Q_OBJECT
+public:
+  struct Config {
+    qint64 preRollMs = 10000;
+    qint64 postRollMs = 10000;
+    qint64 maxClipMs = 60000;
+    qint64 maxBufferBytes = 16 * 1024 * 1024;  // 預錄環形緩衝上限
+    qint64 maxPendingBytes = 32 * 1024 * 1024; // 寫檔積壓上限
+    QString clipDir = "/tmp/guardian_images/clips";
+  };
+
+  explicit EventRecorder(QObject *parent = nullptr);
+  EventRecorder(const Config &config, QObject *parent = nullptr);
+  ~EventRecorder();
+
+  RecorderStats stats() const;
+  bool isRecording() const { return m_recording; }
+
+public slots:
+  void addFrame(const QByteArray &jpeg, quint64 seq, qint64 timestampMs);
+  void trigger(const QString &reason);
+  void finishClip();
+
+signals:
+  void clipFinished(const QString &path, int frames, qint64 bytes);
+
+private:
+  Config m_config;
+  QQueue<RecordedFrame> m_ring;
+  qint64 m_ringBytes = 0;
+  quint64 m_evicted = 0;
+  quint64 m_dropped = 0;
+  quint64 m_clipsWritten = 0;
+
+  bool m_recording = false;
+  qint64 m_clipStartMs = 0;
+  quint64 m_clipDropped = 0;
+  QString m_lastClipStamp; // 上一個片段的時間戳，同一毫秒時加上序號
+  int m_stampSeq = 0;
+  QTimer *m_finishTimer;
+
+  QThread *m_thread;
+  ClipWriter *m_writer;
+
+  void trimRing(qint64 newestMs);
+  void sendToWriter(const RecordedFrame &frame);
+};
+
+#endif // EVENTRECORDER_H
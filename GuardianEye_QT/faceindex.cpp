@@ -0,0 +1,485 @@
+#include "faceindex.h"
+#include <QDebug>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPair>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <sys/file.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+static const char FACE_INDEX_MAGIC[4] = {'G', 'E', 'F', 'I'};
+static const quint32 FACE_INDEX_VERSION = 1;
+static const int INITIAL_CAPACITY = 64;
+static_assert(sizeof(FaceIndex::Header) == 64, "FaceIndex header must be 64 bytes");
+
+// --- 距離與格式轉換核心 ---
+
+static float halfToFloat(quint16 h) {
+  quint32 sign = (h & 0x8000u) << 16;
+  quint32 exp = (h >> 10) & 0x1f;
+  quint32 mant = h & 0x3ff;
+  quint32 bits;
+  if (exp == 0) {
+    if (mant == 0) {
+      bits = sign;
+    } else {
+      // 次正規數：正規化後再轉換
+      exp = 127 - 15 + 1;
+      while (!(mant & 0x400)) {
+        mant <<= 1;
+        exp--;
+      }
+      bits = sign | (exp << 23) | ((mant & 0x3ff) << 13);
+    }
+  } else if (exp == 0x1f) {
+    bits = sign | 0x7f800000u | (mant << 13);
+  } else {
+    bits = sign | ((exp + 127 - 15) << 23) | (mant << 13);
+  }
+  float f;
+  memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+static quint16 floatToHalf(float f) {
+  quint32 bits;
+  memcpy(&bits, &f, sizeof(bits));
+  quint32 sign = (bits >> 16) & 0x8000u;
+  int exp = int((bits >> 23) & 0xff) - 127 + 15;
+  quint32 mant = bits & 0x7fffff;
+  if (exp <= 0)
+    return quint16(sign); // 特徵值不會小到需要次正規數，直接歸零
+  if (exp >= 0x1f)
+    return quint16(sign | 0x7c00);
+  // 四捨五入到最近
+  quint32 h = sign | (quint32(exp) << 10) | (mant >> 13);
+  if (mant & 0x1000)
+    h++;
+  return quint16(h);
+}
+
+static void halfToFloatN(const quint16 *src, float *dst, int n) {
+  int i = 0;
+#if defined(__AVX2__) && defined(__F16C__)
+  for (; i + 8 <= n; i += 8) {
+    __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+  }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  for (; i + 4 <= n; i += 4) {
+    float16x4_t h = vreinterpret_f16_u16(vld1_u16(src + i));
+    vst1q_f32(dst + i, vcvt_f32_f16(h));
+  }
+#endif
+  for (; i < n; i++)
+    dst[i] = halfToFloat(src[i]);
+}
+
+// 平方 L2 距離；DIM 為 128，恰為各 SIMD 寬度的整數倍
+static float l2Squared(const float *a, const float *b) {
+#if defined(__AVX2__)
+  __m256 acc0 = _mm256_setzero_ps();
+  __m256 acc1 = _mm256_setzero_ps();
+  for (int i = 0; i < FaceIndex::DIM; i += 16) {
+    __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+    __m256 d1 =
+        _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8));
+#if defined(__FMA__)
+    acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+    acc1 = _mm256_fmadd_ps(d1, d1, acc1);
+#else
+    acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(d0, d0));
+    acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(d1, d1));
+#endif
+  }
+  __m256 acc = _mm256_add_ps(acc0, acc1);
+  __m128 s = _mm_add_ps(_mm256_castps256_ps128(acc),
+                        _mm256_extractf128_ps(acc, 1));
+  s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+  s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+  return _mm_cvtss_f32(s);
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  float32x4_t acc0 = vdupq_n_f32(0);
+  float32x4_t acc1 = vdupq_n_f32(0);
+  for (int i = 0; i < FaceIndex::DIM; i += 8) {
+    float32x4_t d0 = vsubq_f32(vld1q_f32(a + i), vld1q_f32(b + i));
+    float32x4_t d1 = vsubq_f32(vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    acc0 = vfmaq_f32(acc0, d0, d0);
+    acc1 = vfmaq_f32(acc1, d1, d1);
+  }
+  return vaddvq_f32(vaddq_f32(acc0, acc1));
+#else
+  float acc = 0;
+  for (int i = 0; i < FaceIndex::DIM; i++) {
+    float d = a[i] - b[i];
+    acc += d * d;
+  }
+  return acc;
+#endif
+}
+
+// 維持長度 <= k 的遞增結果列表
+static void insertTopK(QVector<FaceMatch> &top, int k, int id, float dist) {
+  if (top.size() == k && dist >= top.last().distance)
+    return;
+  FaceMatch m;
+  m.id = id;
+  m.distance = dist;
+  auto pos = std::upper_bound(
+      top.begin(), top.end(), dist,
+      [](float d, const FaceMatch &x) { return d < x.distance; });
+  top.insert(pos, m);
+  if (top.size() > k)
+    top.removeLast();
+}
+
+// 與 face_index.py 互斥的檔案鎖 (flock)：註冊時「讀 count -> 寫紀錄 ->
+// 更新 count/capacity」整段持有，兩個行程不會寫到同一筆或各自擴充檔案
+namespace {
+class FileLock {
+public:
+  explicit FileLock(int fd) : m_fd(fd) {
+    while (flock(m_fd, LOCK_EX) != 0 && errno == EINTR) {
+    }
+  }
+  ~FileLock() { flock(m_fd, LOCK_UN); }
+
+private:
+  int m_fd;
+};
+} // namespace
+
+// --- FaceIndex ---
+
+FaceIndex::FaceIndex() {}
+
+FaceIndex::~FaceIndex() { close(); }
+
+bool FaceIndex::open(const QString &path, bool create, DType dtype) {
+  close();
+  m_file.setFileName(path);
+
+  if (!m_file.exists()) {
+    if (!create) {
+      qDebug() << "FaceIndex: 找不到索引檔" << path;
+      return false;
+    }
+    if (!m_file.open(QIODevice::ReadWrite))
+      return false;
+
+    Header h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, FACE_INDEX_MAGIC, 4);
+    h.version = FACE_INDEX_VERSION;
+    h.dim = DIM;
+    h.dtype = dtype;
+    h.count = 0;
+    h.capacity = INITIAL_CAPACITY;
+    h.labelBytes = LABEL_BYTES;
+    h.recordBytes =
+        LABEL_BYTES + DIM * (dtype == Float16 ? sizeof(quint16) : sizeof(float));
+    m_file.write(reinterpret_cast<const char *>(&h), sizeof(h));
+    m_file.resize(sizeof(Header) + qint64(h.capacity) * h.recordBytes);
+  } else if (!m_file.open(QIODevice::ReadWrite)) {
+    qDebug() << "FaceIndex: 無法開啟" << path << m_file.errorString();
+    return false;
+  }
+
+  if (!remap()) {
+    close();
+    return false;
+  }
+
+  const Header *h = m_header;
+  if (memcmp(h->magic, FACE_INDEX_MAGIC, 4) != 0 ||
+      h->version != FACE_INDEX_VERSION || h->dim != quint32(DIM) ||
+      h->labelBytes != quint32(LABEL_BYTES) || h->dtype > Float16) {
+    qDebug() << "FaceIndex: 索引檔格式不符" << path;
+    close();
+    return false;
+  }
+
+  qDebug() << "FaceIndex: 已載入" << h->count << "筆身分"
+           << (h->dtype == Float16 ? "(float16)" : "(float32)");
+  return true;
+}
+
+void FaceIndex::close() {
+  if (m_map)
+    m_file.unmap(m_map);
+  m_map = nullptr;
+  m_mapSize = 0;
+  m_header = nullptr;
+  m_centroids.clear();
+  m_lists.clear();
+  if (m_file.isOpen())
+    m_file.close();
+}
+
+bool FaceIndex::remap() {
+  if (m_map)
+    m_file.unmap(m_map);
+  m_mapSize = m_file.size();
+  m_map = m_mapSize >= qint64(sizeof(Header)) ? m_file.map(0, m_mapSize)
+                                              : nullptr;
+  m_header = reinterpret_cast<Header *>(m_map);
+  if (!m_map) {
+    qDebug() << "FaceIndex: mmap 失敗" << m_file.errorString();
+    return false;
+  }
+  return true;
+}
+
+bool FaceIndex::refresh() {
+  if (!m_header)
+    return false;
+  // 檔案被其他行程擴充時需重新映射才看得到新的紀錄
+  if (m_file.size() != m_mapSize && !remap())
+    return false;
+
+  // 已有分群時，把新註冊的身分補進最近的群
+  int indexed = 0;
+  for (const QVector<int> &list : m_lists)
+    indexed += list.size();
+  for (int id = indexed; !m_lists.isEmpty() && id < count(); id++)
+    m_lists[nearestCentroid(vectorsAsFloat(nullptr, 1, id))].append(id);
+  return true;
+}
+
+bool FaceIndex::grow() {
+  const qint64 capacity = qint64(m_header->capacity) * 2;
+  const qint64 size = sizeof(Header) + capacity * m_header->recordBytes;
+  m_file.unmap(m_map);
+  m_map = nullptr;
+  m_header = nullptr;
+  if (!m_file.resize(size) || !remap())
+    return false;
+  m_header->capacity = quint32(capacity);
+  return true;
+}
+
+const uchar *FaceIndex::record(int id) const {
+  return m_map + sizeof(Header) + qint64(id) * m_header->recordBytes;
+}
+
+QSet<QString> FaceIndex::ownerLabels(const QString &indexPath) {
+  const QFileInfo info(indexPath);
+  QFile roles(info.dir().filePath(info.completeBaseName() + ".roles.json"));
+  if (!roles.open(QIODevice::ReadOnly))
+    return {"OWNER"};
+  QSet<QString> owners;
+  const QJsonArray list =
+      QJsonDocument::fromJson(roles.readAll()).object()["owners"].toArray();
+  for (const QJsonValue &v : list)
+    owners.insert(v.toString());
+  return owners;
+}
+
+QString FaceIndex::label(int id) const {
+  if (!m_header || id < 0 || id >= count())
+    return QString();
+  const char *p = reinterpret_cast<const char *>(record(id));
+  return QString::fromUtf8(p, int(strnlen(p, LABEL_BYTES)));
+}
+
+int FaceIndex::enroll(const QString &label, const float *vector) {
+  if (!m_header)
+    return -1;
+  FileLock lock(m_file.handle());
+  // header 是共享的：其他行程擴充檔案後 capacity 已變大，但本行程的映射
+  // 還是舊的大小，必須先重新映射才能寫入新的位置
+  if (!refresh())
+    return -1;
+  if (m_header->count >= m_header->capacity && !grow())
+    return -1;
+
+  const int id = int(m_header->count);
+  uchar *rec = m_map + sizeof(Header) + qint64(id) * m_header->recordBytes;
+
+  QByteArray utf8 = label.toUtf8().left(LABEL_BYTES - 1);
+  memset(rec, 0, LABEL_BYTES);
+  memcpy(rec, utf8.constData(), size_t(utf8.size()));
+
+  if (m_header->dtype == Float16) {
+    quint16 *dst = reinterpret_cast<quint16 *>(rec + LABEL_BYTES);
+    for (int i = 0; i < DIM; i++)
+      dst[i] = floatToHalf(vector[i]);
+  } else {
+    memcpy(rec + LABEL_BYTES, vector, DIM * sizeof(float));
+  }
+
+  // 紀錄內容先落地，再讓 count 對讀取端可見
+  std::atomic_thread_fence(std::memory_order_release);
+  m_header->count = quint32(id + 1);
+
+  if (!m_lists.isEmpty())
+    m_lists[nearestCentroid(vector)].append(id);
+  return id;
+}
+
+// 取得 ids (或 first 起連續 n 筆) 的 float 向量；float32 且連續時直接指向映射區
+const float *FaceIndex::vectorsAsFloat(const int *ids, int n,
+                                       int first) const {
+  const bool half = m_header->dtype == Float16;
+  if (!half && !ids && n == 1)
+    return reinterpret_cast<const float *>(record(first) + LABEL_BYTES);
+
+  if (m_scratch.size() < n * DIM)
+    m_scratch.resize(n * DIM);
+  float *dst = m_scratch.data();
+  for (int i = 0; i < n; i++) {
+    const uchar *src = record(ids ? ids[i] : first + i) + LABEL_BYTES;
+    if (half)
+      halfToFloatN(reinterpret_cast<const quint16 *>(src), dst + i * DIM, DIM);
+    else
+      memcpy(dst + i * DIM, src, DIM * sizeof(float));
+  }
+  return dst;
+}
+
+void FaceIndex::scan(const float *queries, int nq, const int *ids, int n,
+                     int first, int k,
+                     QVector<QVector<FaceMatch>> &results) const {
+  const bool direct = m_header->dtype == Float32 && !ids;
+  for (int base = 0; base < n; base += BLOCK) {
+    const int len = qMin(BLOCK, n - base);
+    // 同一區塊只轉換一次，給所有 query 共用
+    const float *block =
+        direct ? nullptr
+               : vectorsAsFloat(ids ? ids + base : nullptr, len, first + base);
+    for (int j = 0; j < len; j++) {
+      const float *v =
+          direct ? reinterpret_cast<const float *>(record(first + base + j) +
+                                                   LABEL_BYTES)
+                 : block + j * DIM;
+      const int id = ids ? ids[base + j] : first + base + j;
+      for (int q = 0; q < nq; q++)
+        insertTopK(results[q], k, id, l2Squared(queries + q * DIM, v));
+    }
+  }
+}
+
+QVector<FaceMatch> FaceIndex::search(const float *query, int k,
+                                     float maxDistance) const {
+  return searchBatch(query, 1, k, maxDistance).value(0);
+}
+
+QVector<QVector<FaceMatch>> FaceIndex::searchBatch(const float *queries,
+                                                   int nq, int k,
+                                                   float maxDistance) const {
+  QVector<QVector<FaceMatch>> results(nq);
+  if (!m_header || nq <= 0 || k <= 0)
+    return results;
+  // 其他行程擴充檔案後、refresh() 之前，只搜尋目前映射範圍內的紀錄
+  const int n = qMin(count(), int((m_mapSize - qint64(sizeof(Header))) /
+                                  m_header->recordBytes));
+  if (n <= 0)
+    return results;
+
+  if (m_lists.isEmpty()) {
+    scan(queries, nq, nullptr, n, 0, k, results);
+  } else {
+    // 每個 query 只掃最近的 nprobe 個群
+    const int nlist = clusterCount();
+    const int probe = qMin(m_nprobe, nlist);
+    for (int q = 0; q < nq; q++) {
+      const float *query = queries + q * DIM;
+      QVector<QPair<float, int>> order(nlist);
+      for (int c = 0; c < nlist; c++)
+        order[c] = qMakePair(l2Squared(query, m_centroids.constData() + c * DIM),
+                             c);
+      std::partial_sort(order.begin(), order.begin() + probe, order.end());
+
+      QVector<QVector<FaceMatch>> one(1);
+      for (int p = 0; p < probe; p++) {
+        const QVector<int> &list = m_lists[order[p].second];
+        scan(query, 1, list.constData(), list.size(), 0, k, one);
+      }
+      results[q] = one[0];
+    }
+  }
+
+  const float maxSq = maxDistance * maxDistance;
+  for (QVector<FaceMatch> &top : results) {
+    for (int i = 0; i < top.size(); i++) {
+      if (maxDistance > 0 && top[i].distance >= maxSq) {
+        top.resize(i);
+        break;
+      }
+      top[i].distance = std::sqrt(top[i].distance);
+      top[i].label = label(top[i].id);
+    }
+  }
+  return results;
+}
+
+int FaceIndex::nearestCentroid(const float *vector) const {
+  int best = 0;
+  float bestDist = INFINITY;
+  for (int c = 0; c < clusterCount(); c++) {
+    float d = l2Squared(vector, m_centroids.constData() + c * DIM);
+    if (d < bestDist) {
+      bestDist = d;
+      best = c;
+    }
+  }
+  return best;
+}
+
+void FaceIndex::buildClusters(int nlist, int iterations) {
+  m_centroids.clear();
+  m_lists.clear();
+  const int n = count();
+  if (nlist <= 0 || n < nlist * 4)
+    return; // 身分太少時全表掃描反而較快
+
+  // 以隨機抽樣的向量作為初始中心
+  std::mt19937 rng(12345);
+  QVector<int> seeds(n);
+  for (int i = 0; i < n; i++)
+    seeds[i] = i;
+  std::shuffle(seeds.begin(), seeds.end(), rng);
+  m_centroids.resize(nlist * DIM);
+  for (int c = 0; c < nlist; c++)
+    memcpy(m_centroids.data() + c * DIM, vectorsAsFloat(nullptr, 1, seeds[c]),
+           DIM * sizeof(float));
+
+  QVector<int> assign(n, 0);
+  QVector<double> sums(nlist * DIM);
+  QVector<int> sizes(nlist);
+  for (int it = 0; it < iterations; it++) {
+    sums.fill(0);
+    sizes.fill(0);
+    for (int i = 0; i < n; i++) {
+      const float *v = vectorsAsFloat(nullptr, 1, i);
+      const int c = nearestCentroid(v);
+      assign[i] = c;
+      sizes[c]++;
+      for (int d = 0; d < DIM; d++)
+        sums[c * DIM + d] += v[d];
+    }
+    for (int c = 0; c < nlist; c++) {
+      if (sizes[c] == 0)
+        continue; // 空群保留原中心
+      for (int d = 0; d < DIM; d++)
+        m_centroids[c * DIM + d] = float(sums[c * DIM + d] / sizes[c]);
+    }
+  }
+
+  m_lists.resize(nlist);
+  for (int i = 0; i < n; i++)
+    m_lists[assign[i]].append(i);
+  qDebug() << "FaceIndex: 建立" << nlist << "個粗分群，nprobe =" << m_nprobe;
+}
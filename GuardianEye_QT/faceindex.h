@@ -0,0 +1,107 @@
+#ifndef FACEINDEX_H
+#define FACEINDEX_H
+
+#include <QFile>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+// 單筆比對結果；distance 為歐氏距離，與 face_recognition.face_distance 相同尺度
+struct FaceMatch {
+  int id = -1;
+  QString label;
+  float distance = 0;
+};
+
+/**
+ * FaceIndex
+ * 取代 owner_face.pkl 的人臉特徵索引：以記憶體映射的二進位檔存放
+ * float32/float16 的 128 維向量與標籤，支援 AVX2/NEON 批次 L2 搜尋、
+ * 大量身分時的粗分群 (k-means + nprobe) 以及免重寫檔案的增量註冊
+ *
+ * 檔案格式 (little-endian)，face_index.py 以相同格式讀寫：
+ *   [0, 64)    Header
+ *   [64, ...)  capacity 筆 Record，每筆 = label[32] (UTF-8, 以 0 補齊) + 向量
+ * count 於整筆資料寫入後才更新，其他行程讀到的 count 內資料皆完整
+ */
+class FaceIndex {
+public:
+  enum DType { Float32 = 0, Float16 = 1 };
+
+  static const int DIM = 128;
+  static const int LABEL_BYTES = 32;
+
+  struct Header {
+    char magic[4]; // "GEFI"
+    quint32 version;
+    quint32 dim;
+    quint32 dtype;
+    quint32 count;
+    quint32 capacity;
+    quint32 labelBytes;
+    quint32 recordBytes;
+    quint8 reserved[32];
+  };
+
+  FaceIndex();
+  ~FaceIndex();
+
+  // 開啟既有索引；create = true 時若不存在則以 dtype 建立新檔
+  bool open(const QString &path, bool create = false,
+            DType dtype = Float32);
+  void close();
+  bool isOpen() const { return m_header != nullptr; }
+
+  // 重新讀取 header，偵測其他行程 (例如 vision worker) 新增的身分
+  bool refresh();
+
+  // 標籤角色 (<index>.roles.json 的 owners)，與 face_index.py 的
+  // load_owner_labels 相同：沒有此檔時只有 OWNER 標籤算主人
+  static QSet<QString> ownerLabels(const QString &indexPath);
+
+  int count() const { return m_header ? int(m_header->count) : 0; }
+  DType dtype() const { return m_header ? DType(m_header->dtype) : Float32; }
+  QString label(int id) const;
+
+  // 增量註冊：寫入一筆並回傳 id，空間不足時將檔案容量加倍後重新映射
+  int enroll(const QString &label, const float *vector);
+
+  // 查詢單一向量的前 k 名；maxDistance > 0 時只回傳距離小於此值的結果
+  QVector<FaceMatch> search(const float *query, int k = 1,
+                            float maxDistance = 0) const;
+  // 批次查詢：以區塊掃描，每個區塊對所有 query 計算後才前進，提高快取命中
+  QVector<QVector<FaceMatch>> searchBatch(const float *queries, int nq,
+                                          int k = 1,
+                                          float maxDistance = 0) const;
+
+  // 粗分群：nlist = 0 表示全表掃描；查詢時只掃最近的 nprobe 個群
+  void buildClusters(int nlist, int iterations = 10);
+  void setProbe(int nprobe) { m_nprobe = qMax(1, nprobe); }
+  int clusterCount() const { return m_centroids.size() / DIM; }
+
+private:
+  QFile m_file;
+  uchar *m_map = nullptr;
+  qint64 m_mapSize = 0;
+  Header *m_header = nullptr;
+
+  // 粗分群 (僅存在記憶體中，開啟時依需要重建)
+  QVector<float> m_centroids;
+  QVector<QVector<int>> m_lists;
+  int m_nprobe = 4;
+
+  // float16 轉換與批次查詢的暫存區，避免每次查詢配置
+  mutable QVector<float> m_scratch;
+
+  static const int BLOCK = 256;
+
+  bool remap();
+  bool grow();
+  const uchar *record(int id) const;
+  const float *vectorsAsFloat(const int *ids, int n, int first) const;
+  int nearestCentroid(const float *vector) const;
+  void scan(const float *queries, int nq, const int *ids, int n, int first,
+            int k, QVector<QVector<FaceMatch>> &results) const;
+};
+
+#endif // FACEINDEX_H
@@ -0,0 +1,100 @@
+#include "gpiomanager.h"
+#include "alarmactuator.h"
+#include "blackboxinterface.h"
+#include "hardwareinterface.h"
+#include <QTimer>
+
+GpioManager::GpioManager(BlackboxInterface *blackbox, QObject *parent)
+    : QObject(parent), m_blackbox(blackbox), m_flushTimer(new QTimer(this)) {
+  // 0ms 單次計時器：在目前這輪事件處理完後才送出
+  m_flushTimer->setSingleShot(true);
+  m_flushTimer->setInterval(0);
+  connect(m_flushTimer, &QTimer::timeout, this, &GpioManager::flush);
+
+  connect(m_blackbox, &BlackboxInterface::emergencyStateChanged, this,
+          &GpioManager::handleEmergencyStateChanged);
+}
+
+bool GpioManager::isRedundant(int pin, int value) const {
+  if (m_volatile.contains(pin))
+    return false;
+  // 警報腳位可能由邏輯執行緒直接送給 actuator，以 actuator 的紀錄為準
+  if (m_actuator && AlarmActuator::ownsPin(pin))
+    return m_actuator->knownValue(pin) == value;
+  auto it = m_state.constFind(pin);
+  return it != m_state.constEnd() && it.value() == value;
+}
+
+void GpioManager::setGpio(int pin, int value) {
+  m_stats.requested++;
+
+  // 若本輪已有同腳位的寫入，以最後一次為準
+  if (!m_pending.contains(pin) && isRedundant(pin, value)) {
+    m_stats.suppressed++;
+    return;
+  }
+  m_pending.insert(pin, value);
+  if (!m_flushTimer->isActive())
+    m_flushTimer->start();
+}
+
+void GpioManager::setGpioUrgent(int pin, int value) {
+  m_stats.requested++;
+
+  // 警報路徑不等待合併：連同已排隊的寫入立即送出
+  if (m_actuator && AlarmActuator::ownsPin(pin)) {
+    m_pending.remove(pin);
+    m_actuator->submit(pin, value);
+    m_stats.issued++;
+  } else {
+    m_pending.insert(pin, value);
+  }
+  flush();
+}
+
+void GpioManager::invalidate(int pin) { m_state.remove(pin); }
+
+void GpioManager::flush() {
+  m_flushTimer->stop();
+  if (m_pending.isEmpty())
+    return;
+
+  QVector<QPair<int, int>> writes;
+  writes.reserve(m_pending.size());
+  for (auto it = m_pending.constBegin(); it != m_pending.constEnd(); ++it) {
+    if (isRedundant(it.key(), it.value())) {
+      m_stats.suppressed++; // 例如同一輪內 1 -> 0 回到原狀態
+      continue;
+    }
+    if (m_actuator && AlarmActuator::ownsPin(it.key())) {
+      m_actuator->submit(it.key(), it.value());
+      m_stats.issued++;
+      continue;
+    }
+    writes.append(qMakePair(it.key(), it.value()));
+    m_state.insert(it.key(), it.value());
+  }
+  m_pending.clear();
+
+  if (writes.isEmpty())
+    return;
+  m_blackbox->setGpioBatch(writes);
+  m_stats.issued += writes.size();
+  m_stats.batches++;
+}
+
+void GpioManager::handleEmergencyStateChanged(bool active) {
+  const int driverPins[] = {LED_RED, BUZZER, EXPLOSION_TRIGGER};
+  for (int pin : driverPins) {
+    // 倒數期間驅動會閃爍 LED_RED；停止時則全部拉低
+    if (active) {
+      m_volatile.insert(pin);
+      m_state.remove(pin);
+    } else {
+      m_volatile.remove(pin);
+      m_state.insert(pin, 0);
+      if (m_actuator)
+        m_actuator->setKnownValue(pin, 0);
+    }
+  }
+}
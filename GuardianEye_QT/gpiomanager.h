@@ -0,0 +1,58 @@
+#ifndef GPIOMANAGER_H
+#define GPIOMANAGER_H
+
+#include <QHash>
+#include <QMap>
+#include <QObject>
+#include <QSet>
+
+class AlarmActuator;
+class BlackboxInterface;
+class QTimer;
+
+struct GpioStats {
+  quint64 requested = 0;  // 呼叫 setGpio/setGpioUrgent 的次數
+  quint64 issued = 0;     // 真正送到驅動的腳位寫入數
+  quint64 suppressed = 0; // 與目前狀態相同而被略過的寫入
+  quint64 batches = 0;    // 送出的 ioctl 批次數
+};
+
+/**
+ * GpioManager
+ * 介於控制器與 BlackboxInterface::setGpio 之間：
+ * 記錄每支腳位最後寫入的狀態以略過重複寫入，並將同一輪事件迴圈內的
+ * 所有寫入合併為一次批次 ioctl；警報路徑可用 setGpioUrgent 立即送出，
+ * 警報腳位則交給 AlarmActuator 以免受 GUI 執行緒延遲影響
+ */
+class GpioManager : public QObject {
+  Q_OBJECT
+public:
+  explicit GpioManager(BlackboxInterface *blackbox, QObject *parent = nullptr);
+
+  GpioStats stats() const { return m_stats; }
+
+  // 設定後，警報腳位 (AlarmActuator::ownsPin) 一律交由高優先權執行緒寫入
+  void setActuator(AlarmActuator *actuator) { m_actuator = actuator; }
+
+public slots:
+  void setGpio(int pin, int value);
+  void setGpioUrgent(int pin, int value);
+  void invalidate(int pin);
+  void flush();
+
+private slots:
+  void handleEmergencyStateChanged(bool active);
+
+private:
+  BlackboxInterface *m_blackbox;
+  AlarmActuator *m_actuator = nullptr;
+  QTimer *m_flushTimer;
+  QHash<int, int> m_state;  // 最後一次送出的值
+  QMap<int, int> m_pending; // 本輪尚未送出的寫入 (同腳位後者覆蓋前者)
+  QSet<int> m_volatile;     // 驅動可能自行改變的腳位，不做快取
+  GpioStats m_stats;
+
+  bool isRedundant(int pin, int value) const;
+};
+
+#endif // GPIOMANAGER_H
@@ -0,0 +1,784 @@
+#include "guardiancore.h"
+#include "alarmactuator.h"
+#include "alarmstatemachine.h"
+#include "blackboxinterface.h"
+#include "emergencycontroller.h"
+#include "environmentalcontroller.h"
+#include "eventrecorder.h"
+#include "faceindex.h"
+#include "gpiomanager.h"
+#include "hardwareinterface.h"
+#include "httpserver.h"
+#include "inferencebackend.h"
+#include "metrics.h"
+#include "mjpegstreamer.h"
+#include "pythonaimanager.h"
+#include "securitycontroller.h"
+#include "snapshotservice.h"
+#include "sensoracquisition.h"
+#include "statushub.h"
+#include "timerwheel.h"
+#include "tracing.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QJsonDocument>
+#include <QMetaEnum>
+#include <QTextStream>
+#include <QTimer>
+#include <cstdio>
+#include <unistd.h>
+
+GuardianCore::GuardianCore(QObject *parent) : QObject(parent) {
+  // 0. 主執行緒上所有裝置/控制器期限共用的時間輪
+  // (GUARDIAN_TIMER_COALESCE=0 關閉喚醒合併，用來比較閒置時的每秒喚醒次數)
+  TimerWheel::Config timerConfig;
+  timerConfig.coalesce = qgetenv("GUARDIAN_TIMER_COALESCE") != "0";
+  timers = new TimerWheel(timerConfig, this);
+
+  // 1. 初始化底層硬體介面 (直接由主執行緒或邏輯執行緒管理)
+  blackbox = new BlackboxInterface(this);
+  gpio = new GpioManager(blackbox, this);
+  sensors = new SensorAcquisition(); // 會被移到擷取執行緒，不要設 parent
+  sensorDispatcher = new SensorDispatcher(sensors, timers, this);
+
+  // 警報關鍵 GPIO 由高優先權執行緒直接寫入，不經過主執行緒
+  // (設定 GUARDIAN_RT=1 啟用 SCHED_FIFO 與 mlockall，需要對應權限)
+  actuator = new AlarmActuator(this);
+  if (qgetenv("GUARDIAN_RT") == "1") {
+    AlarmActuator::lockMemory();
+    actuator->setRealtime(true);
+  }
+  actuator->start();
+  gpio->setActuator(actuator);
+
+  // 2. 初始化業務邏輯控制器
+  // AI 後端 (worker 輸出解析與偵測融合) 會被移到邏輯執行緒，不要設 parent
+  camera = InferenceBackend::create();
+  // 沒有用戶端顯示畫面前不解碼預覽；錄影/快照/即時影像只需要壓縮影格
+  camera->setPreviewEnabled(false);
+  security = new SecurityController(); // 注意：SecurityController
+                                       // 可能會被移到執行緒，不要設 parent
+  env = new EnvironmentalController();           // 同上
+  alarm = new AlarmStateMachine(security);       // 同上，與 security 同執行緒
+  alarm->setActuator(actuator);
+  emergency = new EmergencyController(blackbox, timers); // 依賴 blackbox
+
+  // 3. 執行緒管理
+  logicThread = new QThread(this);
+  sensorThread = new QThread(this);
+
+  security->moveToThread(logicThread);
+  env->moveToThread(logicThread);
+  alarm->moveToThread(logicThread);
+  // 偵測 -> 警報決策全在邏輯執行緒直接呼叫，GUI 卡住也不影響警報
+  camera->moveToThread(logicThread);
+  sensors->moveToThread(sensorThread);
+  // emergency 也可以移到執行緒，但它目前看起來是在主執行緒管理計時器
+
+  // 4. 連線設定 (訊號傳遞)
+
+  // Camera -> 狀態 (從 Python 獲取 AI 結果)
+  connect(camera, &InferenceBackend::statusChanged, this, [this](QString msg) {
+    emit statusMessage(QString("系統載入中: %1").arg(msg));
+  });
+  connect(camera, &InferenceBackend::errorOccurred, this, [this](QString msg) {
+    emit statusMessage(QString("<font color='red'>錯誤: %1</font>").arg(msg));
+    emit notice(false, "AI 系統錯誤", msg);
+  });
+  connect(camera, &InferenceBackend::detectionStateChanged, alarm,
+          &AlarmStateMachine::handleDetection);
+
+  // Camera -> 預錄：直接沿用 worker 已壓縮好的 JPEG，
+  // 預覽關閉時仍以最低 5 fps 取得影格
+  recorder = new EventRecorder(this);
+  connect(camera, &InferenceBackend::compressedFrameReady, recorder,
+          &EventRecorder::addFrame);
+  camera->setMinimumFrameRate(5);
+
+  // Camera -> 快照：記住觸發影格，警報時於背景執行緒裁切輸出後再推播
+  snapshots = new SnapshotService(this);
+  connect(camera, &InferenceBackend::compressedFrameReady, snapshots,
+          &SnapshotService::addFrame);
+  connect(camera, &InferenceBackend::detectionStateChanged, snapshots,
+          &SnapshotService::noteDetection);
+  connect(snapshots, &SnapshotService::snapshotReady, this,
+          [this](const QString &type, const QString &fullPath,
+                 const QString &thumbPath, bool duplicate) {
+            // 冷卻時間內的相似快照：上一則推播已涵蓋，不再重複通知
+            if (duplicate) {
+              qDebug() << "快照與上一張相似，略過 Discord 推播" << type;
+              return;
+            }
+            sendDiscordNotification(type, (type == "pig" ? "high" : "normal"),
+                                    fullPath, thumbPath);
+          });
+  connect(snapshots, &SnapshotService::snapshotFailed, this,
+          [this](const QString &type) {
+            // 沒有可用影格時仍照常推播，只是不附圖
+            sendDiscordNotification(type, (type == "pig" ? "high" : "normal"));
+          });
+
+  // 即時影像 HTTP：沿用同一份 JPEG 分送給所有觀看者；
+  // 有人觀看時把最低影格率提高，避免預覽關閉時畫面只剩 5 fps
+  http = new HttpServer(this);
+  liveView = new MjpegStreamer(http);
+  connect(camera, &InferenceBackend::compressedFrameReady, liveView,
+          &MjpegStreamer::publishFrame);
+  connect(liveView, &MjpegStreamer::clientCountChanged, camera,
+          [this](int clients) {
+            camera->setMinimumFrameRate(clients > 0 ? 15 : 5);
+          });
+
+  // 狀態推播 (SSE/長輪詢)：Web 端不必再每秒重讀 guardian_alarm_status.json
+  status = new StatusHub(http);
+  status->update({{"alarm_active", false},
+                  {"alarm_state", "Idle"},
+                  {"muted", false},
+                  {"light_auto", true}});
+
+  // 追蹤：GUARDIAN_TRACE=1 於啟動時開啟，之後可由 HTTP 切換/匯出
+  // (/trace.json?last_ms=N 只取最近 N 毫秒)
+  Tracer::setEnabled(qgetenv("GUARDIAN_TRACE") == "1");
+  http->route("/trace/control", [](QTcpSocket *socket,
+                                   const HttpRequest &request) {
+    if (request.query.hasQueryItem("enabled"))
+      Tracer::setEnabled(request.query.queryItemValue("enabled") == "1");
+    HttpServer::respond(socket, 200, "application/json",
+                        Tracer::isEnabled() ? "{\"enabled\":true}\n"
+                                            : "{\"enabled\":false}\n");
+  });
+  http->route("/trace.json", [](QTcpSocket *socket,
+                                const HttpRequest &request) {
+    const qint64 lastMs =
+        request.query.queryItemValue("last_ms").toLongLong();
+    HttpServer::respond(
+        socket, 200, "application/json",
+        Tracer::chromeJson(lastMs > 0 ? Tracer::nowNs() - lastMs * 1000000LL
+                                      : 0));
+  });
+
+  // 已登錄的人臉身分與角色，與 vision worker 共用同一份 models/faces.idx
+  // (GUARDIAN_FACE_INDEX 可指定其他路徑)；每次請求重新映射，新註冊的身分立即可見
+  QString faceIndexPath = QString::fromLocal8Bit(qgetenv("GUARDIAN_FACE_INDEX"));
+  if (faceIndexPath.isEmpty()) {
+    const QString aiDir = InferenceBackend::locateAiDirectory("vision_system.py");
+    if (!aiDir.isEmpty())
+      faceIndexPath = aiDir + "/models/faces.idx";
+  }
+  http->route("/api/faces", [faceIndexPath](QTcpSocket *socket,
+                                            const HttpRequest &) {
+    FaceIndex index;
+    if (faceIndexPath.isEmpty() || !index.open(faceIndexPath)) {
+      HttpServer::respond(socket, 404, "application/json",
+                          "{\"error\":\"face index not found\"}\n");
+      return;
+    }
+    const QSet<QString> owners = FaceIndex::ownerLabels(faceIndexPath);
+    QJsonArray faces;
+    for (int id = 0; id < index.count(); id++) {
+      const QString label = index.label(id);
+      faces.append(QJsonObject{
+          {"id", id},
+          {"label", label},
+          {"role", owners.contains(label) ? "owner" : "known"}});
+    }
+    HttpServer::respond(
+        socket, 200, "application/json",
+        QJsonDocument(QJsonObject{
+                          {"count", index.count()},
+                          {"dtype", index.dtype() == FaceIndex::Float16
+                                        ? "float16"
+                                        : "float32"},
+                          {"faces", faces}})
+            .toJson(QJsonDocument::Compact));
+  });
+
+  // Prometheus 抓取端點，與其他 HTTP 路由同在伺服器執行緒
+  http->route("/metrics", [](QTcpSocket *socket, const HttpRequest &) {
+    HttpServer::respond(socket, 200, "text/plain; version=0.0.4",
+                        MetricsRegistry::instance().prometheusText());
+  });
+
+  // Alarm Logic -> Hardware/UI (狀態機只做決策，動作在此執行)
+  connect(alarm, &AlarmStateMachine::alarmRaised, this,
+          &GuardianCore::handleAlarm);
+  connect(alarm, &AlarmStateMachine::ownerArrived, this, [this]() {
+    // 主人驗證成功邏輯
+    emit statusMessage(QString::fromUtf8("狀態: 歡迎主人回家！"));
+    openDoor(); // 執行開門動作 (亮綠燈)
+  });
+  connect(alarm, &AlarmStateMachine::stateChanged, this,
+          [this](AlarmStateMachine::State from, AlarmStateMachine::State to,
+                 const QString &reason) {
+            qDebug() << "警報狀態:" << from << "->" << to << reason;
+            status->update(
+                {{"alarm_state",
+                  QMetaEnum::fromType<AlarmStateMachine::State>().valueToKey(
+                      to)}});
+          });
+  connect(alarm, &AlarmStateMachine::unlockGranted, this,
+          [this](bool wasPigAlarm) {
+            // 1. 通用解除動作
+            gpio->setGpio(LED_RED, 0);
+            gpio->setGpio(LED_BLUE, 0);
+            gpio->setGpio(BUZZER, 0);
+
+            // 2. 針對不同警報類型的後續處理
+            if (wasPigAlarm) {
+              // 豬豬警報：解除炸彈
+              emergency->disarmBomb();
+            } else {
+              // 陌生人警報或其他：執行開門動作
+              openDoor();
+            }
+
+            // 清理狀態檔案
+            QFile::remove("/tmp/guardian_alarm_status.json");
+            QFile::remove("/tmp/guardian_unlock_status.json");
+            publishAlarmCleared();
+          });
+  connect(alarm, &AlarmStateMachine::remoteCodeGenerated, this,
+          [this](const QString &code) {
+            emit statusMessage(
+                QString::fromUtf8("遠端授權通過！驗證碼已發送至您的 Discord"));
+            sendDiscordCode(code);
+            markRemoteCodeGenerated(code);
+            status->update({{"code_generated", true}}); // 不公開驗證碼本身
+          });
+
+  // Security Logic -> Hardware/Log
+  connect(security, &SecurityController::requestLog, blackbox,
+          &BlackboxInterface::logEvent);
+  connect(security, &SecurityController::requestGpio, gpio,
+          &GpioManager::setGpio);
+  connect(security, &SecurityController::passwordVerified, this,
+          [this](bool success) {
+            emit statusMessage(success ? QString::fromUtf8("狀態: 驗證成功！")
+                                       : QString::fromUtf8("狀態: 驗證失敗！"));
+          });
+  connect(security, &SecurityController::passwordVerified, alarm,
+          &AlarmStateMachine::handlePasswordVerified);
+
+  // Environmental Logic -> Hardware/UI
+  connect(env, &EnvironmentalController::requestGpio, gpio,
+          &GpioManager::setGpio);
+  connect(env, &EnvironmentalController::lightLevelChanged, this,
+          [this](int value, const QString &mode) {
+            emit statusMessage(
+                QString("狀態: 系統運作中 | 亮度: %1 (%2)").arg(value).arg(mode));
+            status->update({{"light_level", value}, {"light_mode", mode}});
+          });
+
+  // Emergency Logic -> UI
+  connect(emergency, &EmergencyController::countdownUpdated, this,
+          [this](int totalSeconds, QString formattedTime) {
+            emit statusMessage(
+                QString("<font color='red'>🚨 緊急倒數: %1 🚨</font>")
+                    .arg(formattedTime));
+
+            // 倒數只經由狀態推播送出 (每秒一筆只含 countdown 的 delta)，
+            // 不再每秒重寫 guardian_alarm_status.json
+            status->update({{"countdown", totalSeconds},
+                            {"countdown_str", formattedTime}});
+
+            // 倒計時蜂鳴器邏輯：每秒響一下 (200ms)
+            if (!m_isMuted) {
+              gpio->setGpioUrgent(BUZZER, 1);
+              scheduleBuzzerOff();
+            }
+          });
+
+  connect(emergency, &EmergencyController::bombExploded, this, [this]() {
+    emit statusMessage("<font color='red'><b>💥 系統已炸毀 💥</b></font>");
+    emit notice(true, "警告", "倒數結束，系統已執行緊急自毀程序！");
+    status->update({{"bomb", "exploded"},
+                    {"countdown", QJsonValue::Null},
+                    {"countdown_str", QJsonValue::Null}});
+  });
+
+  connect(emergency, &EmergencyController::bombExploded, alarm,
+          &AlarmStateMachine::handleBombExploded);
+  connect(emergency, &EmergencyController::bombDisarmed, alarm,
+          &AlarmStateMachine::handleBombDisarmed);
+  connect(emergency, &EmergencyController::bombDisarmed, this, [this]() {
+    emit statusMessage("狀態: 緊急狀態已解除");
+    status->update({{"bomb", QJsonValue::Null},
+                    {"countdown", QJsonValue::Null},
+                    {"countdown_str", QJsonValue::Null}});
+  });
+}
+
+GuardianCore::~GuardianCore() {
+  if (logicThread->isRunning())
+    QMetaObject::invokeMethod(camera, "stop", Qt::BlockingQueuedConnection);
+  else
+    camera->stop();
+
+  logicThread->quit();
+  logicThread->wait();
+
+  actuator->stop();
+  actuator->wait();
+
+  if (sensorThread->isRunning())
+    QMetaObject::invokeMethod(sensors, "stop", Qt::BlockingQueuedConnection);
+  sensorThread->quit();
+  sensorThread->wait();
+
+  // 手動釋放沒有 parent 的物件
+  delete security;
+  delete env;
+  delete alarm;
+  delete camera;
+  delete emergency;
+  delete sensors;
+}
+
+void GuardianCore::start() {
+  // 5. 啟動執行緒與感測器輪詢
+  logicThread->start();
+
+  // 光敏電阻 (CH0) 以 10Hz 取樣，環境控制器每秒批次濾波一次
+  sensors->setChannelRate(0, 10.0);
+  connect(sensorThread, &QThread::started, sensors, &SensorAcquisition::start);
+  sensorThread->start();
+  sensorDispatcher->subscribe(
+      0, 1000, env, [this](const QVector<AdcSample> &batch) {
+        env->updateLightSamples(batch);
+      });
+
+  // 路由都已註冊，開始接受 HTTP 連線
+  // 預設只接受本機連線 (Node.js 服務與 SSH 通道)；GUARDIAN_HTTP_BIND=0.0.0.0
+  // 讓區網直接存取 /stream.mjpg 與 /api/events
+  QHostAddress httpAddress(qEnvironmentVariableIsSet("GUARDIAN_HTTP_BIND")
+                               ? QString::fromLocal8Bit(
+                                     qgetenv("GUARDIAN_HTTP_BIND"))
+                               : QString("127.0.0.1"));
+  if (httpAddress.isNull()) {
+    qDebug() << "GUARDIAN_HTTP_BIND 不是有效的 IP 位址，改用 127.0.0.1";
+    httpAddress = QHostAddress::LocalHost;
+  }
+  quint16 httpPort = quint16(qEnvironmentVariableIntValue("GUARDIAN_HTTP_PORT"));
+  http->listen(httpAddress, httpPort ? httpPort : 8090);
+
+  // 啟動 Python AI 引擎 (或重播錄製檔)
+  if (PythonAiManager *ai = qobject_cast<PythonAiManager *>(camera)) {
+    if (ai->isReplay())
+      setupReplay(ai);
+  }
+  QMetaObject::invokeMethod(camera, "start");
+
+  // 日誌與遠端指令輪詢 (ADC 取樣已移至 sensorThread)
+  timers->scheduleRepeating(
+      "core.poll", 1000, this, [this]() { pollSensors(); }, 250);
+
+  // 驅動統計轉成 guardian_driver_* 指標；對齊週期點，與上面的輪詢同一次喚醒
+  timers->scheduleRepeating(
+      "blackbox.stats", 5000, this,
+      [this]() {
+        if (!blackbox->publishDriverStats())
+          timers->cancel("blackbox.stats");
+      },
+      1000);
+
+  // 指標摘要定期寫入黑盒子 (GUARDIAN_METRICS_DUMP_SEC，預設 600 秒，0 = 關閉)
+  int dumpSec = qEnvironmentVariableIsSet("GUARDIAN_METRICS_DUMP_SEC")
+                    ? qEnvironmentVariableIntValue("GUARDIAN_METRICS_DUMP_SEC")
+                    : 600;
+  if (dumpSec > 0)
+    timers->scheduleRepeating(
+        "core.metrics_dump", dumpSec * 1000, this, [this]() { dumpMetrics(); },
+        5000);
+}
+
+void GuardianCore::scheduleBuzzerOff() {
+  // 同一個 key：連續鳴叫只保留最後一次的關閉，不會累積多個計時器
+  timers->schedule(
+      "buzzer.off", 200, this,
+      [this]() {
+        // 只有在炸彈仍在啟動狀態時才關閉，避免影響其他開門音效
+        if (emergency->isBombActive())
+          gpio->setGpio(BUZZER, 0);
+      },
+      20);
+}
+
+void GuardianCore::pollSensors() {
+  // 常駐記憶體 (/proc/self/statm 第二欄，單位為頁)，比較無頭與 GUI 版本用
+  static MetricGauge &residentBytes = MetricsRegistry::instance().gauge(
+      "guardian_process_resident_bytes", "Resident set size of this process");
+  QFile statm("/proc/self/statm");
+  if (statm.open(QIODevice::ReadOnly)) {
+    const QList<QByteArray> fields = statm.readAll().split(' ');
+    if (fields.size() > 1)
+      residentBytes.set(fields[1].toDouble() * sysconf(_SC_PAGESIZE));
+  }
+
+  // --- 新增：讀取黑盒子日誌並通知 UI ---
+  QString newLogs = blackbox->readLogs();
+  if (!newLogs.isEmpty()) {
+    QStringList newLines = newLogs.split('\n', QString::SkipEmptyParts);
+    m_logHistory.append(newLines);
+
+    // 限制保留筆數，避免記憶體佔用過大 (例如保留最後 100 筆)
+    while (m_logHistory.size() > 100) {
+      m_logHistory.removeFirst();
+    }
+
+    emit logsUpdated(m_logHistory);
+  }
+
+  // --- 新增：檢查 Web Server 的遠端指令 ---
+  QFile controlFile("/tmp/guardian_control.txt");
+  if (controlFile.exists() &&
+      controlFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    QString action = controlFile.readAll().trimmed();
+    controlFile.close();
+
+    qDebug() << "偵測到遠端指令:" << action;
+
+    if (action == "open_door") {
+      openDoor(); // 執行亮綠燈邏輯
+    } else if (action == "mute_alarm") {
+      toggleMute(); // 執行靜音邏輯 (僅關閉蜂鳴器與 LED)
+      // emergency->disarmBomb(); // 移除：遠端靜音也不應解除炸彈倒數
+    } else if (action == "reset") {
+      remoteReset();
+    } else if (action == "test_alarm") {
+      // 模擬 AI 觸發警報
+      QMetaObject::invokeMethod(alarm, "handleManualTrigger",
+                                Q_ARG(QString, "pig"));
+    }
+
+    QFile::remove("/tmp/guardian_control.txt"); // 執行後刪除指令檔案
+  }
+
+  // --- 新傳：檢查 遠端解鎖狀態 (僅在警報啟動時有效) ---
+  if (QFile::exists("/tmp/guardian_alarm_status.json")) {
+    QFile unlockFile("/tmp/guardian_unlock_status.json");
+    if (unlockFile.exists() &&
+        unlockFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+      QJsonObject obj = QJsonDocument::fromJson(unlockFile.readAll()).object();
+      unlockFile.close();
+
+      // 如果遠端已授權 (remote_unlocked) 且尚未生成現場隨機碼，
+      // 交給狀態機決定是否產生驗證碼 (同一次警報只會產生一次)
+      status->update({{"remote_unlocked", obj["remote_unlocked"].toBool()}});
+      if (obj["remote_unlocked"].toBool() &&
+          !obj["random_code_generated"].toBool()) {
+        QMetaObject::invokeMethod(alarm, "handleRemoteUnlock");
+      }
+    }
+  }
+}
+
+void GuardianCore::remoteReset() {
+  // 重置警報狀態檔案與緊急狀態
+  QFile::remove("/tmp/guardian_alarm_status.json");
+  publishAlarmCleared();
+  emergency->disarmBomb(); // 確保停止 Kernel Driver 的緊急計時與爆炸觸發
+  QMetaObject::invokeMethod(alarm, "reset");
+  emit statusMessage(QString::fromUtf8("狀態: 系統已遠端重置"));
+  blackbox->logEvent("系統經由遠端網頁重置", 0);
+}
+
+void GuardianCore::publishAlarmCleared() {
+  status->update({{"alarm_active", false},
+                  {"alarm_type", QJsonValue::Null},
+                  {"alarm_time", QJsonValue::Null},
+                  {"countdown", QJsonValue::Null},
+                  {"countdown_str", QJsonValue::Null},
+                  {"remote_unlocked", QJsonValue::Null},
+                  {"code_generated", QJsonValue::Null}});
+}
+
+void GuardianCore::setupReplay(PythonAiManager *ai) {
+  m_replay = true;
+  // 限流改用事件 (錄製時間軸) 的時間：盡快重播時的決策與原始速度相同
+  AlarmStateMachine *machine = alarm;
+  alarm->setClock([machine]() { return machine->eventTimeNs(); });
+
+  connect(ai, &InferenceBackend::detectionStateChanged, this,
+          [this, ai](const DetectionEvent &event) {
+            m_replayDetections.append(QJsonObject{
+                {"t_ms", double(event.timestampMs - ai->replayEpochMs())},
+                {"seq", double(event.frameSeq)},
+                {"type", event.type},
+                {"entered", event.entered},
+                {"peak_conf", event.peakConfidence}});
+          });
+  // 以下訊號都由邏輯執行緒依序送回，彼此順序固定
+  connect(alarm, &AlarmStateMachine::stateChanged, this,
+          [this](AlarmStateMachine::State from, AlarmStateMachine::State to,
+                 const QString &reason) {
+            const QMetaEnum states =
+                QMetaEnum::fromType<AlarmStateMachine::State>();
+            const QString transition = QString("%1->%2")
+                                           .arg(states.valueToKey(from))
+                                           .arg(states.valueToKey(to));
+            m_replayDecisions.append(
+                QJsonObject{{"transition", transition}, {"reason", reason}});
+          });
+  connect(alarm, &AlarmStateMachine::alarmRaised, this,
+          [this](const QString &type) {
+            m_replayDecisions.append(QJsonObject{{"alarm", type}});
+          });
+  connect(alarm, &AlarmStateMachine::ownerArrived, this, [this]() {
+    m_replayDecisions.append(QJsonObject{{"owner_arrived", true}});
+  });
+
+  connect(ai, &PythonAiManager::replayFinished, this,
+          [this](const QJsonObject &replay) {
+            // 先讓邏輯執行緒處理完已排入的偵測事件，再回到主執行緒
+            // (排在它送回的決策訊號之後) 輸出報告
+            QTimer::singleShot(0, alarm, [this, replay]() {
+              QTimer::singleShot(0, this,
+                                 [this, replay]() { finishReplay(replay); });
+            });
+          });
+}
+
+void GuardianCore::finishReplay(const QJsonObject &replay) {
+  QJsonObject report{{"replay", replay},
+                     {"detections", m_replayDetections},
+                     {"alarm_decisions", m_replayDecisions},
+                     {"metrics", MetricsRegistry::instance().toJson()}};
+  // 報告寫到 stdout (除錯訊息在 stderr)，兩個版本的輸出可直接比對
+  const QByteArray json = QJsonDocument(report).toJson();
+  fwrite(json.constData(), 1, size_t(json.size()), stdout);
+  fflush(stdout);
+  QCoreApplication::exit(replay.contains("error") ? 1 : 0);
+}
+
+void GuardianCore::dumpMetrics() {
+  // event_data.message 上限 255 bytes，摘要依此切成多行
+  const QString prefix = "metrics ";
+  for (const QString &line : MetricsRegistry::instance().summary(
+           255 - prefix.toUtf8().size()))
+    blackbox->logEvent(prefix + line, 0);
+}
+
+void GuardianCore::markRemoteCodeGenerated(const QString &code) {
+  QFile unlockFile("/tmp/guardian_unlock_status.json");
+  if (!unlockFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    return;
+  QJsonObject obj = QJsonDocument::fromJson(unlockFile.readAll()).object();
+  unlockFile.close();
+
+  // 更新狀態，標記已生成，避免重複
+  obj["random_code_generated"] = true;
+  obj["random_code"] = code;
+
+  if (unlockFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    unlockFile.write(QJsonDocument(obj).toJson());
+    unlockFile.close();
+  }
+}
+
+void GuardianCore::handleAlarm(QString type) {
+  static MetricHistogram &handlerTime = MetricsRegistry::instance().histogram(
+      "guardian_alarm_handler_seconds",
+      "GUI-thread time spent handling a raised alarm");
+  MetricTimer timer(handlerTime);
+  TRACE_SCOPE("alarm.handle");
+
+  // 1. 本地硬體連動 (透過 Blackbox 驅動)
+  if (type == "pig") {
+    // LED_RED 與初始鳴叫已由 AlarmStateMachine 經 AlarmActuator 送出
+    blackbox->logEvent("AI 模擬觸發: 發現小豬入侵 (最高警報)", 2);
+
+    // 初始鳴叫 200ms 後關閉
+    if (!m_isMuted)
+      scheduleBuzzerOff();
+
+    // 啟動 5 分鐘炸彈倒數 (Kernel Timer)
+    emergency->triggerPigBomb(5);
+  } else if (type == "stranger") {
+    blackbox->logEvent("AI 模擬觸發: 發現陌生人", 1);
+  }
+
+  // 2. 寫入 JSON 給 Web Server 讀取
+  QFile file("/tmp/guardian_alarm_status.json");
+  if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    QTextStream out(&file);
+    out.setCodec("UTF-8"); // 確保 UTF-8 編碼
+    out << "{\n"
+        << "  \"alarm_active\": true,\n"
+        << "  \"alarm_type\": \"" << type << "\",\n"
+        << "  \"timestamp\": \""
+        << QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss")
+        << "\",\n"
+        << "  \"confidence\": 0.98\n"
+        << "}";
+    file.close();
+    qDebug() << "警報狀態已寫入 /tmp/guardian_alarm_status.json";
+  }
+  status->update(
+      {{"alarm_active", true},
+       {"alarm_type", type},
+       {"alarm_time",
+        QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss")}});
+
+  // 3. Discord 推播：快照完成 (snapshotReady) 後才送出，不阻塞警報路徑
+  snapshots->capture(type);
+
+  // 4. 保存警報前後的影像片段 (背景寫檔)
+  recorder->trigger(type);
+
+  // 5. 追蹤開啟時保存警報前 5 秒到後 2 秒的 span，方便事後分析延遲
+  if (Tracer::isEnabled()) {
+    const qint64 alarmNs = Tracer::nowNs();
+    const QString path =
+        QString("/tmp/guardian_images/traces/trace_%1_%2.json")
+            .arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss"))
+            .arg(type);
+    timers->schedule(
+        "trace.dump:" + path, 2000, this,
+        [path, alarmNs]() { Tracer::dumpAsync(path, alarmNs - 5000000000LL); },
+        500);
+  }
+}
+
+void GuardianCore::sendDiscordNotification(QString type, QString priority,
+                                           QString imagePath,
+                                           QString thumbPath) {
+  if (m_replay) {
+    qDebug() << "重播模式：略過 Discord 推播" << type;
+    return;
+  }
+  QFile queueFile("/tmp/guardian_discord_queue.json");
+  if (queueFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    QJsonObject jsonObj;
+    jsonObj["type"] = (type == "pig" ? "pig_intrusion" : "stranger_detected");
+    jsonObj["priority"] = priority;
+    jsonObj["message"] =
+        (type == "pig") ? QString::fromUtf8("🚨 偵測到小豬入侵！(最高警報)")
+                        : QString::fromUtf8("👤 偵測到陌生人來訪");
+    jsonObj["timestamp"] =
+        QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss");
+    jsonObj["image_path"] = imagePath;
+    jsonObj["thumb_path"] = thumbPath;
+
+    QJsonDocument doc(jsonObj);
+    queueFile.write(doc.toJson());
+    queueFile.close();
+    qDebug() << "Discord 推播任務已加入佇列";
+  } else {
+    qDebug() << "無法寫入 Discord 佇列檔";
+  }
+}
+
+void GuardianCore::sendDiscordCode(QString code) {
+  if (m_replay)
+    return;
+  QFile queueFile("/tmp/guardian_discord_queue.json");
+  if (queueFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    QJsonObject jsonObj;
+    jsonObj["type"] = "verification_code";
+    jsonObj["priority"] = "high";
+    jsonObj["message"] =
+        QString::fromUtf8("您的遠端解鎖驗證碼為：**") + code +
+        QString::fromUtf8("**\n請在現場設備輸入此代碼以完成解鎖。");
+    jsonObj["timestamp"] =
+        QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss");
+
+    QJsonDocument doc(jsonObj);
+    queueFile.write(doc.toJson());
+    queueFile.close();
+    qDebug() << "驗證碼推播已加入佇列:" << code;
+  } else {
+    qDebug() << "無法寫入 Discord 佇列檔 (驗證碼)";
+  }
+}
+
+void GuardianCore::setPreviewEnabled(bool enabled) {
+  QMetaObject::invokeMethod(camera, "setPreviewEnabled", Q_ARG(bool, enabled));
+}
+
+void GuardianCore::previewFrameShown() {
+  QMetaObject::invokeMethod(camera, "previewFrameShown");
+}
+
+void GuardianCore::openDoor() {
+  emit statusMessage("狀態: [F1] 開門中(綠色LED 亮5秒)");
+  blackbox->logEvent("開門中(綠色LED 亮5秒)", 0);
+  gpio->setGpio(LED_GREEN, 1);
+  // 再次開門會取代尚未執行的關門，綠燈從最後一次開門起算亮 5 秒
+  timers->schedule(
+      "door.close", 5000, this,
+      [this]() {
+        gpio->setGpio(LED_GREEN, 0);
+        blackbox->logEvent("關門(綠色LED 暗)", 0);
+      },
+      100);
+}
+
+void GuardianCore::toggleMute() {
+  m_isMuted = !m_isMuted; // 切換靜音狀態
+  QMetaObject::invokeMethod(alarm, "setMuted", Q_ARG(bool, m_isMuted));
+  status->update({{"muted", m_isMuted}});
+  if (m_isMuted) {
+    emit statusMessage("狀態: [F2] 警報已靜音");
+    blackbox->logEvent("警報靜音 (F2)", 1);
+    gpio->setGpio(LED_RED, 0);
+    gpio->setGpio(BUZZER, 0);
+  } else {
+    emit statusMessage("狀態: [F2] 警報音效已恢復");
+    blackbox->logEvent("恢復警報音效 (F2)", 0);
+    if (emergency->isBombActive()) {
+      gpio->setGpio(LED_RED, 1);
+    }
+  }
+}
+
+void GuardianCore::triggerManualAlarm(const QString &type) {
+  QMetaObject::invokeMethod(alarm, "handleManualTrigger", Q_ARG(QString, type));
+}
+
+void GuardianCore::toggleAutoLight() {
+  m_isAutoLight = !m_isAutoLight;
+  QMetaObject::invokeMethod(env, "setAutoMode", Q_ARG(bool, m_isAutoLight));
+  QString modeStr = m_isAutoLight ? "自動 (光敏控制)" : "手動 (快捷鍵控制)";
+  emit statusMessage(QString("狀態: [F7] 燈光模式改為 %1").arg(modeStr));
+  status->update({{"light_auto", m_isAutoLight}});
+  blackbox->logEvent(QString("燈光模式切換: %1").arg(modeStr), 0);
+}
+
+void GuardianCore::toggleManualLed() {
+  if (m_isAutoLight) {
+    emit statusMessage("狀態: [F8] 目前為自動模式，請先按 F7 切換至手動");
+    return;
+  }
+  m_manualYellowLed = !m_manualYellowLed;
+  QMetaObject::invokeMethod(env, "setManualLed",
+                            Q_ARG(bool, m_manualYellowLed));
+  QString stateStr = m_manualYellowLed ? "開啟" : "關閉";
+  emit statusMessage(QString("狀態: [F8] 手動%1黃燈").arg(stateStr));
+  status->update({{"manual_led", m_manualYellowLed}});
+  blackbox->logEvent(QString("手動%1黃燈").arg(stateStr), 0);
+}
+
+void GuardianCore::triggerSelfDestruct() {
+  qDebug() << "F12 連按兩下：手動觸發緊急自毀！";
+  emit statusMessage(
+      "<font color='red'><b>💥 F12 手動觸發自毀程序 💥</b></font>");
+  blackbox->logEvent("F12 連按兩下：手動觸發緊急自毀程序", 2);
+  gpio->setGpioUrgent(LED_RED, 1);
+  emergency->triggerPigBomb(0); // 立即觸發
+  snapshots->capture("pig");    // 快照完成後發送 Discord 通知
+}
+
+void GuardianCore::verifyPassword(const QString &input) {
+  QMetaObject::invokeMethod(security, "verifyPassword", Q_ARG(QString, input));
+}
+
+void GuardianCore::logEvent(const QString &message, int priority) {
+  blackbox->logEvent(message, priority);
+}
+
+void GuardianCore::shutdown() {
+  blackbox->logEvent("系統正常關閉", 0);
+  QCoreApplication::quit();
+}
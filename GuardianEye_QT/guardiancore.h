@@ -0,0 +1,128 @@
+#ifndef GUARDIANCORE_H
+#define GUARDIANCORE_H
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QObject>
+#include <QStringList>
+#include <QThread>
+
+class InferenceBackend;
+class PythonAiManager;
+class AlarmStateMachine;
+class AlarmActuator;
+class SecurityController;
+class EnvironmentalController;
+class BlackboxInterface;
+class GpioManager;
+class SensorAcquisition;
+class SensorDispatcher;
+class EmergencyController;
+class EventRecorder;
+class HttpServer;
+class MjpegStreamer;
+class SnapshotService;
+class StatusHub;
+class TimerWheel;
+
+/**
+ * GuardianCore
+ * 不依賴任何 widget 的系統本體：硬體介面、AI 後端、控制器與其執行緒、
+ * 感測器輪詢、警報動作、遠端指令 (/tmp 檔案與 HTTP) 都在這裡連線。
+ * 無頭模式 (--headless) 只建立 QCoreApplication 與此物件；
+ * MainWindow 只是選用的本機用戶端，訂閱狀態文字/日誌並呼叫下列動作
+ *
+ * 預覽影格預設關閉 (沒有人看就不解碼)，由 UI 在顯示時開啟
+ */
+class GuardianCore : public QObject {
+  Q_OBJECT
+public:
+  explicit GuardianCore(QObject *parent = nullptr);
+  ~GuardianCore();
+
+  // UI 完成連線後呼叫：啟動執行緒、感測器、AI 後端與 HTTP 伺服器
+  void start();
+
+  // 位於邏輯執行緒：只用來連接訊號，動作請透過下列 slot
+  InferenceBackend *inference() const { return camera; }
+  const QStringList &logHistory() const { return m_logHistory; }
+  bool isAutoLight() const { return m_isAutoLight; }
+
+public slots:
+  void openDoor();                              // F1 / 遠端 open_door
+  void toggleMute();                            // F2 / 遠端 mute_alarm
+  void triggerManualAlarm(const QString &type); // F5/F6 / 遠端 test_alarm
+  void toggleAutoLight();                       // F7
+  void toggleManualLed();                       // F8 (僅手動模式)
+  void triggerSelfDestruct();                   // F12 連按兩下
+  void verifyPassword(const QString &input);
+  void remoteReset();
+  void shutdown(); // Ctrl+Alt+Q
+  void logEvent(const QString &message, int priority); // 寫入黑盒子日誌
+  // 預覽影格開關 (UI 顯示/最小化時呼叫)；後端位於邏輯執行緒，排入其佇列
+  void setPreviewEnabled(bool enabled);
+  void previewFrameShown(); // UI 畫出一張預覽影格後呼叫 (預覽流量控制)
+
+signals:
+  // 給 UI 狀態列的文字 (可含 HTML)
+  void statusMessage(const QString &text);
+  // 黑盒子日誌有新內容 (最近 100 筆)
+  void logsUpdated(const QStringList &lines);
+  // 需要使用者注意的訊息 (AI 錯誤、自毀)，UI 以非阻塞對話框呈現
+  void notice(bool critical, const QString &title, const QString &text);
+
+private slots:
+  void pollSensors();               // 定期輪詢日誌與遠端指令
+  void handleAlarm(QString type);   // 狀態機決定警報後的硬體/推播動作
+  void sendDiscordNotification(QString type, QString priority,
+                               QString imagePath = QString(),
+                               QString thumbPath = QString());
+  void sendDiscordCode(QString code);
+
+private:
+  TimerWheel *timers; // 裝置/控制器期限 (蜂鳴器、開門、輪詢...)
+
+  // 核心硬體介面
+  BlackboxInterface *blackbox;
+  GpioManager *gpio;       // 所有 GPIO 寫入經此快取與合併
+  AlarmActuator *actuator; // 警報關鍵 GPIO 的高優先權執行緒
+
+  // 感測器擷取 (專屬執行緒) 與樣本分發
+  SensorAcquisition *sensors;
+  SensorDispatcher *sensorDispatcher;
+
+  // 業務邏輯控制器
+  InferenceBackend *camera = nullptr;
+  SecurityController *security;
+  EnvironmentalController *env;
+  EmergencyController *emergency;
+  AlarmStateMachine *alarm;   // 警報狀態機 (邏輯執行緒)
+  EventRecorder *recorder;    // 警報預錄片段
+  SnapshotService *snapshots; // 警報快照 (背景裁切/編碼)
+  HttpServer *http;           // 行程內 HTTP (即時影像等)
+  MjpegStreamer *liveView;    // 位於 http 執行緒，由其釋放
+  StatusHub *status;          // 狀態推播 (SSE)，同上
+
+  QStringList m_logHistory;
+
+  // 執行緒管理
+  QThread *logicThread;  // 邏輯共用執行緒
+  QThread *sensorThread; // 感測器擷取執行緒
+  bool m_isMuted = false;
+  bool m_isAutoLight = true;      // 是否為自動燈光模式
+  bool m_manualYellowLed = false; // 手動模式下的黃燈狀態
+
+  // 重播模式 (GUARDIAN_AI_REPLAY)：收集決策，播放完畢後輸出報告並結束
+  bool m_replay = false;
+  QJsonArray m_replayDetections;
+  QJsonArray m_replayDecisions;
+
+  void scheduleBuzzerOff(); // 鳴叫 200ms 後關閉蜂鳴器
+  void markRemoteCodeGenerated(const QString &code);
+  void dumpMetrics();         // 指標摘要寫入黑盒子
+  void publishAlarmCleared(); // 推播端清除警報相關欄位
+  void setupReplay(PythonAiManager *ai);
+  void finishReplay(const QJsonObject &replay);
+};
+
+#endif // GUARDIANCORE_H
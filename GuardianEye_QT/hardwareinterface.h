@@ -1,8 +1,16 @@
 #ifndef HARDWAREINTERFACE_H
 #define HARDWAREINTERFACE_H
 
+#include <QtGlobal>
 #include <sys/ioctl.h>
 
+// GUARDIAN_HW=sim：不開啟 /dev/blackbox、SPI 與 GPIO，所有硬體操作成為 no-op
+// (重播量測時不會驅動實體的蜂鳴器與 LED)
+inline bool hardwareSimulated() {
+  static const bool simulated = qgetenv("GUARDIAN_HW") == "sim";
+  return simulated;
+}
+
 // 與 Driver 定義一致的結構
 struct event_data {
   char message[256];
@@ -14,6 +22,13 @@ struct gpio_command {
   int value;
 };
 
+// 批次 GPIO：一次 ioctl 設定多支腳位
+#define GPIO_BATCH_MAX 8
+struct gpio_batch {
+  int count;
+  struct gpio_command cmds[GPIO_BATCH_MAX];
+};
+
 #define LOG_EVENT _IOW('B', 1, struct event_data)
 #define CLEAR_LOG _IO('B', 2)
 #define SET_GPIO_VALUE _IOW('B', 3, struct gpio_command)
@@ -23,6 +38,30 @@ struct gpio_command {
 #define STOP_EMERGENCY _IO('B', 5)
 #define GET_EMERGENCY_STATUS _IOR('B', 6, int)
 
+#define SET_GPIO_BATCH _IOW('B', 7, struct gpio_batch)
+
+// 驅動統計 (內容同 /sys/kernel/debug/blackbox/stats)
+// 陣列索引：優先級 0..2；ioctl_* 為 _IOC_NR 1..9
+// capacity 為每個 CPU 的筆數，其餘為所有 CPU 的總和
+#define BB_STATS_PRIO_COUNT 3
+#define BB_STATS_IOCTL_SLOTS 10
+struct blackbox_stats {
+  unsigned long long events[BB_STATS_PRIO_COUNT];
+  unsigned long long overwritten[BB_STATS_PRIO_COUNT];
+  unsigned long long dropped_bytes;
+  unsigned long long reads;
+  unsigned long long read_bytes;
+  unsigned long long ioctl_calls[BB_STATS_IOCTL_SLOTS];
+  unsigned long long ioctl_ns[BB_STATS_IOCTL_SLOTS];
+  unsigned long long lock_max_hold_ns;
+  unsigned long long emergency_timer_fires;
+  unsigned long long printk_suppressed;
+  unsigned int capacity[BB_STATS_PRIO_COUNT];
+  unsigned int used[BB_STATS_PRIO_COUNT];
+};
+
+#define GET_DRIVER_STATS _IOR('B', 9, struct blackbox_stats)
+
 // GPIO 腳位定義
 enum GpioPin {
   LED_GREEN = 398,
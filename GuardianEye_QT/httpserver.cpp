@@ -0,0 +1,182 @@
+#include "httpserver.h"
+#include "metrics.h"
+#include <QDebug>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUrl>
+
+HttpServer::HttpServer(QObject *parent)
+    : QObject(parent), m_thread(new QThread(this)), m_context(new QObject()) {
+  m_context->moveToThread(m_thread);
+  connect(m_thread, &QThread::finished, m_context, &QObject::deleteLater);
+  m_thread->setObjectName("HttpServer");
+  m_thread->start();
+}
+
+HttpServer::~HttpServer() {
+  // QTcpServer 與 socket 都是 m_context 的子物件，隨執行緒結束一併釋放
+  m_thread->quit();
+  m_thread->wait();
+}
+
+void HttpServer::route(const QString &path, Handler handler) {
+  m_routes.insert(path, handler);
+}
+
+void HttpServer::listen(const QHostAddress &address, quint16 port) {
+  QTimer::singleShot(0, m_context, [this, address, port]() {
+    m_server = new QTcpServer(m_context);
+    connect(m_server, &QTcpServer::newConnection, m_context,
+            [this]() { handleNewConnection(); });
+    if (!m_server->listen(address, port)) {
+      qDebug() << "HttpServer: 無法監聽" << address.toString() << port
+               << m_server->errorString();
+      return;
+    }
+    qDebug() << "HttpServer: 監聽於" << address.toString() << port;
+  });
+}
+
+static MetricCounter &requestTimeouts() {
+  static MetricCounter &counter = MetricsRegistry::instance().counter(
+      "guardian_http_request_timeouts_total",
+      "Connections closed before sending a complete request header");
+  return counter;
+}
+
+void HttpServer::handleNewConnection() {
+  while (QTcpSocket *socket = m_server->nextPendingConnection()) {
+    socket->setParent(m_context);
+    connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+    if (m_connections >= m_maxConnections) {
+      respond(socket, 503, "text/plain", "too many connections\n");
+      continue;
+    }
+    m_connections++;
+
+    // 標頭期限自連線起算；閒置期限每次收到資料後重新計時
+    QTimer *headerTimer = new QTimer(socket);
+    QTimer *readTimer = new QTimer(socket);
+    headerTimer->setSingleShot(true);
+    readTimer->setSingleShot(true);
+    readTimer->setInterval(m_readTimeoutMs);
+    auto expire = [socket]() {
+      if (socket->property("http_dispatched").toBool() ||
+          socket->state() != QAbstractSocket::ConnectedState)
+        return;
+      requestTimeouts().inc();
+      respond(socket, 408, "text/plain", "request timeout\n");
+    };
+    connect(headerTimer, &QTimer::timeout, socket, expire);
+    connect(readTimer, &QTimer::timeout, socket, expire);
+    headerTimer->start(m_headerTimeoutMs);
+    readTimer->start();
+
+    connect(socket, &QTcpSocket::readyRead, m_context,
+            [this, socket, readTimer]() {
+              if (!socket->property("http_dispatched").toBool())
+                readTimer->start();
+              handleReadyRead(socket);
+            });
+    connect(socket, &QTcpSocket::disconnected, m_context,
+            [this]() { m_connections--; });
+  }
+}
+
+void HttpServer::handleReadyRead(QTcpSocket *socket) {
+  // 已交給串流 handler 的連線不再解析 (客戶端不應再送資料)
+  if (socket->property("http_dispatched").toBool()) {
+    socket->readAll();
+    return;
+  }
+
+  QByteArray buffer = socket->property("http_buffer").toByteArray();
+  buffer.append(socket->readAll());
+  const int end = buffer.indexOf("\r\n\r\n");
+  if (end < 0) {
+    if (buffer.size() > MAX_HEADER_BYTES) {
+      respond(socket, 431, "text/plain", "header too large\n");
+      return;
+    }
+    socket->setProperty("http_buffer", buffer);
+    return;
+  }
+  socket->setProperty("http_buffer", QVariant());
+  socket->setProperty("http_dispatched", true);
+
+  HttpRequest request;
+  if (!parseRequest(buffer.left(end), request)) {
+    respond(socket, 400, "text/plain", "bad request\n");
+    return;
+  }
+  if (request.method != "GET") {
+    respond(socket, 405, "text/plain", "method not allowed\n",
+            "Allow: GET\r\n");
+    return;
+  }
+
+  auto it = m_routes.constFind(request.path);
+  if (it == m_routes.constEnd()) {
+    respond(socket, 404, "text/plain", "not found\n");
+    return;
+  }
+  (*it)(socket, request);
+}
+
+bool HttpServer::parseRequest(const QByteArray &head,
+                              HttpRequest &request) const {
+  const QList<QByteArray> lines = head.split('\n');
+  const QList<QByteArray> first = lines.value(0).trimmed().split(' ');
+  if (first.size() < 3)
+    return false;
+
+  request.method = first[0];
+  QUrl url(QString::fromLatin1(first[1]));
+  request.path = url.path();
+  request.query = QUrlQuery(url);
+  for (int i = 1; i < lines.size(); i++) {
+    const int colon = lines[i].indexOf(':');
+    if (colon > 0)
+      request.headers.insert(lines[i].left(colon).trimmed().toLower(),
+                             lines[i].mid(colon + 1).trimmed());
+  }
+  return true;
+}
+
+void HttpServer::respond(QTcpSocket *socket, int status,
+                         const QByteArray &contentType, const QByteArray &body,
+                         const QByteArray &extraHeaders) {
+  QByteArray head = "HTTP/1.1 " + QByteArray::number(status) + " " +
+                    statusText(status) + "\r\n";
+  head += "Content-Type: " + contentType + "\r\n";
+  head += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+  head += "Cache-Control: no-cache\r\n";
+  head += "Connection: close\r\n";
+  head += extraHeaders;
+  head += "\r\n";
+  socket->write(head);
+  socket->write(body);
+  socket->disconnectFromHost(); // 送完緩衝區後才真正關閉
+}
+
+QByteArray HttpServer::statusText(int status) {
+  switch (status) {
+  case 200:
+    return "OK";
+  case 400:
+    return "Bad Request";
+  case 404:
+    return "Not Found";
+  case 405:
+    return "Method Not Allowed";
+  case 408:
+    return "Request Timeout";
+  case 431:
+    return "Request Header Fields Too Large";
+  case 503:
+    return "Service Unavailable";
+  default:
+    return "Unknown";
+  }
+}
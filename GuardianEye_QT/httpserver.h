@@ -0,0 +1,73 @@
+#ifndef HTTPSERVER_H
+#define HTTPSERVER_H
+
+#include <QHash>
+#include <QHostAddress>
+#include <QObject>
+#include <QThread>
+#include <QUrlQuery>
+#include <functional>
+
+class QTcpServer;
+class QTcpSocket;
+
+struct HttpRequest {
+  QByteArray method;
+  QString path;
+  QUrlQuery query;
+  QHash<QByteArray, QByteArray> headers; // key 一律小寫
+};
+
+/**
+ * HttpServer
+ * 行程內的極簡 HTTP/1.1 伺服器：QTcpServer 與所有連線都在專屬執行緒上，
+ * 依路徑分派給註冊的 handler (同樣在伺服器執行緒執行)。
+ * 一般 handler 呼叫 respond() 後連線即關閉；串流 handler (MJPEG/SSE)
+ * 可保留 socket 自行寫入，斷線時 socket 由伺服器回收
+ */
+class HttpServer : public QObject {
+  Q_OBJECT
+public:
+  using Handler = std::function<void(QTcpSocket *socket,
+                                     const HttpRequest &request)>;
+
+  explicit HttpServer(QObject *parent = nullptr);
+  ~HttpServer();
+
+  // 需在 listen() 前註冊；path 完全比對
+  void route(const QString &path, Handler handler);
+  void setMaxConnections(int max) { m_maxConnections = max; }
+  // 收到完整請求標頭的期限，以及兩次讀取之間允許的閒置時間；
+  // 逾時的連線回 408 並關閉，不會一直佔用連線名額 (串流連線不受限)
+  void setHeaderTimeout(int ms) { m_headerTimeoutMs = ms; }
+  void setReadTimeout(int ms) { m_readTimeoutMs = ms; }
+
+  // 在伺服器執行緒上開始監聽 (非同步，失敗時只記錄)
+  void listen(const QHostAddress &address, quint16 port);
+
+  // 串流元件需 moveToThread 到此執行緒，與 socket 同執行緒操作
+  QThread *serverThread() const { return m_thread; }
+
+  static void respond(QTcpSocket *socket, int status,
+                      const QByteArray &contentType, const QByteArray &body,
+                      const QByteArray &extraHeaders = QByteArray());
+  static QByteArray statusText(int status);
+
+private:
+  static const int MAX_HEADER_BYTES = 8192;
+
+  QThread *m_thread;
+  QObject *m_context; // 伺服器執行緒上的 QObject，用來投遞工作
+  QTcpServer *m_server = nullptr;
+  QHash<QString, Handler> m_routes;
+  int m_maxConnections = 512;
+  int m_connections = 0;
+  int m_headerTimeoutMs = 10000;
+  int m_readTimeoutMs = 5000;
+
+  void handleNewConnection();
+  void handleReadyRead(QTcpSocket *socket);
+  bool parseRequest(const QByteArray &head, HttpRequest &request) const;
+};
+
+#endif // HTTPSERVER_H
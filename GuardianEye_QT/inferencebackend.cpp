@@ -0,0 +1,52 @@
+#include "inferencebackend.h"
+#include "nativeinferencebackend.h"
+#include "pythonaimanager.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+
+InferenceBackend *InferenceBackend::create(QObject *parent) {
+  QByteArray kind = qgetenv("GUARDIAN_AI_BACKEND");
+  if (kind == "native") {
+    // 原生後端沒有人臉偵測/辨識，陌生人與主人警報永遠不會觸發；
+    // 必須以 GUARDIAN_AI_NATIVE_PIG_ONLY=1 明確同意，否則改用 Python 後端
+    if (qgetenv("GUARDIAN_AI_NATIVE_PIG_ONLY") != "1") {
+      qDebug() << "InferenceBackend: [錯誤] 原生後端不支援人臉 "
+                  "(陌生人/主人警報)，改用 Python 後端；"
+                  "確定只需要小豬偵測請設定 GUARDIAN_AI_NATIVE_PIG_ONLY=1";
+      return new PythonAiManager(parent);
+    }
+    qDebug() << "InferenceBackend: 使用行程內 OpenCV DNN 後端 "
+                "[警告] 僅偵測小豬，陌生人與主人警報已停用";
+    return new NativeInferenceBackend(parent);
+  }
+  return new PythonAiManager(parent);
+}
+
+QString InferenceBackend::locateAiDirectory(const QString &marker) {
+  QString appPath = QCoreApplication::applicationDirPath();
+  QDir dir(appPath);
+  qDebug() << "Qt 執行位置:" << appPath;
+
+  // 搜尋清單：包含您目前的 GE1_SR 以及原本的 GuardianEye
+  QStringList possibleDirs;
+  possibleDirs << "GE1_SR" << "GuardianEye" << "GE1";
+
+  for (int i = 0; i < 3; ++i) {
+    // 檢查清單中的資料夾
+    for (const QString &dirName : possibleDirs) {
+      if (dir.exists(dirName)) {
+        QDir targetDir(dir.absoluteFilePath(dirName));
+        if (targetDir.exists(marker))
+          return targetDir.absolutePath();
+      }
+    }
+
+    // 檢查當前目錄是否直接包含目標檔案
+    if (dir.exists(marker))
+      return dir.absolutePath();
+    if (!dir.cdUp())
+      break;
+  }
+  return QString();
+}
@@ -0,0 +1,51 @@
+#ifndef INFERENCEBACKEND_H
+#define INFERENCEBACKEND_H
+
+#include "detectionfusion.h"
+#include <QImage>
+#include <QObject>
+
+/**
+ * InferenceBackend
+ * AI 影像辨識後端的共同介面：PythonAiManager (python3 子行程) 與
+ * NativeInferenceBackend (行程內 OpenCV DNN) 皆實作此介面，
+ * GuardianCore 與 MainWindow 只依賴這裡的訊號
+ */
+class InferenceBackend : public QObject {
+  Q_OBJECT
+public:
+  explicit InferenceBackend(QObject *parent = nullptr) : QObject(parent) {
+    qRegisterMetaType<DetectionEvent>("DetectionEvent");
+  }
+  virtual ~InferenceBackend() {}
+
+  // 依環境變數 GUARDIAN_AI_BACKEND (python/native) 建立後端，預設 python；
+  // native 不含人臉路徑，另需 GUARDIAN_AI_NATIVE_PIG_ONLY=1 才會使用
+  static InferenceBackend *create(QObject *parent = nullptr);
+
+  // 從執行檔位置往上搜尋 GE1_SR/GuardianEye/GE1 等資料夾，回傳含有 marker
+  // 檔案的目錄 (AI 腳本與 models/ 所在處)，找不到時回傳空字串
+  static QString locateAiDirectory(const QString &marker);
+
+public slots:
+  virtual void start() = 0;
+  virtual void stop() = 0;
+  // 關閉時只傳偵測結果、不產生預覽影格 (例如視窗最小化)
+  virtual void setPreviewEnabled(bool enabled) { Q_UNUSED(enabled); }
+  // 即使預覽關閉/無 credit，也至少以此速率產生壓縮影格 (錄影等背景用途)
+  virtual void setMinimumFrameRate(int fps) { Q_UNUSED(fps); }
+  // UI 已畫出一張 frameReady 的影格；有流量控制的後端據此歸還 credit
+  virtual void previewFrameShown() {}
+
+signals:
+  void frameReady(QImage img);
+  // 後端已有的 JPEG 原始位元組 (QByteArray 隱式共享，不複製)
+  void compressedFrameReady(const QByteArray &jpeg, quint64 seq,
+                            qint64 timestampMs);
+  // 經時間融合後的偵測狀態轉換 (進入/離開)
+  void detectionStateChanged(const DetectionEvent &event);
+  void errorOccurred(QString msg);
+  void statusChanged(QString status);
+};
+
+#endif // INFERENCEBACKEND_H
@@ -1,17 +1,112 @@
+#include "guardiancore.h"
+#include "metrics.h"
+#ifndef GUARDIAN_HEADLESS_ONLY
 #include "mainwindow.h"
 #include <QApplication>
+#endif
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QSocketNotifier>
 #include <QTextCodec>
+#include <QTimer>
+#include <cstring>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+
+// SIGINT/SIGTERM 經 self-pipe 交給事件迴圈處理，讓 core 的解構子照常
+// 停止執行緒、關閉 GPIO (不用 signalfd：遮罩會被 python3 子行程繼承)
+static int s_signalPipe[2] = {-1, -1};
+
+static void handleQuitSignal(int) {
+  const char c = 1;
+  (void)!write(s_signalPipe[1], &c, 1);
+}
+
+static void quitOnSignals(QCoreApplication *app) {
+  if (pipe2(s_signalPipe, O_CLOEXEC | O_NONBLOCK) != 0)
+    return;
+  QSocketNotifier *notifier =
+      new QSocketNotifier(s_signalPipe[0], QSocketNotifier::Read, app);
+  QObject::connect(notifier, &QSocketNotifier::activated, app, []() {
+    char buf[16];
+    while (read(s_signalPipe[0], buf, sizeof(buf)) > 0)
+      ;
+    qDebug() << "收到結束訊號，正在關閉";
+    QCoreApplication::quit();
+  });
+
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = handleQuitSignal;
+  sigemptyset(&sa.sa_mask);
+  sa.sa_flags = SA_RESTART;
+  sigaction(SIGINT, &sa, nullptr);
+  sigaction(SIGTERM, &sa, nullptr);
+}
+
+// 從 main() 到事件迴圈開始處理事件的時間，比較無頭與 GUI 版本的啟動成本
+static void recordStartup(const QElapsedTimer &launch, const char *mode) {
+  QTimer::singleShot(0, [launch, mode]() {
+    const double seconds = launch.nsecsElapsed() / 1e9;
+    MetricsRegistry::instance()
+        .gauge("guardian_startup_seconds",
+               "Time from main() until the event loop is running",
+               QString("mode=\"%1\"").arg(mode))
+        .set(seconds);
+    qDebug() << "GuardianEye: 啟動完成 (" << mode << ")" << seconds * 1000
+             << "ms";
+  });
+}
 
 int main(int argc, char *argv[]) {
-  // 強制使用 xcb 平台插件，避免 Wayland 相關錯誤
-  qputenv("QT_QPA_PLATFORM", "xcb");
+  QElapsedTimer launch;
+  launch.start();
+
+  // --headless 或 GUARDIAN_HEADLESS=1：只建立 QCoreApplication，不需要顯示器
+  bool headless = qgetenv("GUARDIAN_HEADLESS") == "1";
+  for (int i = 1; i < argc; i++) {
+    if (qstrcmp(argv[i], "--headless") == 0)
+      headless = true;
+  }
+#ifdef GUARDIAN_HEADLESS_ONLY
+  headless = true;
+#endif
+
+  // 重播錄製檔量測時預設不驅動實體硬體 (可明確設定 GUARDIAN_HW 覆寫)
+  if (qEnvironmentVariableIsSet("GUARDIAN_AI_REPLAY") &&
+      !qEnvironmentVariableIsSet("GUARDIAN_HW"))
+    qputenv("GUARDIAN_HW", "sim");
 
   // 強制設定全局編碼為 UTF-8 (解決 Qt 5 在部分系統上的亂碼問題)
   QTextCodec *codec = QTextCodec::codecForName("UTF-8");
   QTextCodec::setCodecForLocale(codec);
 
+  if (headless) {
+    QCoreApplication a(argc, argv);
+    quitOnSignals(&a);
+    GuardianCore core;
+    core.start();
+    recordStartup(launch, "headless");
+    return a.exec();
+  }
+
+#ifndef GUARDIAN_HEADLESS_ONLY
+  // 預設使用 xcb 平台插件，避免 Wayland 相關錯誤；
+  // 已指定 QT_QPA_PLATFORM 時尊重設定 (例如無頭重播用 offscreen)
+  if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+    qputenv("QT_QPA_PLATFORM", "xcb");
+
   QApplication a(argc, argv);
-  MainWindow w;
+  quitOnSignals(&a);
+  GuardianCore core; // 先於視窗建立、晚於視窗釋放
+  MainWindow w(&core);
+  core.start();
   w.show();
+  recordStartup(launch, "gui");
   return a.exec();
+#else
+  return 0;
+#endif
 }
@@ -2,19 +2,11 @@
 #define MAINWINDOW_H
 
 #include <QElapsedTimer>
+#include <QImage>
 #include <QMainWindow>
-#include <QShortcut>
-#include <QStringList>
 #include <QStringListModel>
-#include <QThread>
-#include <QTimer>
 
-class PythonAiManager;
-class SecurityController;
-class EnvironmentalController;
-class BlackboxInterface;
-class Mcp3008Interface;
-class EmergencyController;
+class GuardianCore;
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -22,56 +14,40 @@ class MainWindow;
 }
 QT_END_NAMESPACE
 
+/**
+ * MainWindow
+ * GuardianCore 的本機用戶端：顯示預覽影格、狀態文字與黑盒子日誌，
+ * 快捷鍵與密碼輸入轉成 core 的動作。系統邏輯全部在 core，
+ * 視窗不存在時 (無頭模式) 行為相同
+ */
 class MainWindow : public QMainWindow {
   Q_OBJECT
 
 public:
-  MainWindow(QWidget *parent = nullptr);
+  explicit MainWindow(GuardianCore *core, QWidget *parent = nullptr);
   ~MainWindow();
 
 private slots:
   void updateFrame(QImage img);
   void handlePasswordInput();
-  void handleShortcut(int keyId);
-  void pollSensors();                   // 定期輪詢感測器
-  void simulateAiTrigger(QString type); // 新增：模擬 AI 觸發接口
-  void sendDiscordNotification(QString type,
-                               QString priority); // 新增：Discord 推播接口
-  void sendDiscordCode(QString code); // 新增：發送驗證碼到 Discord
-  void updateAlarmJsonWithCountdown(int seconds,
-                                    QString formatted); // 新增：同步倒數到 JSON
+  void showLogs(); // F3
 
 protected:
   void keyPressEvent(QKeyEvent *event) override; // 處理連按快捷鍵
   void closeEvent(QCloseEvent *event) override;  // 監控視窗關閉事件
+  void changeEvent(QEvent *event) override;      // 最小化時停止預覽影格
 
 private:
   Ui::MainWindow *ui;
-
-  // 核心硬體介面
-  BlackboxInterface *blackbox;
-  Mcp3008Interface *adc;
-
-  // 業務邏輯控制器
-  PythonAiManager *camera;
-  SecurityController *security;
-  EnvironmentalController *env;
-  EmergencyController *emergency;
+  GuardianCore *core;
 
   // UI 模型
   QStringListModel *eventModel;
-  QStringList m_logHistory;
-
-  // 執行緒管理
-  QThread *cameraThread;
-  QThread *logicThread; // 邏輯共用執行緒
-  bool m_isMuted = false;
-  bool m_isAutoLight = true;                // 是否為自動燈光模式
-  bool m_manualYellowLed = false;           // 手動模式下的黃燈狀態
-  QMap<QString, QDateTime> m_lastAlertTime; // 新增：紀錄上次各類警報的時間
-  QElapsedTimer m_f12Timer;                 // 用於偵測 F12 連按
+  QElapsedTimer m_f12Timer; // 用於偵測 F12 連按
 
   void setupShortcuts();
+  void showNonBlockingMessage(int icon, const QString &title,
+                              const QString &text);
 };
 
 #endif // MAINWINDOW_H
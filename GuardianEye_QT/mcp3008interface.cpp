@@ -1,26 +1,69 @@
 #include "mcp3008interface.h"
+#include "hardwareinterface.h"
+#include "metrics.h"
+#include "tracing.h"
 #include <QDebug>
+#include <QDir>
 #include <QFile>
 #include <QTextStream>
 #include <QThread>
+#include <cstring>
 #include <fcntl.h>
+#include <linux/gpio.h>
 #include <sys/ioctl.h>
+#include <time.h>
 #include <unistd.h>
 
+static qint64 monotonicNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return qint64(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+static MetricCounter &spiErrors() {
+  static MetricCounter &counter = MetricsRegistry::instance().counter(
+      "guardian_adc_spi_errors_total", "Failed MCP3008 SPI transfers");
+  return counter;
+}
+
 Mcp3008Interface::Mcp3008Interface(QObject *parent) : QObject(parent) {
+  // 模擬硬體時不碰 SPI/GPIO，readAdc() 一律回傳 -1 (與找不到裝置相同)
+  if (hardwareSimulated()) {
+    qDebug() << "Mcp3008Interface: 模擬硬體模式，不初始化 SPI";
+    return;
+  }
   initSpi();
 }
 
+Mcp3008Interface::Mcp3008Interface(int sckFd, int mosiFd, int misoFd,
+                                   int csFd, QObject *parent)
+    : QObject(parent), m_use_bitbang(true), m_fd_sck(sckFd),
+      m_fd_mosi(mosiFd), m_fd_miso(misoFd), m_fd_cs(csFd) {}
+
+Mcp3008Interface::Mcp3008Interface(int spiFd, QObject *parent)
+    : QObject(parent), m_spi_fd(spiFd) {}
+
+Mcp3008Interface::Mcp3008Interface(LineAbi abi, int outFd, int inFd,
+                                   QObject *parent)
+    : QObject(parent), m_use_bitbang(true), m_line_abi(abi),
+      m_line_fd(outFd), m_line_in_fd(inFd) {
+  calibrateSpin();
+}
+
 Mcp3008Interface::~Mcp3008Interface() {
   if (m_spi_fd >= 0)
     close(m_spi_fd);
+  if (m_line_fd >= 0)
+    close(m_line_fd);
+  if (m_line_in_fd >= 0)
+    close(m_line_in_fd);
 
   if (m_fd_sck >= 0) close(m_fd_sck);
   if (m_fd_mosi >= 0) close(m_fd_mosi);
   if (m_fd_miso >= 0) close(m_fd_miso);
   if (m_fd_cs >= 0) close(m_fd_cs);
 
-  if (m_use_bitbang) {
+  if (m_exported) {
     gpioUnexport(PIN_SCK);
     gpioUnexport(PIN_MISO);
     gpioUnexport(PIN_MOSI);
@@ -43,14 +86,24 @@ void Mcp3008Interface::initSpi() {
 
   // 2. 切換到 Bit-banging 模式
   m_use_bitbang = true;
-  qDebug() << "Mcp3008Interface: 使用 Bit-banging 模式 (CLK=427, MOSI=429, "
-              "MISO=428, CS=430)";
+
+  // 2a. 優先使用 gpiochip 字元裝置，免去 sysfs export 與逐腳位 pwrite
+  if (initGpioChip()) {
+    qDebug() << "Mcp3008Interface: 使用 gpiochip"
+             << (m_line_abi == LineAbi::V2 ? "v2" : "v1") << "Bit-banging 模式";
+    return;
+  }
+
+  // 2b. 退回已棄用的 sysfs GPIO 介面
+  qDebug() << "Mcp3008Interface: gpiochip 字元裝置不可用，改用 sysfs "
+              "Bit-banging 模式 (CLK=427, MOSI=429, MISO=428, CS=430)";
 
   int pins[] = {PIN_SCK, PIN_MISO, PIN_MOSI, PIN_CS};
   for (int pin : pins) {
     gpioExport(pin);
     QThread::msleep(50); // 給核心一點時間建立檔案節點
   }
+  m_exported = true;
 
   if (gpioSetDirection(PIN_SCK, true) && gpioSetDirection(PIN_MOSI, true) &&
       gpioSetDirection(PIN_CS, true) && gpioSetDirection(PIN_MISO, false)) {
@@ -69,7 +122,254 @@ void Mcp3008Interface::initSpi() {
   }
 }
 
+// 透過 /sys/class/gpio/gpiochipN 的 base/ngpio/label 將全域 GPIO 編號
+// 對應到 /dev/gpiochipM 的 line offset，再以 line request 取得四支腳位
+// (優先 v2；核心或標頭不支援時改用 v1 handle request)
+bool Mcp3008Interface::initGpioChip() {
+  const int pins[] = {PIN_SCK, PIN_MOSI, PIN_CS, PIN_MISO};
+
+  QDir sysDir("/sys/class/gpio");
+  const QStringList sysChips =
+      sysDir.entryList(QStringList() << "gpiochip*", QDir::Dirs | QDir::System);
+  QDir devDir("/dev");
+  const QStringList devChips =
+      devDir.entryList(QStringList() << "gpiochip*", QDir::System);
+
+  for (const QString &sysChip : sysChips) {
+    auto readAttr = [&](const char *name) {
+      QFile f(sysDir.absoluteFilePath(sysChip + "/" + name));
+      if (!f.open(QIODevice::ReadOnly))
+        return QByteArray();
+      return f.readAll().trimmed();
+    };
+    int base = readAttr("base").toInt();
+    int ngpio = readAttr("ngpio").toInt();
+    QByteArray label = readAttr("label");
+
+    bool allInside = true;
+    for (int pin : pins)
+      allInside = allInside && pin >= base && pin < base + ngpio;
+    if (!allInside)
+      continue;
+
+    for (const QString &devChip : devChips) {
+      int chipFd =
+          open(devDir.absoluteFilePath(devChip).toUtf8().constData(), O_RDONLY);
+      if (chipFd < 0)
+        continue;
+
+      struct gpiochip_info info;
+      memset(&info, 0, sizeof(info));
+      if (ioctl(chipFd, GPIO_GET_CHIPINFO_IOCTL, &info) < 0 ||
+          label != info.label || int(info.lines) != ngpio) {
+        close(chipFd);
+        continue;
+      }
+
+      int offsets[4];
+      for (int i = 0; i < 4; i++)
+        offsets[i] = pins[i] - base;
+      const bool ok =
+          requestLinesV2(chipFd, offsets) || requestLinesV1(chipFd, offsets);
+      close(chipFd);
+      if (!ok) {
+        qDebug() << "Mcp3008Interface: gpiochip line request 失敗:" << devChip;
+        return false;
+      }
+
+      calibrateSpin();
+      qDebug() << "Mcp3008Interface: gpiochip" << devChip << "(" << label
+               << ") base" << base << "spins/us" << m_spins_per_us;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Mcp3008Interface::requestLinesV2(int chipFd, const int *offsets) {
+#ifdef GPIO_V2_LINES_MAX
+  struct gpio_v2_line_request req;
+  memset(&req, 0, sizeof(req));
+  for (int i = 0; i < 4; i++)
+    req.offsets[i] = offsets[i];
+  req.num_lines = 4;
+  strncpy(req.consumer, "guardianeye-mcp3008", sizeof(req.consumer) - 1);
+
+  // 預設為輸出；line 3 (MISO) 改為輸入；初始值 CS=1, SCK=0, MOSI=0
+  req.config.flags = GPIO_V2_LINE_FLAG_OUTPUT;
+  req.config.num_attrs = 2;
+  req.config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_FLAGS;
+  req.config.attrs[0].attr.flags = GPIO_V2_LINE_FLAG_INPUT;
+  req.config.attrs[0].mask = 1ULL << 3;
+  req.config.attrs[1].attr.id = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+  req.config.attrs[1].attr.values = 1ULL << 2;
+  req.config.attrs[1].mask = 0x7;
+
+  // 核心早於 5.10 時回傳 ENOTTY/EINVAL，由呼叫端改用 v1
+  if (ioctl(chipFd, GPIO_V2_GET_LINE_IOCTL, &req) < 0)
+    return false;
+  m_line_abi = LineAbi::V2;
+  m_line_fd = req.fd;
+  return true;
+#else
+  Q_UNUSED(chipFd);
+  Q_UNUSED(offsets);
+  return false;
+#endif
+}
+
+bool Mcp3008Interface::requestLinesV1(int chipFd, const int *offsets) {
+  // v1 的 handle 內所有 line 方向相同：SCK/MOSI/CS 輸出一個、MISO 輸入一個
+  struct gpiohandle_request out;
+  memset(&out, 0, sizeof(out));
+  for (int i = 0; i < 3; i++)
+    out.lineoffsets[i] = offsets[i];
+  out.lines = 3;
+  out.flags = GPIOHANDLE_REQUEST_OUTPUT;
+  out.default_values[2] = 1; // CS=1
+  strncpy(out.consumer_label, "guardianeye-mcp3008",
+          sizeof(out.consumer_label) - 1);
+  if (ioctl(chipFd, GPIO_GET_LINEHANDLE_IOCTL, &out) < 0)
+    return false;
+
+  struct gpiohandle_request in;
+  memset(&in, 0, sizeof(in));
+  in.lineoffsets[0] = offsets[3];
+  in.lines = 1;
+  in.flags = GPIOHANDLE_REQUEST_INPUT;
+  strncpy(in.consumer_label, "guardianeye-mcp3008",
+          sizeof(in.consumer_label) - 1);
+  if (ioctl(chipFd, GPIO_GET_LINEHANDLE_IOCTL, &in) < 0) {
+    close(out.fd);
+    return false;
+  }
+
+  m_line_abi = LineAbi::V1;
+  m_line_fd = out.fd;
+  m_line_in_fd = in.fd;
+  m_line_out = 1ULL << 2;
+  return true;
+}
+
+// 校正 busy-wait：量測固定迴圈次數所花的時間
+void Mcp3008Interface::calibrateSpin() {
+  const long calibLoops = 1000000;
+  qint64 t0 = monotonicNs();
+  for (volatile long i = 0; i < calibLoops; i++) {
+  }
+  qint64 elapsed = monotonicNs() - t0;
+  m_spins_per_us = elapsed > 0 ? calibLoops * 1000 / elapsed : 1;
+  if (m_spins_per_us < 1)
+    m_spins_per_us = 1;
+}
+
+void Mcp3008Interface::spinDelay() {
+  // MCP3008 在 2.7V 下最高 1.35 MHz，半週期約 0.4us，1us 已足夠保守
+  for (volatile long i = 0; i < m_spins_per_us; i++) {
+  }
+}
+
+bool Mcp3008Interface::lineSetValues(quint64 bits, quint64 mask) {
+  if (m_line_abi == LineAbi::V1) {
+    struct gpiohandle_data data;
+    memset(&data, 0, sizeof(data));
+    m_line_out = (m_line_out & ~mask) | (bits & mask);
+    for (int i = 0; i < 3; i++)
+      data.values[i] = (m_line_out >> i) & 1;
+    return ioctl(m_line_fd, GPIOHANDLE_SET_LINE_VALUES_IOCTL, &data) >= 0;
+  }
+#ifdef GPIO_V2_LINES_MAX
+  struct gpio_v2_line_values v;
+  v.bits = bits;
+  v.mask = mask;
+  return ioctl(m_line_fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &v) >= 0;
+#else
+  return false;
+#endif
+}
+
+// 回傳的 bits 與 request 內的 line 索引相同 (MISO 為 bit 3)
+bool Mcp3008Interface::lineGetValues(quint64 mask, quint64 *bits) {
+  if (m_line_abi == LineAbi::V1) {
+    struct gpiohandle_data data;
+    memset(&data, 0, sizeof(data));
+    if (ioctl(m_line_in_fd, GPIOHANDLE_GET_LINE_VALUES_IOCTL, &data) < 0)
+      return false;
+    *bits = (quint64(data.values[0] & 1) << 3) & mask;
+    return true;
+  }
+#ifdef GPIO_V2_LINES_MAX
+  struct gpio_v2_line_values v;
+  v.bits = 0;
+  v.mask = mask;
+  if (ioctl(m_line_fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &v) < 0)
+    return false;
+  *bits = v.bits;
+  return true;
+#else
+  Q_UNUSED(mask);
+  Q_UNUSED(bits);
+  return false;
+#endif
+}
+
+// 與 readAdcBitBang 相同的時序，但每個時脈邊緣 (含資料位元) 只需一次 ioctl
+int Mcp3008Interface::readAdcGpioChip(int adcnum) {
+  // request 內的 line 索引
+  const quint64 SCK = 1ULL << 0;
+  const quint64 MOSI = 1ULL << 1;
+  const quint64 CS = 1ULL << 2;
+  const quint64 MISO = 1ULL << 3;
+  const quint64 OUT_MASK = SCK | MOSI | CS;
+
+  if (!lineSetValues(CS, OUT_MASK)) // CS=1, SCK=0
+    return -1;
+  spinDelay();
+  lineSetValues(0, OUT_MASK); // CS=0 開始傳輸
+  spinDelay();
+
+  int commandout = adcnum;
+  commandout |= 0x18; // Start bit + Single-ended bit
+  commandout <<= 3;
+
+  // 送出 5 bits 指令：資料與 SCK 下緣同一次 ioctl，接著拉高 SCK
+  for (int i = 0; i < 5; i++) {
+    quint64 mosi = (commandout & 0x80) ? MOSI : 0;
+    commandout <<= 1;
+    lineSetValues(mosi, SCK | MOSI);
+    spinDelay();
+    lineSetValues(SCK | mosi, SCK | MOSI);
+    spinDelay();
+  }
+
+  lineSetValues(0, SCK);
+
+  // 讀取 12 bits (包含 1 個 null bit)
+  int adcout = 0;
+  for (int i = 0; i < 12; i++) {
+    lineSetValues(SCK, SCK);
+    spinDelay();
+    lineSetValues(0, SCK);
+    spinDelay();
+    quint64 bits = 0;
+    if (!lineGetValues(MISO, &bits))
+      return -1;
+    adcout <<= 1;
+    if (bits & MISO)
+      adcout |= 0x1;
+  }
+
+  lineSetValues(CS, CS | SCK); // 結束傳輸
+  adcout >>= 1;
+  return adcout;
+}
+
 int Mcp3008Interface::readAdc(int channel) {
+  static MetricHistogram &latency = MetricsRegistry::instance().histogram(
+      "guardian_adc_read_seconds", "MCP3008 read latency", "op=\"single\"");
+  MetricTimer timer(latency);
+  TRACE_SCOPE("adc.read");
+
   if (m_use_bitbang) {
     return readAdcBitBang(channel);
   }
@@ -84,23 +384,124 @@ int Mcp3008Interface::readAdc(int channel) {
       .tx_buf = (unsigned long)tx,
       .rx_buf = (unsigned long)rx,
       .len = 3,
-      .speed_hz = 1000000,
+      .speed_hz = m_speed_hz,
       .delay_usecs = 0,
       .bits_per_word = 8,
   };
 
   if (ioctl(m_spi_fd, SPI_IOC_MESSAGE(1), &tr) < 1) {
+    spiErrors().inc();
     return -1;
   }
 
   return ((rx[1] & 3) << 8) + rx[2];
 }
 
+QVector<AdcSample> Mcp3008Interface::scanChannels(quint8 channelMask,
+                                                 int oversample) {
+  static MetricHistogram &latency = MetricsRegistry::instance().histogram(
+      "guardian_adc_read_seconds", "MCP3008 read latency", "op=\"scan\"");
+  MetricTimer timer(latency);
+  TRACE_SCOPE("adc.scan");
+
+  QVector<AdcSample> samples;
+  if (oversample < 1)
+    oversample = 1;
+  if (oversample > MAX_OVERSAMPLE)
+    oversample = MAX_OVERSAMPLE;
+
+  int channels[8];
+  int count = 0;
+  for (int ch = 0; ch < 8; ch++) {
+    if (channelMask & (1 << ch))
+      channels[count++] = ch;
+  }
+  if (count == 0)
+    return samples;
+  samples.resize(count);
+
+  // Bit-bang 模式沒有批次傳輸，逐一讀取但仍回傳相同格式
+  if (m_use_bitbang) {
+    for (int i = 0; i < count; i++) {
+      int sum = 0;
+      bool ok = true;
+      for (int n = 0; n < oversample && ok; n++) {
+        int v = readAdcBitBang(channels[i]);
+        ok = v >= 0;
+        sum += v;
+      }
+      samples[i].channel = channels[i];
+      samples[i].value = ok ? (sum + oversample / 2) / oversample : -1;
+      samples[i].timestampNs = monotonicNs();
+    }
+    return samples;
+  }
+
+  for (int i = 0; i < count; i++)
+    samples[i].channel = channels[i];
+  if (m_spi_fd < 0)
+    return samples;
+
+  // 每次轉換一個 3-byte transfer，每 MAX_XFERS_PER_MESSAGE 個串成一個
+  // SPI_IOC_MESSAGE；cs_change 讓 CS 在每次轉換之間拉高，MCP3008 才會重新
+  // 取樣 (每個 message 的最後一個 transfer 不設，message 結束時 CS 自然拉高)
+  const int total = count * oversample;
+  m_xfers.resize(total);
+  m_tx.resize(total * 3);
+  m_rx.resize(total * 3);
+  memset(m_xfers.data(), 0, total * sizeof(struct spi_ioc_transfer));
+
+  for (int i = 0; i < count; i++) {
+    for (int n = 0; n < oversample; n++) {
+      int idx = i * oversample + n;
+      uint8_t *tx = &m_tx[idx * 3];
+      tx[0] = 0x01;
+      tx[1] = static_cast<uint8_t>((8 + channels[i]) << 4);
+      tx[2] = 0x00;
+
+      struct spi_ioc_transfer &tr = m_xfers[idx];
+      tr.tx_buf = (unsigned long)tx;
+      tr.rx_buf = (unsigned long)&m_rx[idx * 3];
+      tr.len = 3;
+      tr.speed_hz = m_speed_hz;
+      tr.bits_per_word = 8;
+      const bool lastInMessage = (idx + 1) % MAX_XFERS_PER_MESSAGE == 0;
+      tr.cs_change = (idx != total - 1 && !lastInMessage) ? 1 : 0;
+    }
+  }
+
+  qint64 t0 = monotonicNs();
+  for (int first = 0; first < total; first += MAX_XFERS_PER_MESSAGE) {
+    const int n = qMin(MAX_XFERS_PER_MESSAGE, total - first);
+    if (ioctl(m_spi_fd, SPI_IOC_MESSAGE(n), &m_xfers[first]) < 1) {
+      spiErrors().inc();
+      return samples;
+    }
+  }
+  qint64 t1 = monotonicNs();
+
+  // 依傳輸順序內插每個通道的取樣時間 (取該通道轉換區段的中點)
+  for (int i = 0; i < count; i++) {
+    int sum = 0;
+    for (int n = 0; n < oversample; n++) {
+      const uint8_t *rx = &m_rx[(i * oversample + n) * 3];
+      sum += ((rx[1] & 3) << 8) + rx[2];
+    }
+    samples[i].value = (sum + oversample / 2) / oversample;
+    samples[i].timestampNs =
+        t0 + (t1 - t0) * (2 * i * oversample + oversample) / (2 * total);
+  }
+  return samples;
+}
+
 // 強化版 Bit-banging，加入微秒延遲確保穩定
 int Mcp3008Interface::readAdcBitBang(int adcnum) {
   if (adcnum > 7 || adcnum < 0)
     return -1;
 
+  if (m_line_fd >= 0)
+    return readAdcGpioChip(adcnum);
+
   auto delay = []() { usleep(2); }; 
 
   auto fastSet = [](int fd, int val) {
@@ -2,19 +2,65 @@
 #define MCP3008INTERFACE_H
 
 #include <QObject>
+#include <QVector>
 #include <linux/spi/spidev.h>
+#include <vector>
+
+// 單一通道的取樣結果 (timestampNs 為 CLOCK_MONOTONIC)
+struct AdcSample {
+  int channel = -1;
+  int value = -1; // 超取樣平均後的 10-bit 數值，失敗為 -1
+  qint64 timestampNs = 0;
+};
 
 class Mcp3008Interface : public QObject {
   Q_OBJECT
 public:
   explicit Mcp3008Interface(QObject *parent = nullptr);
+  // 不開啟任何硬體，以呼叫端提供的 sysfs value 描述符做 bit-bang
+  // (模擬 GPIO 的效能量測用)；描述符由本物件關閉，不會 unexport 腳位
+  Mcp3008Interface(int sckFd, int mosiFd, int misoFd, int csFd,
+                   QObject *parent = nullptr);
+  // 不開啟任何硬體，以呼叫端提供的 spidev 描述符傳輸 (模擬 spidev 的測試用)；
+  // 描述符由本物件關閉
+  explicit Mcp3008Interface(int spiFd, QObject *parent = nullptr);
+
+  // gpiochip 字元裝置的 line request ABI：v2 (Linux 5.10+) 以一個 request
+  // 取得四條 line；v1 (Linux 4.8+，TX2 的 4.9) 輸出與輸入各一個 handle
+  enum class LineAbi { V1, V2 };
+  // 以呼叫端提供的 line 描述符做 bit-bang (模擬 gpiochip 的測試用)：
+  // V2 時 outFd 為 SCK/MOSI/CS/MISO 的 request、inFd 為 -1；
+  // V1 時 outFd 為 SCK/MOSI/CS、inFd 為 MISO。描述符由本物件關閉
+  Mcp3008Interface(LineAbi abi, int outFd, int inFd,
+                   QObject *parent = nullptr);
   ~Mcp3008Interface();
 
   int readAdc(int channel);
 
+  // 以 SPI_IOC_MESSAGE 掃描 channelMask 中的所有通道 (bit N = 通道 N)，
+  // 每個通道連續轉換 oversample 次後取平均；轉換次數超過
+  // MAX_XFERS_PER_MESSAGE 時分成多次 ioctl
+  QVector<AdcSample> scanChannels(quint8 channelMask, int oversample = 1);
+
+  void setSpeedHz(quint32 hz) { m_speed_hz = hz; }
+  quint32 speedHz() const { return m_speed_hz; }
+
+  static const int MAX_OVERSAMPLE = 64;
+  // SPI_IOC_MESSAGE(n) 把 n 個 transfer 的大小編在 ioctl 編號的 14-bit 欄位：
+  // 512 個 (16384 bytes) 就溢位成 0。511 個 transfer 共 1533 bytes，
+  // 也在 spidev 預設 bufsiz (4096) 之內
+  static const int MAX_XFERS_PER_MESSAGE = 511;
+
 private:
   int m_spi_fd = -1;
   bool m_use_bitbang = false;
+  bool m_exported = false; // 由本物件 export 的 sysfs 腳位，解構時 unexport
+  quint32 m_speed_hz = 1000000;
+
+  // scanChannels 重複使用的傳輸緩衝區，避免每次掃描配置記憶體
+  std::vector<struct spi_ioc_transfer> m_xfers;
+  std::vector<uint8_t> m_tx;
+  std::vector<uint8_t> m_rx;
 
   // SPI Bit-banging 腳位 (根據你的圖片與成功經驗修正)
   const int PIN_SCK = 427;  // Pin 23 (SPI_SCLK)
@@ -23,6 +69,22 @@ private:
   const int PIN_CS = 430;   // Pin 24 (SPI_CE0_N)
 
   void initSpi();
+  bool initGpioChip();
+
+  // gpiochip 後端：SCK/MOSI/CS 為 line 0..2，一次 ioctl 即可同時設定時脈
+  // 與資料；v2 的 MISO 為同一個 request 的 line 3，v1 則另有輸入 handle
+  LineAbi m_line_abi = LineAbi::V2;
+  int m_line_fd = -1;
+  int m_line_in_fd = -1; // 只有 v1 使用
+  quint64 m_line_out = 0; // v1 沒有 mask，記住目前的輸出值
+  long m_spins_per_us = 0; // busy-wait 校正值
+  bool requestLinesV2(int chipFd, const int *offsets);
+  bool requestLinesV1(int chipFd, const int *offsets);
+  void calibrateSpin();
+  int readAdcGpioChip(int channel);
+  bool lineSetValues(quint64 bits, quint64 mask);
+  bool lineGetValues(quint64 mask, quint64 *bits);
+  void spinDelay();
 
   // Bit-banging 輔助函數
   int readAdcBitBang(int channel);
@@ -0,0 +1,245 @@
+#include "metrics.h"
+#include <QJsonObject>
+#include <QMap>
+#include <QMutexLocker>
+
+MetricHistogram::MetricHistogram(const std::vector<double> &bounds)
+    : m_bounds(bounds), m_buckets(new std::atomic<quint64>[bounds.size() + 1]) {
+  for (size_t i = 0; i <= m_bounds.size(); i++)
+    m_buckets[i].store(0, std::memory_order_relaxed);
+}
+
+quint64 MetricHistogram::count() const {
+  quint64 total = 0;
+  for (size_t i = 0; i <= m_bounds.size(); i++)
+    total += bucket(i);
+  return total;
+}
+
+double MetricHistogram::quantile(double q) const {
+  const quint64 total = count();
+  if (total == 0 || m_bounds.empty())
+    return 0;
+  const quint64 rank = quint64(q * double(total - 1)) + 1;
+  quint64 seen = 0;
+  for (size_t i = 0; i < m_bounds.size(); i++) {
+    seen += bucket(i);
+    if (seen >= rank)
+      return m_bounds[i];
+  }
+  return m_bounds.back();
+}
+
+MetricsRegistry &MetricsRegistry::instance() {
+  static MetricsRegistry registry;
+  return registry;
+}
+
+std::vector<double> MetricsRegistry::latencyBuckets() {
+  return {0.00001, 0.000025, 0.00005, 0.0001, 0.00025, 0.0005, 0.001,
+          0.0025,  0.005,    0.01,    0.025,  0.05,    0.1,    0.25,
+          0.5,     1.0,      2.5};
+}
+
+MetricsRegistry::Entry *MetricsRegistry::find(const QString &name,
+                                              const QString &labels,
+                                              Type type) {
+  for (Entry &e : m_entries) {
+    if (e.name == name && e.labels == labels)
+      return e.type == type ? &e : nullptr;
+  }
+  Entry e;
+  e.name = name;
+  e.labels = labels;
+  e.type = type;
+  m_entries.push_back(std::move(e));
+  return &m_entries.back();
+}
+
+MetricCounter &MetricsRegistry::counter(const QString &name,
+                                        const QString &help,
+                                        const QString &labels) {
+  QMutexLocker locker(&m_mutex);
+  Entry *e = find(name, labels, Counter);
+  if (!e)
+    qFatal("MetricsRegistry: %s registered with another type",
+           qPrintable(name));
+  if (!e->counter) {
+    e->help = help;
+    e->counter.reset(new MetricCounter);
+  }
+  return *e->counter;
+}
+
+MetricGauge &MetricsRegistry::gauge(const QString &name, const QString &help,
+                                    const QString &labels) {
+  QMutexLocker locker(&m_mutex);
+  Entry *e = find(name, labels, Gauge);
+  if (!e)
+    qFatal("MetricsRegistry: %s registered with another type",
+           qPrintable(name));
+  if (!e->gauge) {
+    e->help = help;
+    e->gauge.reset(new MetricGauge);
+  }
+  return *e->gauge;
+}
+
+MetricHistogram &MetricsRegistry::histogram(const QString &name,
+                                            const QString &help,
+                                            const QString &labels,
+                                            const std::vector<double> &bounds) {
+  QMutexLocker locker(&m_mutex);
+  Entry *e = find(name, labels, Histogram);
+  if (!e)
+    qFatal("MetricsRegistry: %s registered with another type",
+           qPrintable(name));
+  if (!e->histogram) {
+    e->help = help;
+    e->histogram.reset(new MetricHistogram(bounds));
+  }
+  return *e->histogram;
+}
+
+static QByteArray withLabels(const QString &name, const QString &labels,
+                             const QString &extra = QString()) {
+  QString all = labels;
+  if (!extra.isEmpty())
+    all = all.isEmpty() ? extra : all + "," + extra;
+  return (all.isEmpty() ? name : name + "{" + all + "}").toUtf8();
+}
+
+QByteArray MetricsRegistry::prometheusText() const {
+  QMutexLocker locker(&m_mutex);
+
+  // 同名指標 (不同 labels) 必須連續輸出，HELP/TYPE 各一次
+  QMap<QString, QList<const Entry *>> families;
+  for (const Entry &e : m_entries)
+    families[e.name].append(&e);
+
+  static const char *const TYPE_NAMES[] = {"counter", "gauge", "histogram"};
+  QByteArray out;
+  out.reserve(8192);
+  for (auto it = families.constBegin(); it != families.constEnd(); ++it) {
+    const Entry *first = it.value().first();
+    out += "# HELP " + first->name.toUtf8() + " " + first->help.toUtf8() + "\n";
+    out += "# TYPE " + first->name.toUtf8() + " " + TYPE_NAMES[first->type] +
+           "\n";
+    for (const Entry *e : it.value()) {
+      switch (e->type) {
+      case Counter:
+        out += withLabels(e->name, e->labels) + " " +
+               QByteArray::number(e->counter->value()) + "\n";
+        break;
+      case Gauge:
+        out += withLabels(e->name, e->labels) + " " +
+               QByteArray::number(e->gauge->value(), 'g', 10) + "\n";
+        break;
+      case Histogram: {
+        const MetricHistogram &h = *e->histogram;
+        quint64 cumulative = 0;
+        for (size_t i = 0; i < h.bounds().size(); i++) {
+          cumulative += h.bucket(i);
+          out += withLabels(e->name + "_bucket", e->labels,
+                            QString("le=\"%1\"").arg(h.bounds()[i])) +
+                 " " + QByteArray::number(cumulative) + "\n";
+        }
+        cumulative += h.bucket(h.bounds().size());
+        out += withLabels(e->name + "_bucket", e->labels, "le=\"+Inf\"") +
+               " " + QByteArray::number(cumulative) + "\n";
+        out += withLabels(e->name + "_sum", e->labels) + " " +
+               QByteArray::number(h.sum(), 'g', 10) + "\n";
+        out += withLabels(e->name + "_count", e->labels) + " " +
+               QByteArray::number(cumulative) + "\n";
+        break;
+      }
+      }
+    }
+  }
+  return out;
+}
+
+QStringList MetricsRegistry::summary(int maxLineBytes) const {
+  QMutexLocker locker(&m_mutex);
+
+  QStringList lines;
+  QString line;
+  for (const Entry &e : m_entries) {
+    QString item;
+    QString name = e.name;
+    if (name.startsWith("guardian_"))
+      name = name.mid(9);
+    if (!e.labels.isEmpty())
+      name += "{" + QString(e.labels).remove('"') + "}";
+
+    switch (e.type) {
+    case Counter:
+      if (e.counter->value() == 0)
+        continue;
+      item = QString("%1=%2").arg(name).arg(e.counter->value());
+      break;
+    case Gauge:
+      if (e.gauge->value() == 0)
+        continue;
+      item = QString("%1=%2").arg(name).arg(e.gauge->value());
+      break;
+    case Histogram: {
+      const quint64 n = e.histogram->count();
+      if (n == 0)
+        continue;
+      // 延遲以 ms 呈現較易讀
+      item = QString("%1:n=%2,p50=%3ms,p99=%4ms")
+                 .arg(name)
+                 .arg(n)
+                 .arg(e.histogram->quantile(0.5) * 1000)
+                 .arg(e.histogram->quantile(0.99) * 1000);
+      break;
+    }
+    }
+
+    if (!line.isEmpty() &&
+        line.toUtf8().size() + 1 + item.toUtf8().size() > maxLineBytes) {
+      lines.append(line);
+      line.clear();
+    }
+    line = line.isEmpty() ? item : line + " " + item;
+  }
+  if (!line.isEmpty())
+    lines.append(line);
+  return lines;
+}
+
+QJsonObject MetricsRegistry::toJson() const {
+  QMutexLocker locker(&m_mutex);
+
+  QJsonObject counters, gauges, histograms;
+  for (const Entry &e : m_entries) {
+    const QString key =
+        e.labels.isEmpty() ? e.name : e.name + "{" + e.labels + "}";
+    switch (e.type) {
+    case Counter:
+      if (e.counter->value() != 0)
+        counters.insert(key, double(e.counter->value()));
+      break;
+    case Gauge:
+      if (e.gauge->value() != 0)
+        gauges.insert(key, e.gauge->value());
+      break;
+    case Histogram: {
+      const quint64 n = e.histogram->count();
+      if (n == 0)
+        continue;
+      // 平均值由 sum 精確計算；分位數為桶上限近似
+      histograms.insert(
+          key, QJsonObject{{"count", double(n)},
+                           {"mean_ms", e.histogram->sum() / n * 1000},
+                           {"p50_ms", e.histogram->quantile(0.5) * 1000},
+                           {"p90_ms", e.histogram->quantile(0.9) * 1000},
+                           {"p99_ms", e.histogram->quantile(0.99) * 1000}});
+      break;
+    }
+    }
+  }
+  return QJsonObject{
+      {"counters", counters}, {"gauges", gauges}, {"histograms", histograms}};
+}
@@ -0,0 +1,136 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <vector>
+
+/**
+ * 執行期指標：counter / gauge / 固定桶 histogram
+ * 更新只做 relaxed 原子操作，不上鎖、不配置記憶體，可放在影格與 ioctl 熱路徑；
+ * 只有註冊與匯出 (Prometheus 文字格式、黑盒子摘要) 會取得 registry 的鎖。
+ * 指標物件在行程結束前不會釋放，呼叫端可長期保存參照 (通常用函式內 static)
+ */
+class MetricCounter {
+public:
+  void inc(quint64 n = 1) { m_value.fetch_add(n, std::memory_order_relaxed); }
+  quint64 value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+  alignas(64) std::atomic<quint64> m_value{0};
+};
+
+class MetricGauge {
+public:
+  void set(double v) { m_value.store(v, std::memory_order_relaxed); }
+  void add(double d) {
+    double cur = m_value.load(std::memory_order_relaxed);
+    while (!m_value.compare_exchange_weak(cur, cur + d,
+                                          std::memory_order_relaxed))
+      ;
+  }
+  double value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+  alignas(64) std::atomic<double> m_value{0};
+};
+
+class MetricHistogram {
+public:
+  // bounds 為各桶上限 (遞增)，另有一個隱含的 +Inf 桶
+  explicit MetricHistogram(const std::vector<double> &bounds);
+
+  void observe(double v) {
+    size_t i = 0;
+    while (i < m_bounds.size() && v > m_bounds[i])
+      i++;
+    m_buckets[i].fetch_add(1, std::memory_order_relaxed);
+    double cur = m_sum.load(std::memory_order_relaxed);
+    while (!m_sum.compare_exchange_weak(cur, cur + v,
+                                        std::memory_order_relaxed))
+      ;
+  }
+
+  const std::vector<double> &bounds() const { return m_bounds; }
+  quint64 bucket(size_t i) const {
+    return m_buckets[i].load(std::memory_order_relaxed);
+  }
+  quint64 count() const;
+  double sum() const { return m_sum.load(std::memory_order_relaxed); }
+  // 以桶上限近似的分位數 (落在 +Inf 桶時回傳最後一個上限)
+  double quantile(double q) const;
+
+private:
+  std::vector<double> m_bounds;
+  std::unique_ptr<std::atomic<quint64>[]> m_buckets;
+  std::atomic<double> m_sum{0};
+};
+
+// 作用域計時：解構時以秒為單位記入 histogram
+class MetricTimer {
+public:
+  explicit MetricTimer(MetricHistogram &histogram)
+      : m_histogram(histogram), m_start(std::chrono::steady_clock::now()) {}
+  ~MetricTimer() {
+    m_histogram.observe(std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - m_start)
+                            .count());
+  }
+
+private:
+  MetricHistogram &m_histogram;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+class MetricsRegistry {
+public:
+  static MetricsRegistry &instance();
+
+  // 同名且同 labels 會回傳同一個物件；labels 格式為 key="value",key2="v2"
+  MetricCounter &counter(const QString &name, const QString &help,
+                         const QString &labels = QString());
+  MetricGauge &gauge(const QString &name, const QString &help,
+                     const QString &labels = QString());
+  MetricHistogram &histogram(const QString &name, const QString &help,
+                             const QString &labels = QString(),
+                             const std::vector<double> &bounds =
+                                 latencyBuckets());
+
+  // 10us ~ 2.5s，適用 ioctl/SPI/解碼/繪圖等延遲
+  static std::vector<double> latencyBuckets();
+
+  QByteArray prometheusText() const;
+  // 給黑盒子的精簡摘要：略過為 0 的指標，每行不超過 maxLineBytes
+  QStringList summary(int maxLineBytes) const;
+  // 重播報告用：{"counters":{...},"gauges":{...},"histograms":{name:{count,
+  // mean_ms,p50_ms,p90_ms,p99_ms}}}，鍵為 name{labels}，同樣略過為 0 的指標
+  QJsonObject toJson() const;
+
+private:
+  MetricsRegistry() = default;
+
+  enum Type { Counter, Gauge, Histogram };
+  struct Entry {
+    QString name;
+    QString help;
+    QString labels;
+    Type type;
+    std::unique_ptr<MetricCounter> counter;
+    std::unique_ptr<MetricGauge> gauge;
+    std::unique_ptr<MetricHistogram> histogram;
+  };
+
+  mutable QMutex m_mutex;
+  std::deque<Entry> m_entries; // deque：新增不會搬移既有元素
+
+  Entry *find(const QString &name, const QString &labels, Type type);
+};
+
+#endif // METRICS_H
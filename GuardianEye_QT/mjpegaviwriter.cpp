@@ -0,0 +1,171 @@
+#include "mjpegaviwriter.h"
+#include <QDebug>
+#include <QtEndian>
+
+// 檔頭固定長度：RIFF(12) + hdrl LIST(8 + 192) + movi LIST 標頭(12)
+static const int HEADER_BYTES = 224;
+static const int MOVI_FOURCC_OFFSET = 220;
+static const quint32 AVIF_HASINDEX = 0x10;
+static const quint32 AVIIF_KEYFRAME = 0x10;
+
+static void putFourCC(QByteArray &out, const char *fourcc) {
+  out.append(fourcc, 4);
+}
+
+static void put32(QByteArray &out, quint32 v) {
+  char b[4];
+  qToLittleEndian(v, reinterpret_cast<uchar *>(b));
+  out.append(b, 4);
+}
+
+static void put16(QByteArray &out, quint16 v) {
+  char b[2];
+  qToLittleEndian(v, reinterpret_cast<uchar *>(b));
+  out.append(b, 2);
+}
+
+bool MjpegAviWriter::open(const QString &path, int width, int height) {
+  close(0);
+  m_file.setFileName(path);
+  if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    qDebug() << "MjpegAviWriter: 無法建立" << path << m_file.errorString();
+    return false;
+  }
+  m_width = width;
+  m_height = height;
+  m_maxFrameBytes = 0;
+  m_index.clear();
+  // 先寫入佔位檔頭，close() 時回填影格數與大小
+  return m_file.write(buildHeaders(0, 4)) == HEADER_BYTES;
+}
+
+bool MjpegAviWriter::writeFrame(const QByteArray &jpeg) {
+  if (!m_file.isOpen() || jpeg.isEmpty())
+    return false;
+
+  IndexEntry entry;
+  entry.offset = quint32(m_file.pos() - MOVI_FOURCC_OFFSET);
+  entry.size = quint32(jpeg.size());
+
+  QByteArray chunk;
+  chunk.reserve(8);
+  putFourCC(chunk, "00dc");
+  put32(chunk, entry.size);
+  if (m_file.write(chunk) != chunk.size() ||
+      m_file.write(jpeg) != jpeg.size())
+    return false;
+  if (jpeg.size() & 1)
+    m_file.putChar(0); // RIFF chunk 需對齊 2 bytes
+
+  m_index.append(entry);
+  m_maxFrameBytes = qMax(m_maxFrameBytes, entry.size);
+  return true;
+}
+
+bool MjpegAviWriter::close(double fps) {
+  if (!m_file.isOpen())
+    return false;
+
+  const quint32 moviBytes = quint32(m_file.pos() - MOVI_FOURCC_OFFSET);
+
+  // idx1：每個影格皆為關鍵影格
+  QByteArray idx;
+  idx.reserve(8 + m_index.size() * 16);
+  putFourCC(idx, "idx1");
+  put32(idx, quint32(m_index.size() * 16));
+  for (const IndexEntry &e : m_index) {
+    putFourCC(idx, "00dc");
+    put32(idx, AVIIF_KEYFRAME);
+    put32(idx, e.offset);
+    put32(idx, e.size);
+  }
+  bool ok = m_file.write(idx) == idx.size();
+
+  // 回填 RIFF 大小與所有依賴影格數的欄位
+  const quint32 riffBytes = quint32(m_file.pos() - 8);
+  QByteArray header = buildHeaders(fps > 0 ? fps : 10.0, moviBytes);
+  qToLittleEndian(riffBytes, reinterpret_cast<uchar *>(header.data() + 4));
+  ok = ok && m_file.seek(0) && m_file.write(header) == header.size();
+
+  m_file.close();
+  return ok;
+}
+
+QByteArray MjpegAviWriter::buildHeaders(double fps, quint32 moviBytes) const {
+  const quint32 frames = quint32(m_index.size());
+  const quint32 usPerFrame = fps > 0 ? quint32(1000000.0 / fps) : 0;
+  // 以 1000 為 scale 保留小數影格率
+  const quint32 rate = fps > 0 ? quint32(fps * 1000.0 + 0.5) : 0;
+
+  QByteArray h;
+  h.reserve(HEADER_BYTES);
+
+  putFourCC(h, "RIFF");
+  put32(h, 0); // close() 時回填
+  putFourCC(h, "AVI ");
+
+  putFourCC(h, "LIST");
+  put32(h, 192);
+  putFourCC(h, "hdrl");
+
+  // MainAVIHeader
+  putFourCC(h, "avih");
+  put32(h, 56);
+  put32(h, usPerFrame);
+  put32(h, quint32(m_maxFrameBytes * (fps > 0 ? fps : 0)));
+  put32(h, 0);
+  put32(h, AVIF_HASINDEX);
+  put32(h, frames);
+  put32(h, 0);
+  put32(h, 1); // streams
+  put32(h, m_maxFrameBytes);
+  put32(h, quint32(m_width));
+  put32(h, quint32(m_height));
+  for (int i = 0; i < 4; i++)
+    put32(h, 0);
+
+  putFourCC(h, "LIST");
+  put32(h, 116);
+  putFourCC(h, "strl");
+
+  // AVIStreamHeader
+  putFourCC(h, "strh");
+  put32(h, 56);
+  putFourCC(h, "vids");
+  putFourCC(h, "MJPG");
+  put32(h, 0);
+  put16(h, 0);
+  put16(h, 0);
+  put32(h, 0);
+  put32(h, 1000); // dwScale
+  put32(h, rate); // dwRate
+  put32(h, 0);
+  put32(h, frames);
+  put32(h, m_maxFrameBytes);
+  put32(h, 0xffffffffu);
+  put32(h, 0);
+  put16(h, 0);
+  put16(h, 0);
+  put16(h, quint16(m_width));
+  put16(h, quint16(m_height));
+
+  // BITMAPINFOHEADER
+  putFourCC(h, "strf");
+  put32(h, 40);
+  put32(h, 40);
+  put32(h, quint32(m_width));
+  put32(h, quint32(m_height));
+  put16(h, 1);
+  put16(h, 24);
+  putFourCC(h, "MJPG");
+  put32(h, quint32(m_width * m_height * 3));
+  for (int i = 0; i < 4; i++)
+    put32(h, 0);
+
+  putFourCC(h, "LIST");
+  put32(h, moviBytes);
+  putFourCC(h, "movi");
+
+  Q_ASSERT(h.size() == HEADER_BYTES);
+  return h;
+}
@@ -0,0 +1,42 @@
+#ifndef MJPEGAVIWRITER_H
+#define MJPEGAVIWRITER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QVector>
+
+/**
+ * MjpegAviWriter
+ * 把現成的 JPEG 影格直接包進 AVI (RIFF) 容器，不需重新編碼也不依賴
+ * OpenCV/GStreamer；影格率在 close() 時依實際時間戳記回填到檔頭
+ */
+class MjpegAviWriter {
+public:
+  MjpegAviWriter() {}
+  ~MjpegAviWriter() { close(0); }
+
+  bool open(const QString &path, int width, int height);
+  bool writeFrame(const QByteArray &jpeg);
+  // fps <= 0 時使用預設 10 fps
+  bool close(double fps);
+
+  bool isOpen() const { return m_file.isOpen(); }
+  int frameCount() const { return m_index.size(); }
+  qint64 bytesWritten() const { return m_file.isOpen() ? m_file.pos() : 0; }
+
+private:
+  struct IndexEntry {
+    quint32 offset; // 相對於 'movi' fourcc
+    quint32 size;
+  };
+
+  QFile m_file;
+  int m_width = 0;
+  int m_height = 0;
+  quint32 m_maxFrameBytes = 0;
+  QVector<IndexEntry> m_index;
+
+  QByteArray buildHeaders(double fps, quint32 moviBytes) const;
+};
+
+#endif // MJPEGAVIWRITER_H
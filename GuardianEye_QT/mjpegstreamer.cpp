@@ -0,0 +1,158 @@
+#include "mjpegstreamer.h"
+#include "tracing.h"
+#include <QBuffer>
+#include <QDebug>
+#include <QImage>
+#include <QTcpSocket>
+#include <QTimer>
+
+static const QByteArray BOUNDARY = "guardianframe";
+
+MjpegStreamer::MjpegStreamer(HttpServer *server)
+    : MjpegStreamer(server, Config()) {}
+
+MjpegStreamer::MjpegStreamer(HttpServer *server, const Config &config)
+    : QObject(nullptr), m_config(config) {
+  m_totalTokens = double(m_config.totalBytesPerSec);
+  m_totalRefill.start();
+
+  // 與 socket 同一執行緒，寫入與斷線處理都不需上鎖
+  moveToThread(server->serverThread());
+  connect(server->serverThread(), &QThread::finished, this,
+          &QObject::deleteLater);
+
+  server->route("/stream.mjpg",
+                [this](QTcpSocket *socket, const HttpRequest &request) {
+                  addClient(socket, request);
+                });
+  server->route("/snapshot.jpg",
+                [this](QTcpSocket *socket, const HttpRequest &) {
+                  if (m_latest.isEmpty())
+                    HttpServer::respond(socket, 503, "text/plain",
+                                        "no frame yet\n");
+                  else
+                    HttpServer::respond(socket, 200, "image/jpeg", m_latest);
+                });
+}
+
+StreamStats MjpegStreamer::stats() const {
+  StreamStats s;
+  s.clients = m_clientCount;
+  s.framesSent = m_framesSent;
+  s.framesDropped = m_framesDropped;
+  s.bytesSent = m_bytesSent;
+  s.rejected = m_rejected;
+  return s;
+}
+
+void MjpegStreamer::addClient(QTcpSocket *socket, const HttpRequest &request) {
+  if (m_clients.size() >= m_config.maxClients) {
+    m_rejected++;
+    HttpServer::respond(socket, 503, "text/plain", "too many viewers\n");
+    return;
+  }
+
+  Client client;
+  client.socket = socket;
+  client.low = request.query.queryItemValue("quality") == "low";
+  client.tokens = double(m_config.clientBytesPerSec); // 允許一秒的突發量
+  client.refill.start();
+  m_clients.append(client);
+  m_clientCount = m_clients.size();
+
+  connect(socket, &QTcpSocket::disconnected, this,
+          [this, socket]() { removeClient(socket); });
+
+  socket->write("HTTP/1.1 200 OK\r\n"
+                "Content-Type: multipart/x-mixed-replace; boundary=" +
+                BOUNDARY +
+                "\r\n"
+                "Cache-Control: no-cache\r\n"
+                "Connection: close\r\n\r\n");
+  qDebug() << "MjpegStreamer: 新觀看者" << socket->peerAddress().toString()
+           << (client.low ? "(低畫質)" : "") << "目前" << m_clients.size();
+  emit clientCountChanged(m_clients.size());
+}
+
+void MjpegStreamer::removeClient(QTcpSocket *socket) {
+  for (int i = 0; i < m_clients.size(); i++) {
+    if (m_clients[i].socket == socket) {
+      m_clients.removeAt(i);
+      m_clientCount = m_clients.size();
+      emit clientCountChanged(m_clients.size());
+      return;
+    }
+  }
+}
+
+void MjpegStreamer::publishFrame(const QByteArray &jpeg, quint64 seq,
+                                 qint64 timestampMs) {
+  Q_UNUSED(seq);
+  Q_UNUSED(timestampMs);
+  // QByteArray 隱式共享：跨執行緒只傳參照
+  if (QThread::currentThread() == thread())
+    broadcast(jpeg);
+  else
+    QTimer::singleShot(0, this, [this, jpeg]() { broadcast(jpeg); });
+}
+
+void MjpegStreamer::refillTokens(double &tokens, QElapsedTimer &refill,
+                                 qint64 rate) {
+  if (!refill.isValid())
+    refill.start();
+  tokens = qMin(double(rate), tokens + rate * refill.restart() / 1000.0);
+}
+
+const QByteArray &MjpegStreamer::lowFrame() {
+  if (m_latestLow.isEmpty()) {
+    QImage image;
+    if (image.loadFromData(m_latest, "JPG")) {
+      QBuffer buffer(&m_latestLow);
+      buffer.open(QIODevice::WriteOnly);
+      image.scaledToWidth(m_config.lowWidth, Qt::FastTransformation)
+          .save(&buffer, "JPG", m_config.lowQuality);
+    }
+  }
+  return m_latestLow;
+}
+
+void MjpegStreamer::broadcast(const QByteArray &jpeg) {
+  TRACE_SCOPE("http.mjpeg_broadcast");
+  m_latest = jpeg;
+  m_latestLow.clear();
+  if (m_clients.isEmpty())
+    return;
+
+  refillTokens(m_totalTokens, m_totalRefill, m_config.totalBytesPerSec);
+  for (Client &client : m_clients) {
+    // 上一張影格還在 socket 緩衝區：這個客戶端太慢，略過而不是累積
+    if (client.socket->bytesToWrite() > 0) {
+      m_framesDropped++;
+      continue;
+    }
+
+    const QByteArray &frame = client.low ? lowFrame() : m_latest;
+    if (frame.isEmpty())
+      continue;
+    const QByteArray header = "--" + BOUNDARY +
+                              "\r\nContent-Type: image/jpeg\r\n"
+                              "Content-Length: " +
+                              QByteArray::number(frame.size()) + "\r\n\r\n";
+    const qint64 bytes = header.size() + frame.size() + 2;
+
+    // 兩個 bucket 都足夠才扣，任一邊不足時另一邊的額度保留給下一張
+    refillTokens(client.tokens, client.refill, m_config.clientBytesPerSec);
+    if (client.tokens < bytes || m_totalTokens < bytes) {
+      m_framesDropped++;
+      continue;
+    }
+    client.tokens -= bytes;
+    m_totalTokens -= bytes;
+
+    client.socket->write(header);
+    client.socket->write(frame);
+    client.socket->write("\r\n");
+    m_framesSent++;
+    m_bytesSent += quint64(bytes);
+  }
+}
@@ -0,0 +1,81 @@
+#ifndef MJPEGSTREAMER_H
+#define MJPEGSTREAMER_H
+
+#include "httpserver.h"
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <atomic>
+
+class QTcpSocket;
+
+struct StreamStats {
+  int clients = 0;
+  quint64 framesSent = 0;
+  quint64 framesDropped = 0; // 客戶端太慢或超過頻寬上限而略過
+  quint64 bytesSent = 0;
+  quint64 rejected = 0;      // 超過連線上限被拒
+};
+
+/**
+ * MjpegStreamer
+ * 以 multipart/x-mixed-replace 提供即時影像 (/stream.mjpg) 與最新單張 (/snapshot.jpg)。
+ * 每張影格對每個畫質只編碼一次 (原畫質直接沿用 worker 的 JPEG)，
+ * 所有客戶端共用同一份 QByteArray；上一張還沒送出的客戶端直接略過新影格，
+ * 不在伺服器端累積緩衝，並以 token bucket 限制單一連線與總頻寬
+ */
+class MjpegStreamer : public QObject {
+  Q_OBJECT
+public:
+  struct Config {
+    int maxClients = 8;
+    qint64 clientBytesPerSec = 2 * 1024 * 1024;
+    qint64 totalBytesPerSec = 8 * 1024 * 1024;
+    int lowWidth = 320; // ?quality=low 的寬度
+    int lowQuality = 50;
+  };
+
+  // 物件會被移到伺服器執行緒，不可設 parent；隨伺服器執行緒結束而釋放
+  explicit MjpegStreamer(HttpServer *server);
+  MjpegStreamer(HttpServer *server, const Config &config);
+
+  StreamStats stats() const;
+
+public slots:
+  // 任意執行緒呼叫；實際發送在伺服器執行緒
+  void publishFrame(const QByteArray &jpeg, quint64 seq, qint64 timestampMs);
+
+signals:
+  void clientCountChanged(int clients);
+
+private:
+  struct Client {
+    QTcpSocket *socket;
+    bool low;
+    double tokens;
+    QElapsedTimer refill;
+  };
+
+  Config m_config;
+  QList<Client> m_clients;
+  QByteArray m_latest;
+  QByteArray m_latestLow; // 有低畫質客戶端時才產生
+  double m_totalTokens = 0;
+  QElapsedTimer m_totalRefill;
+
+  std::atomic<int> m_clientCount{0};
+  std::atomic<quint64> m_framesSent{0};
+  std::atomic<quint64> m_framesDropped{0};
+  std::atomic<quint64> m_bytesSent{0};
+  std::atomic<quint64> m_rejected{0};
+
+  void addClient(QTcpSocket *socket, const HttpRequest &request);
+  void removeClient(QTcpSocket *socket);
+  void broadcast(const QByteArray &jpeg);
+  const QByteArray &lowFrame();
+  static void refillTokens(double &tokens, QElapsedTimer &refill,
+                           qint64 rate);
+};
+
+#endif // MJPEGSTREAMER_H
@@ -0,0 +1,69 @@
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * MpscQueue
+ * 預先配置的有界無鎖佇列 (多生產者 / 單一消費者)，
+ * 每個槽位以序號判斷可寫/可讀，push/pop 都不會配置記憶體或上鎖
+ */
+template <typename T, size_t Capacity> class MpscQueue {
+  static_assert((Capacity & (Capacity - 1)) == 0,
+                "MpscQueue capacity must be a power of two");
+
+public:
+  MpscQueue() {
+    for (size_t i = 0; i < Capacity; i++)
+      m_cells[i].seq.store(i, std::memory_order_relaxed);
+  }
+
+  // 任意執行緒；佇列已滿時回傳 false
+  bool push(const T &item) {
+    size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+    Cell *cell;
+    for (;;) {
+      cell = &m_cells[pos & (Capacity - 1)];
+      size_t seq = cell->seq.load(std::memory_order_acquire);
+      intptr_t diff = intptr_t(seq) - intptr_t(pos);
+      if (diff == 0) {
+        if (m_enqueuePos.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed))
+          break;
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = m_enqueuePos.load(std::memory_order_relaxed);
+      }
+    }
+    cell->data = item;
+    cell->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // 僅限消費者執行緒
+  bool pop(T &item) {
+    Cell *cell = &m_cells[m_dequeuePos & (Capacity - 1)];
+    size_t seq = cell->seq.load(std::memory_order_acquire);
+    if (intptr_t(seq) - intptr_t(m_dequeuePos + 1) < 0)
+      return false;
+    item = cell->data;
+    cell->seq.store(m_dequeuePos + Capacity, std::memory_order_release);
+    m_dequeuePos++;
+    return true;
+  }
+
+private:
+  struct Cell {
+    std::atomic<size_t> seq;
+    T data;
+  };
+
+  alignas(64) Cell m_cells[Capacity];
+  alignas(64) std::atomic<size_t> m_enqueuePos{0};
+  alignas(64) size_t m_dequeuePos = 0;
+};
+
+#endif // MPSCQUEUE_H
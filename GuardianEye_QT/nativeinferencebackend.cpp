@@ -0,0 +1,244 @@
+#include "nativeinferencebackend.h"
+#include "tracing.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+
+NativeInferenceWorker::NativeInferenceWorker(const QString &modelDir,
+                                             QObject *parent)
+    : QObject(parent), m_modelDir(modelDir) {}
+
+bool NativeInferenceWorker::openCamera() {
+  // 與 vision_system.py 相同：先試 GStreamer，再退回 V4L2
+  const int indices[] = {0, 1};
+  for (int idx : indices) {
+    QString gst = QString("v4l2src device=/dev/video%1 ! video/x-raw, "
+                          "width=640, height=480 ! videoconvert ! "
+                          "video/x-raw, format=BGR ! appsink drop=True")
+                      .arg(idx);
+    if (m_cap.open(gst.toStdString(), cv::CAP_GSTREAMER) && m_cap.isOpened())
+      return true;
+    if (m_cap.open(idx, cv::CAP_V4L2) && m_cap.isOpened())
+      return true;
+  }
+  return false;
+}
+
+bool NativeInferenceWorker::loadModel() {
+  QString path = QDir(m_modelDir).absoluteFilePath(
+      "models/best_pig_model_v5n.onnx");
+  try {
+    m_net = cv::dnn::readNetFromONNX(path.toStdString());
+  } catch (const cv::Exception &e) {
+    qDebug() << "NativeInferenceWorker: 模型載入失敗" << e.what();
+    return false;
+  }
+  if (m_net.empty())
+    return false;
+
+  m_net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+  m_net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+  m_outNames = m_net.getUnconnectedOutLayersNames();
+  qDebug() << "NativeInferenceWorker: 已載入" << path;
+  return true;
+}
+
+void NativeInferenceWorker::process() {
+  m_running = true;
+
+  emit statusChanged("正在載入 YOLO ONNX 模型 (OpenCV DNN)...");
+  if (!loadModel()) {
+    emit errorOccurred("找不到或無法載入 models/best_pig_model_v5n.onnx");
+    return;
+  }
+
+  emit statusChanged("正在開啟攝影機...");
+  if (!openCamera()) {
+    emit errorOccurred("無法開啟攝影機");
+    return;
+  }
+  emit statusChanged("系統已啟動 (原生後端僅偵測小豬，陌生人/主人警報停用)");
+
+  // 推論使用 OpenCV 內建的執行緒池，保留一個核心給擷取與 UI
+  cv::setNumThreads(qMax(1, QThread::idealThreadCount() - 1));
+
+  cv::Mat frame;
+  quint64 seq = 0;
+  QElapsedTimer lastEncode;
+  while (m_running) {
+    bool captured;
+    {
+      TRACE_SCOPE("native.capture");
+      captured = m_cap.read(frame) && !frame.empty();
+    }
+    if (!captured) {
+      QThread::msleep(10);
+      continue;
+    }
+    seq++;
+
+    // 與 Python 版相同，每 2 幀推論一次
+    if (seq % 2 == 0) {
+      TRACE_SCOPE("native.detect");
+      const QVector<DetectionObservation> observations = detect(frame);
+      const QVector<DetectionEvent> events = m_fusion.update(
+          observations, seq, QDateTime::currentMSecsSinceEpoch());
+      for (const DetectionEvent &ev : events)
+        emit detectionStateChanged(ev);
+    }
+
+    // 有人需要壓縮影格 (min_fps > 0) 時才編碼 JPEG；預覽關閉時降到 min_fps
+    const bool preview = m_preview;
+    const int minFps = m_minFps;
+    const bool forced = !preview && minFps > 0 &&
+                        (!lastEncode.isValid() ||
+                         lastEncode.elapsed() >= 1000 / minFps);
+    if (minFps > 0 && (preview || forced)) {
+      TRACE_SCOPE("native.encode");
+      lastEncode.start();
+      cv::imencode(".jpg", frame, m_jpeg, {cv::IMWRITE_JPEG_QUALITY, 80});
+      emit compressedFrameReady(
+          QByteArray(reinterpret_cast<const char *>(m_jpeg.data()),
+                     int(m_jpeg.size())),
+          seq, QDateTime::currentMSecsSinceEpoch());
+    }
+    if (!preview)
+      continue;
+    cv::cvtColor(frame, m_rgb, cv::COLOR_BGR2RGB);
+    QImage img((const uchar *)m_rgb.data, m_rgb.cols, m_rgb.rows,
+               int(m_rgb.step), QImage::Format_RGB888);
+    emit frameReady(img.copy());
+  }
+  m_cap.release();
+}
+
+QVector<DetectionObservation>
+NativeInferenceWorker::detect(const cv::Mat &frame) {
+  QVector<DetectionObservation> observations;
+
+  // 1. Letterbox：等比例縮放後補邊到 640x640 (寫入重複使用的緩衝區)
+  float scale = qMin(float(INPUT_SIZE) / frame.cols,
+                     float(INPUT_SIZE) / frame.rows);
+  int newW = int(frame.cols * scale + 0.5f);
+  int newH = int(frame.rows * scale + 0.5f);
+  int padX = (INPUT_SIZE - newW) / 2;
+  int padY = (INPUT_SIZE - newH) / 2;
+
+  m_letterbox.create(INPUT_SIZE, INPUT_SIZE, CV_8UC3);
+  m_letterbox.setTo(cv::Scalar(114, 114, 114));
+  cv::resize(frame, m_resized, cv::Size(newW, newH), 0, 0, cv::INTER_LINEAR);
+  m_resized.copyTo(m_letterbox(cv::Rect(padX, padY, newW, newH)));
+
+  cv::dnn::blobFromImage(m_letterbox, m_blob, 1.0 / 255.0, cv::Size(),
+                         cv::Scalar(), true, false);
+  m_net.setInput(m_blob);
+  m_net.forward(m_outputs, m_outNames);
+  if (m_outputs.empty())
+    return observations;
+
+  // 2. 解碼：輸出為 [1, N, 5 + 類別數]，先以整欄比較篩出 objectness 夠高的列
+  const cv::Mat &out = m_outputs[0];
+  const int rows = out.size[1];
+  const int dims = out.size[2];
+  cv::Mat pred(rows, dims, CV_32F, (void *)out.ptr<float>());
+
+  cv::Mat candidates;
+  cv::findNonZero(pred.col(4) > m_confThreshold, candidates);
+
+  m_boxes.clear();
+  m_scores.clear();
+  for (int i = 0; i < candidates.rows; i++) {
+    const float *row = pred.ptr<float>(candidates.at<cv::Point>(i).y);
+    // 類別 0 = 小豬
+    float score = row[4] * row[5];
+    if (score < m_confThreshold)
+      continue;
+
+    float cx = (row[0] - padX) / scale;
+    float cy = (row[1] - padY) / scale;
+    float w = row[2] / scale;
+    float h = row[3] / scale;
+    m_boxes.push_back(cv::Rect(int(cx - w / 2), int(cy - h / 2), int(w),
+                               int(h)));
+    m_scores.push_back(score);
+  }
+
+  // 3. NMS
+  cv::dnn::NMSBoxes(m_boxes, m_scores, m_confThreshold, m_nmsThreshold,
+                    m_keep);
+
+  for (int idx : m_keep) {
+    const cv::Rect &r = m_boxes[idx];
+    DetectionObservation obs;
+    obs.type = "pig";
+    obs.confidence = m_scores[idx];
+    obs.bbox = QRect(r.x, r.y, r.width, r.height);
+    observations.append(obs);
+  }
+  return observations;
+}
+
+NativeInferenceBackend::NativeInferenceBackend(QObject *parent)
+    : InferenceBackend(parent) {}
+
+NativeInferenceBackend::~NativeInferenceBackend() { stop(); }
+
+void NativeInferenceBackend::start() {
+  if (m_thread)
+    return;
+
+  QString modelDir = locateAiDirectory("models/best_pig_model_v5n.onnx");
+  if (modelDir.isEmpty()) {
+    qDebug() << "NativeInferenceBackend: [錯誤] 找不到 "
+                "models/best_pig_model_v5n.onnx";
+    emit errorOccurred("找不到 ONNX 模型");
+    return;
+  }
+
+  m_thread = new QThread(this);
+  m_worker = new NativeInferenceWorker(modelDir);
+  m_worker->setPreviewEnabled(m_preview);
+  m_worker->setMinimumFrameRate(m_minFps);
+  m_worker->moveToThread(m_thread);
+
+  connect(m_thread, &QThread::started, m_worker,
+          &NativeInferenceWorker::process);
+  connect(m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+  connect(m_worker, &NativeInferenceWorker::frameReady, this,
+          &InferenceBackend::frameReady);
+  connect(m_worker, &NativeInferenceWorker::compressedFrameReady, this,
+          &InferenceBackend::compressedFrameReady);
+  connect(m_worker, &NativeInferenceWorker::detectionStateChanged, this,
+          &InferenceBackend::detectionStateChanged);
+  connect(m_worker, &NativeInferenceWorker::errorOccurred, this,
+          &InferenceBackend::errorOccurred);
+  connect(m_worker, &NativeInferenceWorker::statusChanged, this,
+          &InferenceBackend::statusChanged);
+
+  m_thread->start();
+}
+
+void NativeInferenceBackend::stop() {
+  if (!m_thread)
+    return;
+
+  qDebug() << "NativeInferenceBackend: 正在關閉 AI 系統...";
+  m_worker->stop();
+  m_thread->quit();
+  m_thread->wait();
+  m_thread = nullptr;
+  m_worker = nullptr;
+}
+
+void NativeInferenceBackend::setPreviewEnabled(bool enabled) {
+  m_preview = enabled;
+  if (m_worker)
+    m_worker->setPreviewEnabled(enabled);
+}
+
+void NativeInferenceBackend::setMinimumFrameRate(int fps) {
+  m_minFps = qMax(0, fps);
+  if (m_worker)
+    m_worker->setMinimumFrameRate(m_minFps);
+}
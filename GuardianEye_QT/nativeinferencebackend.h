@@ -0,0 +1,92 @@
+#ifndef NATIVEINFERENCEBACKEND_H
+#define NATIVEINFERENCEBACKEND_H
+
+#include "inferencebackend.h"
+#include <QThread>
+#include <atomic>
+#include <opencv2/dnn.hpp>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+/**
+ * NativeInferenceWorker
+ * 在專屬執行緒上擷取影像並以 OpenCV DNN (CPU) 執行匯出的 YOLOv5n ONNX 模型；
+ * letterbox/blob/輸出緩衝區皆重複使用，不在每幀配置
+ */
+class NativeInferenceWorker : public QObject {
+  Q_OBJECT
+public:
+  explicit NativeInferenceWorker(const QString &modelDir,
+                                 QObject *parent = nullptr);
+
+  void stop() { m_running = false; }
+  void setPreviewEnabled(bool enabled) { m_preview = enabled; }
+  void setMinimumFrameRate(int fps) { m_minFps = fps; }
+
+public slots:
+  void process(); // 執行緒的主循環函式
+
+signals:
+  void frameReady(QImage img);
+  void compressedFrameReady(const QByteArray &jpeg, quint64 seq,
+                            qint64 timestampMs);
+  void detectionStateChanged(const DetectionEvent &event);
+  void errorOccurred(QString msg);
+  void statusChanged(QString status);
+
+private:
+  QString m_modelDir;
+  std::atomic<bool> m_running{false};
+  std::atomic<bool> m_preview{true};
+  std::atomic<int> m_minFps{0};
+
+  cv::VideoCapture m_cap;
+  cv::dnn::Net m_net;
+  std::vector<cv::String> m_outNames;
+  DetectionFusion m_fusion;
+
+  // 重複使用的緩衝區
+  cv::Mat m_resized;
+  cv::Mat m_letterbox;
+  cv::Mat m_blob;
+  cv::Mat m_rgb;
+  std::vector<uchar> m_jpeg;
+  std::vector<cv::Mat> m_outputs;
+  std::vector<cv::Rect> m_boxes;
+  std::vector<float> m_scores;
+  std::vector<int> m_keep;
+
+  static const int INPUT_SIZE = 640;
+  float m_confThreshold = 0.6f; // 與 vision_system.py 的 yolo_conf 一致
+  float m_nmsThreshold = 0.45f;
+
+  bool openCamera();
+  bool loadModel();
+  QVector<DetectionObservation> detect(const cv::Mat &frame);
+};
+
+/**
+ * NativeInferenceBackend
+ * 行程內推論後端，免去 python3 載入 PyTorch 的冷啟動與常駐記憶體；
+ * 目前僅支援 YOLO 小豬偵測，人臉辨識仍需使用 PythonAiManager
+ */
+class NativeInferenceBackend : public InferenceBackend {
+  Q_OBJECT
+public:
+  explicit NativeInferenceBackend(QObject *parent = nullptr);
+  ~NativeInferenceBackend();
+
+public slots:
+  void start() override;
+  void stop() override;
+  void setPreviewEnabled(bool enabled) override;
+  void setMinimumFrameRate(int fps) override;
+
+private:
+  QThread *m_thread = nullptr;
+  NativeInferenceWorker *m_worker = nullptr;
+  bool m_preview = true;
+  int m_minFps = 0;
+};
+
+#endif // NATIVEINFERENCEBACKEND_H
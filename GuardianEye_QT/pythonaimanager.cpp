@@ -1,82 +1,119 @@
 #include "pythonaimanager.h"
+#include "metrics.h"
+#include "tracing.h"
+#include "workerstream.h"
 #include <QBuffer>
 #include <QCoreApplication>
+#include <QDateTime>
 #include <QDebug>
 #include <QDir>
+#include <QJsonArray>
+#include <QTimer>
 
 PythonAiManager::PythonAiManager(QObject *parent)
-    : QObject(parent), m_process(new QProcess(this)), m_isRunning(false) {
+    : InferenceBackend(parent), m_watchdog(new QTimer(this)),
+      m_restartTimer(new QTimer(this)), m_isRunning(false),
+      m_creditTimer(new QTimer(this)) {
+  qRegisterMetaType<AiWorkerStats>("AiWorkerStats");
 
-  connect(m_process, &QProcess::readyReadStandardOutput, this,
-          &PythonAiManager::handleReadyRead);
+  m_useStandby = qgetenv("GUARDIAN_AI_STANDBY") == "1";
+  // 可改指向模擬 worker 以測試當機/卡死處理
+  if (qEnvironmentVariableIsSet("GUARDIAN_AI_SCRIPT"))
+    m_script = QString::fromLocal8Bit(qgetenv("GUARDIAN_AI_SCRIPT"));
 
-  connect(m_process, &QProcess::readyReadStandardError, this, [this]() {
-    QByteArray err = m_process->readAllStandardError();
-    qDebug() << "Python Error Log:" << err;
-  });
+  if (qEnvironmentVariableIsSet("GUARDIAN_AI_REPLAY")) {
+    const QByteArray speed = qgetenv("GUARDIAN_AI_REPLAY_SPEED");
+    m_replay = new WorkerStreamReplay(
+        QString::fromLocal8Bit(qgetenv("GUARDIAN_AI_REPLAY")),
+        speed.isEmpty() ? 1.0 : speed.toDouble(), this);
+    m_replayWorker = new AiWorkerProcess(this);
+    connect(m_replay, &WorkerStreamReplay::chunkReady, this,
+            [this](const QByteArray &chunk, qint64 streamNs) {
+              if (!m_isRunning)
+                return;
+              m_replayClockMs = m_replayEpochMs + streamNs / 1000000;
+              m_replayWorker->feed(chunk);
+            });
+    connect(m_replayWorker, &AiWorkerProcess::messageReceived, this,
+            [this](const QJsonObject &obj) {
+              m_replayMessages++;
+              if (obj.contains("seq"))
+                m_replayFrames++;
+              parseLine(obj);
+            });
+    connect(m_replay, &WorkerStreamReplay::finished, this, [this]() {
+      if (!m_isRunning)
+        return;
+      QJsonObject report = m_replay->stats();
+      const double wallS = report["wall_s"].toDouble();
+      report.insert("messages", double(m_replayMessages));
+      report.insert("frames", double(m_replayFrames));
+      if (wallS > 0)
+        report.insert("frames_per_s", m_replayFrames / wallS);
+      qDebug() << "PythonAiManager: 重播完畢," << m_replayFrames << "影格 /"
+               << wallS << "秒";
+      emit replayFinished(report);
+    });
+  } else if (qEnvironmentVariableIsSet("GUARDIAN_AI_RECORD")) {
+    m_recorder = new WorkerStreamRecorder(
+        QString::fromLocal8Bit(qgetenv("GUARDIAN_AI_RECORD")));
+  }
+
+  m_watchdog->setInterval(1000);
+  connect(m_watchdog, &QTimer::timeout, this, &PythonAiManager::checkHealth);
+
+  m_creditTimer->setInterval(1000 / m_previewFps);
+  connect(m_creditTimer, &QTimer::timeout, this,
+          &PythonAiManager::grantCredits);
 
-  connect(m_process, &QProcess::errorOccurred, this,
-          &PythonAiManager::handleProcessError);
-  connect(m_process,
-          QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
-          &PythonAiManager::handleProcessFinished);
+  m_restartTimer->setSingleShot(true);
+  connect(m_restartTimer, &QTimer::timeout, this, [this]() {
+    if (!m_isRunning || m_active)
+      return;
+    // 等待期間備援若已就緒則優先使用，否則冷啟動
+    if (m_standby && m_standby->state() == AiWorkerProcess::Standby) {
+      failover();
+      return;
+    }
+    m_stats.restarts++;
+    emit workerStatsChanged(m_stats);
+    m_active = spawn(false);
+  });
 }
 
-PythonAiManager::~PythonAiManager() { stop(); }
+PythonAiManager::~PythonAiManager() {
+  stop();
+  delete m_recorder;
+}
 
 void PythonAiManager::start() {
   if (m_isRunning)
     return;
-
-  QString appPath = QCoreApplication::applicationDirPath();
-  QDir dir(appPath);
-  QString workingDir = "";
+  if (m_replay) {
+    startReplay();
+    return;
+  }
 
   qDebug() << "PythonAiManager: 開始尋找 AI 腳本...";
-  qDebug() << "Qt 執行位置:" << appPath;
-
-  // 搜尋清單：包含您目前的 GE1_SR 以及原本的 GuardianEye
-  QStringList possibleDirs;
-  possibleDirs << "GE1_SR" << "GuardianEye" << "GE1";
-
-  for (int i = 0; i < 3; ++i) {
-    // 檢查清單中的資料夾
-    for (const QString &dirName : possibleDirs) {
-      if (dir.exists(dirName)) {
-        QDir targetDir(dir.absoluteFilePath(dirName));
-        if (targetDir.exists("vision_system.py")) {
-          workingDir = targetDir.absolutePath();
-          break;
-        }
-      }
-    }
-    if (!workingDir.isEmpty())
-      break;
+  m_workingDir = locateAiDirectory(m_script);
 
-    // 檢查當前目錄是否直接包含腳本
-    if (dir.exists("vision_system.py")) {
-      workingDir = dir.absolutePath();
-      break;
-    }
-    if (!dir.cdUp())
-      break;
-  }
-
-  if (workingDir.isEmpty()) {
-    qDebug() << "PythonAiManager: [錯誤] 找不到 vision_system.py！";
+  if (m_workingDir.isEmpty()) {
+    qDebug() << "PythonAiManager: [錯誤] 找不到" << m_script << "！";
     qDebug() << "請確保 Python 腳本在 GE1_SR 或 GuardianEye 資料夾中。";
     emit errorOccurred("找不到 AI 腳本");
     return;
   }
 
-  m_process->setWorkingDirectory(workingDir);
-  QString program = "python3";
-  QStringList arguments;
-  arguments << "vision_system.py" << "--qt_mode" << "--camera" << "0";
-
-  qDebug() << "PythonAiManager: 成功找到腳本於" << workingDir;
-  m_process->start(program, arguments);
+  qDebug() << "PythonAiManager: 成功找到腳本於" << m_workingDir;
   m_isRunning = true;
+  m_failures = 0;
+  m_fusion.reset();
+  m_active = spawn(false);
+  if (m_useStandby)
+    m_standby = spawn(true);
+  m_watchdog->start();
+  if (m_preview)
+    m_creditTimer->start();
 }
 
 void PythonAiManager::stop() {
@@ -84,39 +121,285 @@ void PythonAiManager::stop() {
     return;
 
   qDebug() << "PythonAiManager: 正在關閉 AI 系統...";
-  m_process->terminate();
-  if (!m_process->waitForFinished(3000)) {
-    m_process->kill();
-  }
   m_isRunning = false;
+  if (m_replay)
+    return;
+  m_watchdog->stop();
+  m_restartTimer->stop();
+  m_creditTimer->stop();
+  for (AiWorkerProcess *worker : {m_active, m_standby}) {
+    if (!worker)
+      continue;
+    worker->disconnect(this);
+    worker->terminate();
+    worker->deleteLater();
+  }
+  m_active = nullptr;
+  m_standby = nullptr;
 }
 
-void PythonAiManager::handleReadyRead() {
-  m_buffer.append(m_process->readAllStandardOutput());
-  int newlineIndex;
-  while ((newlineIndex = m_buffer.indexOf('\n')) != -1) {
-    QByteArray line = m_buffer.left(newlineIndex).trimmed();
-    m_buffer.remove(0, newlineIndex + 1);
-    if (!line.isEmpty()) {
-      parseLine(line);
-    }
+AiWorkerProcess *PythonAiManager::spawn(bool standby) {
+  AiWorkerProcess *worker = new AiWorkerProcess(this);
+  if (standby) {
+    connect(worker, &AiWorkerProcess::exited, this,
+            &PythonAiManager::handleStandbyExited);
+  } else {
+    attachActive(worker);
   }
+  worker->start(m_workingDir, m_script, "0", standby);
+  qDebug() << "PythonAiManager: 啟動" << (standby ? "備援" : "主要")
+           << "worker, pid" << worker->pid();
+  return worker;
+}
+
+void PythonAiManager::startReplay() {
+  QString error;
+  if (!m_replay->load(&error)) {
+    qDebug() << "PythonAiManager: [錯誤]" << error;
+    emit errorOccurred(error);
+    QJsonObject report = m_replay->stats();
+    report.insert("error", error);
+    emit replayFinished(report);
+    return;
+  }
+
+  qDebug() << "PythonAiManager: 重播 worker 錄製檔 (不啟動 python3)";
+  m_isRunning = true;
+  m_fusion.reset();
+  m_lastImageSeq = 0;
+  m_replayMessages = 0;
+  m_replayFrames = 0;
+  m_replayEpochMs = QDateTime::currentMSecsSinceEpoch();
+  m_replayClockMs = m_replayEpochMs;
+  m_replay->start();
 }
 
-void PythonAiManager::parseLine(const QByteArray &line) {
-  QJsonParseError error;
-  QJsonDocument doc = QJsonDocument::fromJson(line, &error);
-  if (error.error != QJsonParseError::NoError) {
-    // 如果不是 JSON，則當作普通日誌輸出
-    QString rawLine = QString::fromUtf8(line).trimmed();
-    if (!rawLine.isEmpty()) {
-      qDebug() << "Python AI Log:" << rawLine;
+qint64 PythonAiManager::nowMs() const {
+  // 重播時以錄製時間軸為準，盡快重播也不會改變融合與限流看到的間隔
+  return m_replay ? m_replayClockMs : QDateTime::currentMSecsSinceEpoch();
+}
+
+void PythonAiManager::attachActive(AiWorkerProcess *worker) {
+  worker->setRecorder(m_recorder);
+  connect(worker, &AiWorkerProcess::messageReceived, this,
+          &PythonAiManager::handleMessage);
+  connect(worker, &AiWorkerProcess::exited, this,
+          &PythonAiManager::handleActiveExited);
+  connect(worker, &AiWorkerProcess::stateChanged, this,
+          [this, worker](AiWorkerProcess::State state) {
+            // 新的 worker 開始執行：舊行程的 credit 已失效，重新同步
+            if (worker == m_active && state == AiWorkerProcess::Running) {
+              m_outstanding = 0;
+              m_unshown.clear();
+              m_lastImageSeq = 0;
+              sendPreviewState();
+              grantCredits();
+            }
+          });
+}
+
+void PythonAiManager::setPreviewEnabled(bool enabled) {
+  if (m_preview == enabled)
+    return;
+  m_preview = enabled;
+  qDebug() << "PythonAiManager: 預覽影格" << (enabled ? "開啟" : "關閉");
+  sendPreviewState();
+  if (enabled && m_isRunning) {
+    m_creditTimer->start();
+  } else {
+    m_creditTimer->stop();
+    m_outstanding = 0;
+    m_unshown.clear();
+  }
+}
+
+void PythonAiManager::setMinimumFrameRate(int fps) {
+  fps = qMax(0, fps);
+  if (m_minFps == fps)
+    return;
+  m_minFps = fps;
+  sendPreviewState();
+}
+
+void PythonAiManager::sendPreviewState() {
+  if (!m_active)
+    return;
+  m_active->sendCommand(
+      QJsonObject{{"cmd", "preview"}, {"enabled", m_preview}});
+  m_active->sendCommand(QJsonObject{{"cmd", "min_fps"}, {"fps", m_minFps}});
+}
+
+void PythonAiManager::previewFrameShown() {
+  // frameReady 以排隊連線送到 GUI，畫出的順序與送出的順序相同
+  if (m_unshown.isEmpty())
+    return;
+  if (m_unshown.dequeue() && m_outstanding > 0)
+    m_outstanding--;
+}
+
+void PythonAiManager::grantCredits() {
+  // credit 在 UI 畫出影格後才歸還 (previewFrameShown)：GUI 忙碌或卡住時
+  // 在途影格用完就停止發放，worker 不再編碼沒人看的影格；計時器只決定速率上限
+  if (!m_preview || !m_active ||
+      m_active->state() != AiWorkerProcess::Running ||
+      m_outstanding >= m_creditWindow)
+    return;
+  const int n = m_creditWindow - m_outstanding;
+  if (m_active->sendCommand(QJsonObject{{"cmd", "credit"}, {"n", n}}))
+    m_outstanding += n;
+}
+
+void PythonAiManager::handleMessage(const QJsonObject &obj) {
+  if (sender() != m_active)
+    return;
+  parseLine(obj);
+}
+
+void PythonAiManager::checkHealth() {
+  if (!m_active)
+    return;
+
+  const AiWorkerProcess::State state = m_active->state();
+  if (state == AiWorkerProcess::Running) {
+    if (m_active->msSinceActivity() > m_hangTimeoutMs) {
+      qDebug() << "PythonAiManager: worker 超過" << m_hangTimeoutMs
+               << "ms 沒有影格，判定卡死並強制結束";
+      m_stats.hangs++;
+      m_hangKill = true;
+      markDown();
+      m_active->kill(); // 結束後由 handleActiveExited 接手
+    } else if (m_failures > 0 && m_runningSince.isValid() &&
+               m_runningSince.elapsed() > m_stableMs) {
+      m_failures = 0; // 已穩定執行，重置退避
     }
+  } else if (state == AiWorkerProcess::Loading &&
+             m_active->msSinceActivity() > m_startupTimeoutMs) {
+    qDebug() << "PythonAiManager: worker 啟動逾時，強制結束";
+    m_stats.hangs++;
+    m_hangKill = true;
+    markDown();
+    m_active->kill();
+  }
+}
+
+void PythonAiManager::handleActiveExited(int exitCode, bool crashed) {
+  AiWorkerProcess *worker = qobject_cast<AiWorkerProcess *>(sender());
+  if (worker != m_active)
+    return;
+
+  m_active = nullptr;
+  worker->deleteLater();
+  m_runningSince.invalidate();
+
+  if (!m_isRunning) {
+    qDebug() << "PythonAiManager: AI 系統已正常關閉 (代碼:" << exitCode << ")";
     return;
   }
 
-  QJsonObject obj = doc.object();
+  qDebug() << "PythonAiManager: AI 系統異常結束，退出碼:" << exitCode
+           << (crashed ? "(當機)" : "");
+  if (crashed && !m_hangKill)
+    m_stats.crashes++;
+  m_hangKill = false;
+  markDown();
+  m_failures++;
+  // 偵測狀態隨舊行程失效，由新行程的影格重新建立
+  m_fusion.reset();
+  failover();
+}
+
+void PythonAiManager::handleStandbyExited(int exitCode, bool crashed) {
+  AiWorkerProcess *worker = qobject_cast<AiWorkerProcess *>(sender());
+  if (worker != m_standby)
+    return;
+  m_standby = nullptr;
+  worker->deleteLater();
+  qDebug() << "PythonAiManager: 備援 worker 結束，退出碼:" << exitCode
+           << (crashed ? "(當機)" : "");
+  if (m_isRunning)
+    scheduleStandby();
+}
+
+void PythonAiManager::failover() {
+  if (!m_isRunning || m_active)
+    return;
 
+  if (m_standby && m_standby->state() == AiWorkerProcess::Standby) {
+    // 備援已載入模型：改接主要訊號並送出 activate
+    qDebug() << "PythonAiManager: 切換至備援 worker, pid" << m_standby->pid();
+    m_active = m_standby;
+    m_standby = nullptr;
+    m_active->disconnect(this);
+    attachActive(m_active);
+    m_active->activate();
+    m_stats.failovers++;
+    emit workerStatsChanged(m_stats);
+    scheduleStandby();
+    return;
+  }
+
+  if (m_restartTimer->isActive())
+    return;
+  scheduleRestart();
+}
+
+int PythonAiManager::backoffDelayMs() const {
+  // 第一次失敗立即重啟，之後 base * 2^(n-2)，上限 m_backoffMaxMs
+  if (m_failures <= 1)
+    return 0;
+  return qMin(m_backoffMaxMs, m_backoffBaseMs << qMin(m_failures - 2, 16));
+}
+
+void PythonAiManager::scheduleRestart() {
+  const int delay = backoffDelayMs();
+  qDebug() << "PythonAiManager:" << delay << "ms 後重新啟動 worker (第"
+           << m_failures << "次失敗)";
+  emit statusChanged("AI 系統重新啟動中...");
+  m_restartTimer->start(delay);
+}
+
+void PythonAiManager::scheduleStandby() {
+  if (!m_useStandby || m_standby || !m_isRunning)
+    return;
+  // 與重啟共用退避，避免備援本身反覆當機時佔滿 CPU
+  QTimer::singleShot(backoffDelayMs(), this, [this]() {
+    if (m_isRunning && m_useStandby && !m_standby)
+      m_standby = spawn(true);
+  });
+}
+
+static MetricGauge &workerDownGauge() {
+  static MetricGauge &gauge = MetricsRegistry::instance().gauge(
+      "guardian_ai_worker_down", "1 while no AI worker is delivering frames");
+  return gauge;
+}
+
+void PythonAiManager::markDown() {
+  if (m_stats.down)
+    return;
+  m_stats.down = true;
+  workerDownGauge().set(1);
+  m_downSince.start();
+  emit workerStatsChanged(m_stats);
+}
+
+void PythonAiManager::markUp() {
+  if (!m_runningSince.isValid())
+    m_runningSince.start();
+  if (!m_stats.down)
+    return;
+  m_stats.down = false;
+  workerDownGauge().set(0);
+  m_stats.lastDowntimeMs = m_downSince.elapsed();
+  m_stats.totalDowntimeMs += m_stats.lastDowntimeMs;
+  qDebug() << "PythonAiManager: 影像恢復，停機" << m_stats.lastDowntimeMs
+           << "ms (當機" << m_stats.crashes << "/ 卡死" << m_stats.hangs
+           << "/ 重啟" << m_stats.restarts << "/ 備援接手" << m_stats.failovers
+           << ")";
+  emit workerStatsChanged(m_stats);
+}
+
+void PythonAiManager::parseLine(const QJsonObject &obj) {
   // 檢查狀態訊息
   if (obj.contains("status")) {
     QString status = obj["status"].toString();
@@ -134,49 +417,106 @@ void PythonAiManager::parseLine(const QByteArray &line) {
   }
 
   if (obj.contains("img")) {
-    QString base64Img = obj["img"].toString();
-    QByteArray imgData = QByteArray::fromBase64(base64Img.toUtf8());
-    QImage img;
-    img.loadFromData(imgData, "JPG");
-    if (!img.isNull()) {
-      emit frameReady(img);
+    static MetricsRegistry &metrics = MetricsRegistry::instance();
+    static MetricCounter &frames = metrics.counter(
+        "guardian_ai_frames_total", "Preview frames received from the worker");
+    static MetricCounter &skipped = metrics.counter(
+        "guardian_ai_frames_dropped_total",
+        "Preview frames not delivered to the UI", "reason=\"flow_control\"");
+    static MetricCounter &corrupt = metrics.counter(
+        "guardian_ai_frames_dropped_total",
+        "Preview frames not delivered to the UI", "reason=\"decode_error\"");
+    static MetricHistogram &base64Time = metrics.histogram(
+        "guardian_ai_decode_seconds", "Time spent decoding preview frames",
+        "stage=\"base64\"");
+    static MetricHistogram &jpegTime = metrics.histogram(
+        "guardian_ai_decode_seconds", "Time spent decoding preview frames",
+        "stage=\"jpeg\"");
+
+    // forced = 依 min_fps 產生的影格，不消耗 credit
+    const bool credited = !obj["forced"].toBool();
+    const quint64 seq = quint64(obj["seq"].toDouble());
+    frames.inc();
+    // seq 為擷取序號：跳號代表 worker 因沒有 credit 而略過編碼
+    if (m_lastImageSeq && seq > m_lastImageSeq + 1)
+      skipped.inc(seq - m_lastImageSeq - 1);
+    m_lastImageSeq = seq;
+
+    QByteArray imgData;
+    {
+      TRACE_SCOPE("ai.base64_decode");
+      MetricTimer timer(base64Time);
+      imgData = QByteArray::fromBase64(obj["img"].toString().toLatin1());
+    }
+    emit compressedFrameReady(imgData, seq, nowMs());
+    // 預覽關閉時不必解碼；UI 還有 m_creditWindow 張沒畫完時也不再送
+    // (forced 影格不受 credit 限制)，GUI 佇列裡最多只有這麼多張 QImage
+    bool shown = false;
+    if (m_preview && m_unshown.size() >= m_creditWindow) {
+      skipped.inc();
+    } else if (m_preview) {
+      QImage img;
+      {
+        TRACE_SCOPE("ai.jpeg_decode");
+        MetricTimer timer(jpegTime);
+        img.loadFromData(imgData, "JPG");
+      }
+      if (!img.isNull()) {
+        m_unshown.enqueue(credited);
+        emit frameReady(img);
+        shown = true;
+      } else {
+        corrupt.inc();
+      }
     }
+    // 不會送到 UI 的影格收到時就歸還 credit
+    if (!shown && credited && m_outstanding > 0)
+      m_outstanding--;
   }
 
+  // 只有帶偵測欄位的影格才進入融合 (狀態訊息不算一幀)
+  if (!obj.contains("pig_detected") && !obj.contains("person_detected"))
+    return;
+  TRACE_SCOPE("ai.detection_dispatch");
+  markUp();
+
+  auto toRect = [](const QJsonValue &v) {
+    QJsonArray a = v.toArray();
+    if (a.size() != 4)
+      return QRect();
+    return QRect(QPoint(a[0].toInt(), a[1].toInt()),
+                 QPoint(a[2].toInt(), a[3].toInt()));
+  };
+
   bool pigDetected = obj["pig_detected"].toBool();
   bool personDetected = obj["person_detected"].toBool();
   QString faceId = obj["face_id"].toString();
+  quint64 seq = obj.contains("seq") ? quint64(obj["seq"].toDouble())
+                                    : ++m_frameSeq;
+  m_frameSeq = seq;
 
   // --- 優化判斷邏輯：優先相信人臉，減少誤報 ---
+  QVector<DetectionObservation> observations;
+  DetectionObservation obs;
   if (personDetected) {
-    if (faceId.contains("OWNER")) {
-      emit detectionAlert("owner", 0.95);
-    } else {
-      // 這裡不論是 STRANGER 還是 Human 都當作陌生人
-      emit detectionAlert("stranger", 0.92);
-    }
+    // 這裡不論是 STRANGER 還是 Human 都當作陌生人
+    obs.type = faceId.contains("OWNER") ? "owner" : "stranger";
+    obs.confidence = obj["face_conf"].toDouble(0.5);
+    obs.bbox = toRect(obj["face_bbox"]);
+    observations.append(obs);
   } else if (pigDetected) {
     // 只有在沒看到人臉，且看到豬的情況下才直接警報
-    emit detectionAlert("pig", 0.99);
+    obs.type = "pig";
+    obs.confidence = obj["pig_conf"].toDouble(0.5);
+    obs.bbox = toRect(obj["pig_bbox"]);
+    observations.append(obs);
   }
-}
 
-void PythonAiManager::handleProcessError(QProcess::ProcessError error) {
-  if (error == QProcess::Crashed && !m_isRunning) {
-    // 忽略在停止過程中觸發的 Crashed 錯誤 (SIGTERM 常見現象)
-    return;
+  const QVector<DetectionEvent> events =
+      m_fusion.update(observations, seq, nowMs());
+  for (const DetectionEvent &ev : events) {
+    qDebug() << "PythonAiManager:" << ev.type << (ev.entered ? "進入" : "離開")
+             << "峰值信心度" << ev.peakConfidence;
+    emit detectionStateChanged(ev);
   }
-  qDebug() << "PythonAiManager: 進程錯誤" << error;
-  emit errorOccurred("AI 系統啟動錯誤");
-}
-
-void PythonAiManager::handleProcessFinished(int exitCode,
-                                            QProcess::ExitStatus exitStatus) {
-  if (exitStatus == QProcess::NormalExit || exitCode == 15 || exitCode == 0) {
-    qDebug() << "PythonAiManager: AI 系統已正常關閉 (代碼:" << exitCode << ")";
-  } else {
-    qDebug() << "PythonAiManager: AI 系統異常結束，退出碼:" << exitCode
-             << " 狀態:" << exitStatus;
-  }
-  m_isRunning = false;
 }
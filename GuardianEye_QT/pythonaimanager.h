@@ -1,39 +1,131 @@
 #ifndef PYTHONAIMANAGER_H
 #define PYTHONAIMANAGER_H
 
-#include <QObject>
-#include <QProcess>
-#include <QImage>
-#include <QJsonDocument>
+#include "aiworkerprocess.h"
+#include "inferencebackend.h"
 #include <QJsonObject>
-#include <QByteArray>
+#include <QQueue>
 
-class PythonAiManager : public QObject {
+class QTimer;
+class WorkerStreamRecorder;
+class WorkerStreamReplay;
+
+struct AiWorkerStats {
+  quint64 crashes = 0;      // 非預期結束
+  quint64 hangs = 0;        // 心跳逾時而被強制結束
+  quint64 restarts = 0;     // 冷啟動 (需重新載入模型)
+  quint64 failovers = 0;    // 由預熱的備援行程接手
+  qint64 totalDowntimeMs = 0;
+  qint64 lastDowntimeMs = 0;
+  bool down = false;        // 目前沒有可用的影格來源
+};
+
+/**
+ * PythonAiManager
+ * vision_system.py 的監督者：以心跳偵測當機/卡死，依指數退避重新啟動，
+ * 並可維持一個已載入模型的備援行程 (GUARDIAN_AI_STANDBY=1)，
+ * 主行程失效時只需送出 activate 指令即可在開啟攝影機後接手
+ *
+ * 預覽影格採信用額度流量控制：依顯示速率發放 credit，worker 每編碼一張
+ * 影格消耗一點；偵測結果不受限制，不會被預覽的背壓拖慢
+ *
+ * GUARDIAN_AI_RECORD=<檔案> 錄製主要 worker 的原始 stdout；
+ * GUARDIAN_AI_REPLAY=<檔案> 改為重播錄製檔而不啟動 python3
+ * (GUARDIAN_AI_REPLAY_SPEED：1 = 原始間隔，預設；0 = 盡快)。
+ * 重播時融合與事件時間戳採用錄製時間軸，同一份錄製檔的偵測結果可重現
+ */
+class PythonAiManager : public InferenceBackend {
     Q_OBJECT
 public:
     explicit PythonAiManager(QObject *parent = nullptr);
     ~PythonAiManager();
 
+    AiWorkerStats stats() const { return m_stats; }
+
+    bool isReplay() const { return m_replay != nullptr; }
+    // 重播時間軸的起點 (開始重播時的牆上時間)，事件時間戳減去此值即錄製內的時間
+    qint64 replayEpochMs() const { return m_replayEpochMs; }
+
+    // 處理 worker 輸出的一行 JSON (一般由目前的 worker 呼叫；
+    // 效能量測與重播可直接餵入)
+    void parseLine(const QJsonObject &obj);
+
 public slots:
-    void start();  // 啟動 Python 進程
-    void stop();   // 停止 Python 進程
+    void start() override;  // 啟動 Python 進程
+    void stop() override;   // 停止 Python 進程
+    void setPreviewEnabled(bool enabled) override;
+    void setMinimumFrameRate(int fps) override;
+    void previewFrameShown() override;
 
 signals:
-    void frameReady(QImage img);
-    void detectionAlert(QString type, double confidence);
-    void errorOccurred(QString msg);
-    void statusChanged(QString status);
+    void workerStatsChanged(const AiWorkerStats &stats);
+    // 錄製檔播放完畢 (或無法載入，此時含 "error")
+    void replayFinished(const QJsonObject &report);
 
 private slots:
-    void handleReadyRead();
-    void handleProcessError(QProcess::ProcessError error);
-    void handleProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void handleMessage(const QJsonObject &obj);
+    void handleActiveExited(int exitCode, bool crashed);
+    void handleStandbyExited(int exitCode, bool crashed);
+    void checkHealth();
+    void grantCredits();
 
 private:
-    QProcess *m_process;
-    QByteArray m_buffer;
+    AiWorkerProcess *m_active = nullptr;
+    AiWorkerProcess *m_standby = nullptr;
+    QTimer *m_watchdog;
+    QTimer *m_restartTimer;
+    QString m_workingDir;
+    QString m_script = "vision_system.py";
     bool m_isRunning;
-    void parseLine(const QByteArray &line);
+    bool m_useStandby = false;
+
+    // 監督參數
+    int m_hangTimeoutMs = 5000;     // 執行中超過此時間沒有影格視為卡死
+    int m_startupTimeoutMs = 90000; // 載入模型 + 開啟攝影機的上限
+    int m_backoffBaseMs = 500;
+    int m_backoffMaxMs = 30000;
+    int m_stableMs = 60000;         // 穩定執行這麼久後重置退避
+    int m_failures = 0;
+    bool m_hangKill = false;        // 由看門狗強制結束，不計入當機
+    QElapsedTimer m_runningSince;
+    QElapsedTimer m_downSince;
+    AiWorkerStats m_stats;
+
+    DetectionFusion m_fusion;
+    quint64 m_frameSeq = 0;
+    quint64 m_lastImageSeq = 0; // 統計因流量控制而略過的預覽影格
+
+    // 錄製/重播
+    WorkerStreamRecorder *m_recorder = nullptr;
+    WorkerStreamReplay *m_replay = nullptr;
+    AiWorkerProcess *m_replayWorker = nullptr; // 不啟動行程，只負責切行與解析
+    qint64 m_replayEpochMs = 0;
+    qint64 m_replayClockMs = 0;
+    quint64 m_replayMessages = 0;
+    quint64 m_replayFrames = 0;
+
+    // 預覽流量控制
+    QTimer *m_creditTimer;
+    bool m_preview = true;
+    int m_previewFps = 20;  // 發放 credit 的速率 = 預覽顯示上限
+    int m_creditWindow = 2; // 最多允許幾張影格在途 (已授權但 UI 尚未畫出)
+    int m_outstanding = 0;
+    QQueue<bool> m_unshown; // 已送往 UI 尚未畫出的影格，true = 消耗了 credit
+    int m_minFps = 0;       // 預覽關閉時仍需的最低影格率 (0 = 不需要)
+
+    AiWorkerProcess *spawn(bool standby);
+    void startReplay();
+    qint64 nowMs() const;
+    void attachActive(AiWorkerProcess *worker);
+    void sendPreviewState();
+    void failover();
+    int backoffDelayMs() const;
+    void scheduleRestart();
+    void scheduleStandby();
+    void markDown();
+    void markUp();
 };
 
+Q_DECLARE_METATYPE(AiWorkerStats)
+
 #endif // PYTHONAIMANAGER_H
@@ -1,4 +1,5 @@
 #include "securitycontroller.h"
+#include "tracing.h"
 #include <QDateTime>
 
 SecurityController::SecurityController(QObject *parent) : QObject(parent) {
@@ -7,6 +8,7 @@ SecurityController::SecurityController(QObject *parent) : QObject(parent) {
 }
 
 void SecurityController::verifyPassword(const QString &input) {
+  TRACE_SCOPE("security.verifyPassword");
   bool success = false;
 
   // 1. 如果有隨機碼 (處於警報解鎖狀態)，優先驗證隨機碼
@@ -0,0 +1,193 @@
+#include "sensoracquisition.h"
+#include "timerwheel.h"
+#include <QDebug>
+#include <QThread>
+#include <QTimer>
+
+SensorAcquisition::SensorAcquisition(QObject *parent) : QObject(parent) {}
+
+void SensorAcquisition::start() {
+  if (m_adc)
+    return;
+
+  // ADC 介面在擷取執行緒上建立，bit-bang 初始化也不會卡住 UI
+  m_adc = new Mcp3008Interface(this);
+  m_timer = new QTimer(this);
+  m_timer->setSingleShot(true);
+  m_timer->setTimerType(Qt::PreciseTimer);
+  connect(m_timer, &QTimer::timeout, this, &SensorAcquisition::acquire);
+
+  m_clock.start();
+  qint64 now = m_clock.nsecsElapsed();
+  for (int ch = 0; ch < 8; ch++)
+    m_nextDueNs[ch] = now;
+
+  qDebug() << "SensorAcquisition: 擷取執行緒已啟動";
+  scheduleNext();
+}
+
+void SensorAcquisition::stop() {
+  if (m_timer)
+    m_timer->stop();
+}
+
+void SensorAcquisition::setChannelRate(int channel, double hz) {
+  if (channel < 0 || channel > 7)
+    return;
+  m_periodNs[channel] = (hz > 0) ? qint64(1e9 / hz) : 0;
+  if (m_clock.isValid()) {
+    m_nextDueNs[channel] = m_clock.nsecsElapsed();
+    scheduleNext();
+  }
+}
+
+void SensorAcquisition::scheduleNext() {
+  if (!m_timer)
+    return;
+
+  qint64 earliest = -1;
+  for (int ch = 0; ch < 8; ch++) {
+    if (m_periodNs[ch] > 0 && (earliest < 0 || m_nextDueNs[ch] < earliest))
+      earliest = m_nextDueNs[ch];
+  }
+  if (earliest < 0) {
+    m_timer->stop();
+    return;
+  }
+
+  qint64 waitNs = earliest - m_clock.nsecsElapsed();
+  m_timer->start(waitNs > 0 ? int((waitNs + 999999) / 1000000) : 0);
+}
+
+void SensorAcquisition::acquire() {
+  qint64 now = m_clock.nsecsElapsed();
+
+  // 收集所有到期的通道，以一次掃描讀取
+  quint8 mask = 0;
+  for (int ch = 0; ch < 8; ch++) {
+    if (m_periodNs[ch] <= 0 || m_nextDueNs[ch] > now)
+      continue;
+    mask |= (1 << ch);
+
+    qint64 jitter = now - m_nextDueNs[ch];
+    m_sumJitterNs += jitter;
+    m_dueChannels++;
+    if (jitter > m_maxJitterNs)
+      m_maxJitterNs = jitter;
+
+    m_nextDueNs[ch] += m_periodNs[ch];
+    if (m_nextDueNs[ch] <= now) {
+      // 落後超過一個週期：不補讀，直接對齊到下一個週期
+      m_missedDeadlines++;
+      m_nextDueNs[ch] = now + m_periodNs[ch];
+    }
+  }
+
+  if (mask) {
+    QVector<AdcSample> samples = m_adc->scanChannels(mask, m_oversample);
+    qint64 latency = m_clock.nsecsElapsed() - now;
+    m_scans++;
+    m_sumReadLatencyNs += latency;
+    if (latency > m_maxReadLatencyNs)
+      m_maxReadLatencyNs = latency;
+
+    for (const AdcSample &s : samples) {
+      if (s.value < 0)
+        continue;
+      if (m_ring.push(s))
+        m_samples++;
+      else
+        m_overruns++;
+    }
+  }
+
+  scheduleNext();
+}
+
+int SensorAcquisition::drain(QVector<AdcSample> &out) {
+  AdcSample s;
+  int n = 0;
+  while (m_ring.pop(s)) {
+    out.append(s);
+    n++;
+  }
+  return n;
+}
+
+SensorStats SensorAcquisition::stats() const {
+  SensorStats st;
+  st.samples = m_samples;
+  st.scans = m_scans;
+  st.overruns = m_overruns;
+  st.missedDeadlines = m_missedDeadlines;
+  st.maxJitterNs = m_maxJitterNs;
+  st.maxReadLatencyNs = m_maxReadLatencyNs;
+  // 抖動以每個到期通道計算 (含讀取失敗的通道)，讀取延遲以每次掃描計算
+  const quint64 dueCount = m_dueChannels;
+  st.meanJitterNs = dueCount ? qint64(m_sumJitterNs / qint64(dueCount)) : 0;
+  st.meanReadLatencyNs =
+      st.scans ? qint64(m_sumReadLatencyNs / qint64(st.scans)) : 0;
+  return st;
+}
+
+SensorDispatcher::SensorDispatcher(SensorAcquisition *source,
+                                   TimerWheel *timers, QObject *parent)
+    : QObject(parent), m_source(source), m_timers(timers) {}
+
+int SensorDispatcher::subscribe(int channel, int intervalMs, QObject *context,
+                                Callback callback) {
+  Subscription sub;
+  sub.channel = channel;
+  sub.intervalMs = intervalMs;
+  sub.context = context;
+  sub.callback = callback;
+  sub.lastDelivery.start();
+
+  int id = m_nextId++;
+  m_subscriptions.insert(id, sub);
+
+  // 以最快的訂閱者決定清空 ring 的頻率 (上限 20ms 一次)，
+  // 允許延後四分之一個週期以便與其他輪詢共用喚醒
+  int tick = intervalMs;
+  for (const Subscription &s : m_subscriptions)
+    tick = qMin(tick, s.intervalMs);
+  tick = qMax(20, tick);
+  m_slackMs = tick / 4;
+  m_timers->scheduleRepeating(
+      "sensors.dispatch", tick, this, [this]() { dispatch(); }, m_slackMs);
+  return id;
+}
+
+void SensorDispatcher::unsubscribe(int id) {
+  m_subscriptions.remove(id);
+  if (m_subscriptions.isEmpty())
+    m_timers->cancel("sensors.dispatch");
+}
+
+void SensorDispatcher::dispatch() {
+  m_scratch.clear();
+  m_source->drain(m_scratch);
+
+  for (auto it = m_subscriptions.begin(); it != m_subscriptions.end(); ++it) {
+    Subscription &sub = it.value();
+    for (const AdcSample &s : m_scratch) {
+      if (s.channel == sub.channel)
+        sub.pending.append(s);
+    }
+
+    // 喚醒時間可能在 slack 內浮動，差距在 slack 內視為已到期
+    if (sub.pending.isEmpty() ||
+        sub.lastDelivery.elapsed() + m_slackMs < sub.intervalMs)
+      continue;
+    sub.lastDelivery.restart();
+
+    QVector<AdcSample> batch;
+    batch.swap(sub.pending);
+    if (!sub.context || sub.context->thread() == QThread::currentThread()) {
+      sub.callback(batch);
+    } else {
+      Callback cb = sub.callback;
+      QTimer::singleShot(0, sub.context, [cb, batch]() { cb(batch); });
+    }
+  }
+}
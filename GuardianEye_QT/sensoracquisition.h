@@ -0,0 +1,114 @@
+#ifndef SENSORACQUISITION_H
+#define SENSORACQUISITION_H
+
+#include "mcp3008interface.h"
+#include "spscring.h"
+#include <QElapsedTimer>
+#include <QMap>
+#include <QObject>
+#include <QVector>
+#include <atomic>
+#include <functional>
+
+class QTimer;
+class TimerWheel;
+
+// 取樣統計 (皆為自啟動以來的累計值，單位 ns)
+struct SensorStats {
+  quint64 samples = 0;
+  quint64 scans = 0;
+  quint64 overruns = 0;        // ring 已滿而丟棄的樣本
+  quint64 missedDeadlines = 0; // 落後超過一個週期而重新對齊的次數
+  qint64 maxJitterNs = 0;
+  qint64 meanJitterNs = 0;
+  qint64 maxReadLatencyNs = 0;
+  qint64 meanReadLatencyNs = 0;
+};
+
+/**
+ * SensorAcquisition
+ * 在專屬執行緒上依各通道設定的頻率讀取 MCP3008，
+ * 並將帶時間戳記的樣本寫入無鎖 SPSC ring，由 SensorDispatcher 取出
+ */
+class SensorAcquisition : public QObject {
+  Q_OBJECT
+public:
+  explicit SensorAcquisition(QObject *parent = nullptr);
+
+  SensorStats stats() const;
+
+  // 消費端 (僅限單一執行緒) 取出所有待處理樣本
+  int drain(QVector<AdcSample> &out);
+
+public slots:
+  void start(); // 在擷取執行緒上呼叫：建立 ADC 介面並開始排程
+  void stop();
+  void setChannelRate(int channel, double hz); // hz <= 0 表示停用該通道
+  void setOversample(int oversample) { m_oversample = oversample; }
+
+private slots:
+  void acquire();
+
+private:
+  Mcp3008Interface *m_adc = nullptr;
+  QTimer *m_timer = nullptr;
+  QElapsedTimer m_clock;
+  int m_oversample = 1;
+
+  qint64 m_periodNs[8] = {0};
+  qint64 m_nextDueNs[8] = {0};
+
+  SpscRing<AdcSample, 1024> m_ring;
+
+  std::atomic<quint64> m_samples{0};
+  std::atomic<quint64> m_scans{0};
+  std::atomic<quint64> m_overruns{0};
+  std::atomic<quint64> m_missedDeadlines{0};
+  std::atomic<qint64> m_maxJitterNs{0};
+  std::atomic<qint64> m_sumJitterNs{0};
+  std::atomic<quint64> m_dueChannels{0}; // m_sumJitterNs 累計的通道數
+  std::atomic<qint64> m_maxReadLatencyNs{0};
+  std::atomic<qint64> m_sumReadLatencyNs{0};
+
+  void scheduleNext();
+};
+
+/**
+ * SensorDispatcher
+ * 位於消費端執行緒，定期清空 ring 並依各訂閱者自己的頻率批次分發樣本；
+ * callback 會在 context 物件所屬的執行緒執行
+ */
+class SensorDispatcher : public QObject {
+  Q_OBJECT
+public:
+  typedef std::function<void(const QVector<AdcSample> &)> Callback;
+
+  SensorDispatcher(SensorAcquisition *source, TimerWheel *timers,
+                   QObject *parent = nullptr);
+
+  int subscribe(int channel, int intervalMs, QObject *context,
+                Callback callback);
+  void unsubscribe(int id);
+
+private slots:
+  void dispatch();
+
+private:
+  struct Subscription {
+    int channel;
+    int intervalMs;
+    QObject *context;
+    Callback callback;
+    QVector<AdcSample> pending;
+    QElapsedTimer lastDelivery;
+  };
+
+  SensorAcquisition *m_source;
+  TimerWheel *m_timers;
+  int m_slackMs = 0; // 清空 ring 允許延後的時間
+  QMap<int, Subscription> m_subscriptions;
+  QVector<AdcSample> m_scratch;
+  int m_nextId = 1;
+};
+
+#endif // SENSORACQUISITION_H
@@ -0,0 +1,102 @@
+#include "signalfilter.h"
+#include <algorithm>
+
+SignalFilter::SignalFilter() : SignalFilter(Config()) {}
+
+SignalFilter::SignalFilter(const Config &config) : m_config(config) {
+  m_config.medianWindow = qBound(1, m_config.medianWindow, 64);
+  reset();
+}
+
+void SignalFilter::reset() {
+  m_window.clear();
+  m_windowPos = 0;
+  m_filtered = 0;
+  m_lastTsNs = 0;
+  m_primed = false;
+  m_level = -1;
+  m_candidate = -1;
+  m_candidateSinceNs = 0;
+}
+
+bool SignalFilter::ingest(const QVector<AdcSample> &samples) {
+  bool changed = false;
+  for (const AdcSample &s : samples) {
+    if (s.value >= 0 && ingest(s.value, s.timestampNs))
+      changed = true;
+  }
+  return changed;
+}
+
+bool SignalFilter::ingest(int value, qint64 timestampNs) {
+  // 1. 中位數：去除單點突波
+  if (m_window.size() < m_config.medianWindow) {
+    m_window.append(value);
+  } else {
+    m_window[m_windowPos] = value;
+    m_windowPos = (m_windowPos + 1) % m_config.medianWindow;
+  }
+  int sorted[64];
+  int n = m_window.size();
+  std::copy(m_window.constBegin(), m_window.constBegin() + n, sorted);
+  std::nth_element(sorted, sorted + n / 2, sorted + n);
+  double median = sorted[n / 2];
+
+  // 2. EMA 平滑 + 3. 變化率限制
+  if (!m_primed) {
+    m_filtered = median;
+    m_primed = true;
+  } else {
+    double next = m_filtered + m_config.emaAlpha * (median - m_filtered);
+    if (m_config.maxSlewPerSec > 0 && timestampNs > m_lastTsNs) {
+      double maxStep =
+          m_config.maxSlewPerSec * (timestampNs - m_lastTsNs) / 1e9;
+      next = qBound(m_filtered - maxStep, next, m_filtered + maxStep);
+    }
+    m_filtered = next;
+  }
+  m_lastTsNs = timestampNs;
+
+  // 4. 遲滯門檻
+  int target = classify(m_filtered);
+  if (m_level < 0) {
+    m_level = target; // 第一個樣本直接建立初始狀態
+    return true;
+  }
+  if (target == m_level) {
+    m_candidate = -1;
+    return false;
+  }
+
+  // 5. 最短停留時間：新 level 必須持續 minDwellMs 才成立
+  if (target != m_candidate) {
+    m_candidate = target;
+    m_candidateSinceNs = timestampNs;
+  }
+  if (timestampNs - m_candidateSinceNs >= m_config.minDwellMs * 1000000LL) {
+    m_level = m_candidate;
+    m_candidate = -1;
+    return true;
+  }
+  return false;
+}
+
+int SignalFilter::classify(double value) const {
+  const double half = m_config.hysteresis / 2.0;
+  int level = (m_level < 0) ? 0 : m_level;
+  const int maxLevel = m_config.thresholds.size();
+
+  if (m_level < 0) {
+    // 尚無狀態時不套用死區
+    while (level < maxLevel && value >= m_config.thresholds[level])
+      level++;
+    return level;
+  }
+
+  // 往上需超過門檻 + half，往下需低於門檻 - half
+  while (level < maxLevel && value >= m_config.thresholds[level] + half)
+    level++;
+  while (level > 0 && value < m_config.thresholds[level - 1] - half)
+    level--;
+  return level;
+}
@@ -0,0 +1,50 @@
+#ifndef SIGNALFILTER_H
+#define SIGNALFILTER_H
+
+#include "mcp3008interface.h"
+#include <QVector>
+
+/**
+ * SignalFilter
+ * 串流式感測器濾波：中位數 -> EMA -> 變化率限制 -> 多段遲滯門檻 -> 最短停留時間
+ * 一次餵入一批樣本，只有在濾波後的狀態 (level) 真正改變時才回報
+ */
+class SignalFilter {
+public:
+  struct Config {
+    int medianWindow = 5;       // 1 = 不做中位數
+    double emaAlpha = 0.3;      // 1.0 = 不做平滑
+    double maxSlewPerSec = 0;   // 每秒最大變化量，0 = 不限制
+    QVector<int> thresholds;    // 由小到大，N 個門檻切出 N+1 個 level
+    int hysteresis = 40;        // 門檻上下各 hysteresis/2 的死區
+    qint64 minDwellMs = 2000;   // 新 level 需持續這麼久才會成立
+  };
+
+  SignalFilter();
+  explicit SignalFilter(const Config &config);
+
+  // 回傳 true 表示本批樣本造成 level 改變
+  bool ingest(const QVector<AdcSample> &samples);
+  bool ingest(int value, qint64 timestampNs);
+
+  int level() const { return m_level; }
+  int value() const { return int(m_filtered + 0.5); }
+  bool hasValue() const { return m_level >= 0; }
+  void reset();
+
+private:
+  Config m_config;
+  QVector<int> m_window;
+  int m_windowPos = 0;
+  double m_filtered = 0;
+  qint64 m_lastTsNs = 0;
+  bool m_primed = false;
+
+  int m_level = -1;
+  int m_candidate = -1;
+  qint64 m_candidateSinceNs = 0;
+
+  int classify(double value) const;
+};
+
+#endif // SIGNALFILTER_H
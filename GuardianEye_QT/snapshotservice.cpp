@@ -0,0 +1,190 @@
+#include "snapshotservice.h"
+#include <QBuffer>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QImage>
+#include <QSaveFile>
+#include <QTimer>
+#include <QtAlgorithms>
+
+// --- SnapshotWorker (背景執行緒) ---
+
+void SnapshotWorker::process(const QString &type, const QByteArray &jpeg,
+                             const QRect &bbox, qint64 timestampMs) {
+  QImage image;
+  if (!image.loadFromData(jpeg, "JPG")) {
+    emit snapshotFailed(type);
+    return;
+  }
+
+  // 裁切偵測框 (含邊界)，沒有框時使用整張影格
+  QRect crop = image.rect();
+  if (bbox.isValid()) {
+    int dx = int(bbox.width() * m_config.margin);
+    int dy = int(bbox.height() * m_config.margin);
+    crop = bbox.adjusted(-dx, -dy, dx, dy).intersected(image.rect());
+    if (crop.isEmpty())
+      crop = image.rect();
+  }
+  const bool whole = crop == image.rect();
+  QImage cropped = whole ? image : image.copy(crop);
+
+  // 冷卻時間內與上一張相似則不再輸出
+  const quint64 hash = dHash(cropped);
+  const Last &last = m_last[type];
+  if (!last.fullPath.isEmpty() &&
+      timestampMs - last.timestampMs < m_config.cooldownMs &&
+      int(qPopulationCount(hash ^ last.hash)) <= m_config.duplicateBits) {
+    qDebug() << "SnapshotWorker: 與上一張快照相似，略過" << type;
+    emit snapshotReady(type, last.fullPath, last.thumbPath, true);
+    return;
+  }
+
+  // 沒有裁切時直接沿用原始 JPEG，不重新編碼
+  const QByteArray full = whole ? jpeg : encodeJpeg(cropped, 85);
+  const QByteArray thumb = encodeJpeg(
+      cropped.width() > m_config.thumbWidth
+          ? cropped.scaledToWidth(m_config.thumbWidth, Qt::SmoothTransformation)
+          : cropped,
+      70);
+
+  QDir dir(m_config.dir);
+  dir.mkpath(".");
+  const QString stamp = QDateTime::fromMSecsSinceEpoch(timestampMs)
+                            .toString("yyyyMMdd_HHmmss_zzz");
+  const QString fullPath = dir.filePath(QString("snap_%1_%2.jpg").arg(stamp, type));
+  const QString thumbPath =
+      dir.filePath(QString("snap_%1_%2_thumb.jpg").arg(stamp, type));
+
+  if (!writeAtomically(fullPath, full) || !writeAtomically(thumbPath, thumb)) {
+    emit snapshotFailed(type);
+    return;
+  }
+  // 舊的固定路徑仍保留給既有的 Discord/Web 端
+  writeAtomically(dir.filePath("alert.jpg"), full);
+  writeAtomically(dir.filePath("alert_thumb.jpg"), thumb);
+
+  Last &entry = m_last[type];
+  entry.hash = hash;
+  entry.timestampMs = timestampMs;
+  entry.fullPath = fullPath;
+  entry.thumbPath = thumbPath;
+
+  emit snapshotReady(type, fullPath, thumbPath, false);
+}
+
+quint64 SnapshotWorker::dHash(const QImage &image) {
+  // 9x8 灰階，每列比較相鄰像素得到 64 bits
+  QImage small = image.scaled(9, 8, Qt::IgnoreAspectRatio,
+                               Qt::SmoothTransformation)
+                     .convertToFormat(QImage::Format_Grayscale8);
+  quint64 hash = 0;
+  for (int y = 0; y < 8; y++) {
+    const uchar *row = small.constScanLine(y);
+    for (int x = 0; x < 8; x++) {
+      hash <<= 1;
+      if (row[x] < row[x + 1])
+        hash |= 1;
+    }
+  }
+  return hash;
+}
+
+QByteArray SnapshotWorker::encodeJpeg(const QImage &image, int quality) {
+  QByteArray data;
+  QBuffer buffer(&data);
+  buffer.open(QIODevice::WriteOnly);
+  image.save(&buffer, "JPG", quality);
+  return data;
+}
+
+bool SnapshotWorker::writeAtomically(const QString &path,
+                                     const QByteArray &data) {
+  // QSaveFile 先寫暫存檔再 rename，讀取端不會看到寫一半的影像
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly)) {
+    qDebug() << "SnapshotWorker: 無法寫入" << path << file.errorString();
+    return false;
+  }
+  file.write(data);
+  return file.commit();
+}
+
+// --- SnapshotService ---
+
+SnapshotService::SnapshotService(QObject *parent)
+    : SnapshotService(SnapshotWorker::Config(), parent) {}
+
+SnapshotService::SnapshotService(const SnapshotWorker::Config &config,
+                                 QObject *parent)
+    : QObject(parent), m_thread(new QThread(this)),
+      m_worker(new SnapshotWorker(config)) {
+  qRegisterMetaType<DetectionEvent>("DetectionEvent");
+
+  m_worker->moveToThread(m_thread);
+  connect(m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+  connect(m_worker, &SnapshotWorker::snapshotReady, this,
+          &SnapshotService::snapshotReady);
+  connect(m_worker, &SnapshotWorker::snapshotFailed, this,
+          &SnapshotService::snapshotFailed);
+  m_thread->start(QThread::LowPriority);
+}
+
+SnapshotService::~SnapshotService() {
+  m_thread->quit();
+  m_thread->wait();
+}
+
+void SnapshotService::addFrame(const QByteArray &jpeg, quint64 seq,
+                               qint64 timestampMs) {
+  Frame frame;
+  frame.jpeg = jpeg;
+  frame.seq = seq;
+  frame.timestampMs = timestampMs;
+  m_history.enqueue(frame);
+  while (m_history.size() > HISTORY)
+    m_history.dequeue();
+}
+
+void SnapshotService::noteDetection(const DetectionEvent &event) {
+  if (event.entered)
+    m_events[event.type] = event;
+}
+
+void SnapshotService::capture(const QString &type) {
+  if (m_history.isEmpty()) {
+    emit snapshotFailed(type);
+    return;
+  }
+
+  // 有近期的進入事件時取最接近偵測框所屬影格 (峰值信心度那一幀) 的影格，
+  // 否則 (例如手動觸發) 使用最新影格且不裁切。
+  // 預覽影格不是每幀都有：找不到同一幀時不裁切，避免框到別的位置
+  const Frame *best = &m_history.last();
+  QRect bbox;
+  auto it = m_events.constFind(type);
+  if (it != m_events.constEnd() &&
+      QDateTime::currentMSecsSinceEpoch() - it->timestampMs <
+          EVENT_MAX_AGE_MS) {
+    const quint64 target = it->bboxSeq ? it->bboxSeq : it->frameSeq;
+    quint64 bestDiff = ~0ULL;
+    for (const Frame &frame : m_history) {
+      quint64 diff =
+          frame.seq > target ? frame.seq - target : target - frame.seq;
+      if (diff < bestDiff) {
+        bestDiff = diff;
+        best = &frame;
+      }
+    }
+    if (bestDiff == 0)
+      bbox = it->bbox;
+  }
+
+  SnapshotWorker *worker = m_worker;
+  const QByteArray jpeg = best->jpeg;
+  const qint64 ts = best->timestampMs;
+  QTimer::singleShot(0, worker, [worker, type, jpeg, bbox, ts]() {
+    worker->process(type, jpeg, bbox, ts);
+  });
+}
@@ -0,0 +1,94 @@
+#ifndef SNAPSHOTSERVICE_H
+#define SNAPSHOTSERVICE_H
+
+#include "detectionfusion.h"
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QQueue>
+#include <QThread>
+
+/**
+ * SnapshotWorker
+ * 在背景執行緒解碼觸發影格、裁切偵測框並輸出原尺寸與縮圖，
+ * 以 QSaveFile 原子寫入；冷卻時間內與上一張相似 (dHash) 的快照直接略過
+ */
+class SnapshotWorker : public QObject {
+  Q_OBJECT
+public:
+  struct Config {
+    QString dir = "/tmp/guardian_images";
+    qint64 cooldownMs = 30000; // 此時間內的相似快照視為重複
+    int duplicateBits = 6;     // dHash 漢明距離 <= 此值視為相似
+    int thumbWidth = 160;
+    double margin = 0.2;       // 偵測框四周額外保留的比例
+  };
+
+  explicit SnapshotWorker(const Config &config, QObject *parent = nullptr)
+      : QObject(parent), m_config(config) {}
+
+  void process(const QString &type, const QByteArray &jpeg, const QRect &bbox,
+               qint64 timestampMs);
+
+signals:
+  // duplicate = true 時 fullPath/thumbPath 為上一張快照
+  void snapshotReady(const QString &type, const QString &fullPath,
+                     const QString &thumbPath, bool duplicate);
+  void snapshotFailed(const QString &type);
+
+private:
+  struct Last {
+    quint64 hash = 0;
+    qint64 timestampMs = 0;
+    QString fullPath;
+    QString thumbPath;
+  };
+
+  Config m_config;
+  QHash<QString, Last> m_last;
+
+  static quint64 dHash(const QImage &image);
+  static bool writeAtomically(const QString &path, const QByteArray &data);
+  static QByteArray encodeJpeg(const QImage &image, int quality);
+};
+
+/**
+ * SnapshotService
+ * 保存最近數十張 JPEG 影格與各類別最新的進入事件，警報時依事件的影格序號
+ * 挑出觸發影格交給 SnapshotWorker；capture() 只做查表與投遞，不會阻塞警報路徑
+ */
+class SnapshotService : public QObject {
+  Q_OBJECT
+public:
+  explicit SnapshotService(QObject *parent = nullptr);
+  SnapshotService(const SnapshotWorker::Config &config,
+                  QObject *parent = nullptr);
+  ~SnapshotService();
+
+public slots:
+  void addFrame(const QByteArray &jpeg, quint64 seq, qint64 timestampMs);
+  void noteDetection(const DetectionEvent &event);
+  void capture(const QString &type);
+
+signals:
+  void snapshotReady(const QString &type, const QString &fullPath,
+                     const QString &thumbPath, bool duplicate);
+  void snapshotFailed(const QString &type);
+
+private:
+  struct Frame {
+    QByteArray jpeg;
+    quint64 seq = 0;
+    qint64 timestampMs = 0;
+  };
+
+  static const int HISTORY = 32;
+  static const qint64 EVENT_MAX_AGE_MS = 10000;
+
+  QQueue<Frame> m_history;
+  QHash<QString, DetectionEvent> m_events;
+  QThread *m_thread;
+  SnapshotWorker *m_worker;
+};
+
+#endif // SNAPSHOTSERVICE_H
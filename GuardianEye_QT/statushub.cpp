@@ -0,0 +1,190 @@
+#include "statushub.h"
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QTcpSocket>
+#include <QTimer>
+
+// 訂閱者積壓超過此量代表已失聯，直接斷線讓它以 Last-Event-ID 重新接上
+static const qint64 MAX_BACKLOG_BYTES = 256 * 1024;
+
+StatusHub::StatusHub(HttpServer *server) : StatusHub(server, Config()) {}
+
+StatusHub::StatusHub(HttpServer *server, const Config &config)
+    : QObject(nullptr), m_config(config), m_keepAlive(new QTimer(this)) {
+  // 版本號以啟動時間起算：行程重啟後舊客戶端的 Last-Event-ID 必定落在
+  // 環形緩衝區之外而改收快照，不會誤以為已是最新
+  m_version = quint64(QDateTime::currentMSecsSinceEpoch());
+  m_history.reserve(m_config.historySize);
+  m_keepAlive->setInterval(m_config.keepAliveMs);
+  connect(m_keepAlive, &QTimer::timeout, this, &StatusHub::sendKeepAlive);
+
+  // 與 socket 同一執行緒，狀態與訂閱者清單都不需上鎖
+  moveToThread(server->serverThread());
+  connect(server->serverThread(), &QThread::finished, this,
+          &QObject::deleteLater);
+
+  server->route("/api/status",
+                [this](QTcpSocket *socket, const HttpRequest &request) {
+                  handleStatus(socket, request);
+                });
+  server->route("/api/events",
+                [this](QTcpSocket *socket, const HttpRequest &request) {
+                  subscribe(socket, request);
+                });
+}
+
+void StatusHub::update(const QJsonObject &fields) {
+  if (QThread::currentThread() == thread())
+    applyUpdate(fields);
+  else
+    QTimer::singleShot(0, this, [this, fields]() { applyUpdate(fields); });
+}
+
+void StatusHub::applyUpdate(const QJsonObject &fields) {
+  // 只保留真的改變的欄位，倒數每秒更新也只會送出 countdown 兩個欄位
+  QJsonObject delta;
+  for (auto it = fields.constBegin(); it != fields.constEnd(); ++it) {
+    if (it.value().isNull() || it.value().isUndefined()) {
+      if (m_state.contains(it.key())) {
+        m_state.remove(it.key());
+        delta.insert(it.key(), QJsonValue::Null);
+      }
+    } else if (m_state.value(it.key()) != it.value()) {
+      m_state.insert(it.key(), it.value());
+      delta.insert(it.key(), it.value());
+    }
+  }
+  if (delta.isEmpty())
+    return;
+
+  const quint64 version = ++m_version;
+  delta.insert("version", qint64(version));
+  Delta entry;
+  entry.version = version;
+  entry.event = "id: " + QByteArray::number(version) + "\nevent: delta\ndata: " +
+                QJsonDocument(delta).toJson(QJsonDocument::Compact) + "\n\n";
+
+  if (m_history.size() < m_config.historySize) {
+    m_history.append(entry);
+  } else {
+    m_history[m_historyHead] = entry;
+    m_historyHead = (m_historyHead + 1) % m_history.size();
+  }
+
+  // abort() 會同步觸發 disconnected 而修改清單，先複製一份
+  const QList<QTcpSocket *> subscribers = m_subscribers;
+  for (QTcpSocket *socket : subscribers) {
+    if (socket->bytesToWrite() > MAX_BACKLOG_BYTES) {
+      socket->abort();
+      continue;
+    }
+    socket->write(entry.event);
+  }
+
+  // 長輪詢者等的就是這次變動：回應完整快照後結束
+  const QList<QTcpSocket *> waiters = m_waiters;
+  m_waiters.clear();
+  for (QTcpSocket *socket : waiters)
+    respondSnapshot(socket);
+}
+
+void StatusHub::subscribe(QTcpSocket *socket, const HttpRequest &request) {
+  if (m_subscribers.size() >= m_config.maxSubscribers) {
+    HttpServer::respond(socket, 503, "text/plain", "too many subscribers\n",
+                        "Retry-After: 5\r\n");
+    return;
+  }
+
+  m_subscribers.append(socket);
+  m_subscriberCount = m_subscribers.size();
+  connect(socket, &QTcpSocket::disconnected, this,
+          [this, socket]() { dropSocket(socket); });
+  if (!m_keepAlive->isActive())
+    m_keepAlive->start();
+
+  socket->write("HTTP/1.1 200 OK\r\n"
+                "Content-Type: text/event-stream\r\n"
+                "Cache-Control: no-cache\r\n"
+                "X-Accel-Buffering: no\r\n"
+                "Connection: close\r\n\r\n"
+                "retry: 3000\n\n");
+
+  // EventSource 重連時會帶 Last-Event-ID；手動測試可用 ?since=
+  QByteArray lastId = request.headers.value("last-event-id");
+  if (lastId.isEmpty())
+    lastId = request.query.queryItemValue("since").toLatin1();
+  bool ok = false;
+  const quint64 since = lastId.toULongLong(&ok);
+  if (!ok || !replaySince(socket, since))
+    socket->write(snapshotEvent());
+}
+
+void StatusHub::handleStatus(QTcpSocket *socket, const HttpRequest &request) {
+  bool ok = false;
+  const quint64 since =
+      request.query.queryItemValue("since").toULongLong(&ok);
+  if (!ok || since != m_version) {
+    respondSnapshot(socket);
+    return;
+  }
+
+  // 客戶端已是最新版本：掛起直到下次變動，逾時則回應同一版本
+  m_waiters.append(socket);
+  connect(socket, &QTcpSocket::disconnected, this,
+          [this, socket]() { dropSocket(socket); });
+  QTimer::singleShot(m_config.longPollTimeoutMs, socket, [this, socket]() {
+    if (m_waiters.removeOne(socket))
+      respondSnapshot(socket);
+  });
+}
+
+void StatusHub::respondSnapshot(QTcpSocket *socket) {
+  HttpServer::respond(socket, 200, "application/json", snapshotJson());
+}
+
+void StatusHub::sendKeepAlive() {
+  if (m_subscribers.isEmpty()) {
+    m_keepAlive->stop(); // 沒有訂閱者時完全不喚醒
+    return;
+  }
+  for (QTcpSocket *socket : m_subscribers) {
+    if (socket->bytesToWrite() == 0)
+      socket->write(": keep-alive\n\n");
+  }
+}
+
+void StatusHub::dropSocket(QTcpSocket *socket) {
+  if (m_subscribers.removeOne(socket))
+    m_subscriberCount = m_subscribers.size();
+  m_waiters.removeOne(socket);
+}
+
+bool StatusHub::replaySince(QTcpSocket *socket, quint64 since) const {
+  if (since > m_version)
+    return false; // 系統時鐘被調回過，保守起見送快照
+  if (since == m_version)
+    return true;
+
+  const quint64 oldest = m_version - quint64(m_history.size()) + 1;
+  if (m_history.isEmpty() || since + 1 < oldest)
+    return false; // 缺口已被覆寫，改送快照
+
+  // m_historyHead 指向最舊的一筆 (緩衝區未滿時為 0)
+  for (int i = 0; i < m_history.size(); i++) {
+    const Delta &entry = m_history[(m_historyHead + i) % m_history.size()];
+    if (entry.version > since)
+      socket->write(entry.event);
+  }
+  return true;
+}
+
+QByteArray StatusHub::snapshotJson() const {
+  QJsonObject snapshot = m_state;
+  snapshot.insert("version", qint64(m_version));
+  return QJsonDocument(snapshot).toJson(QJsonDocument::Compact);
+}
+
+QByteArray StatusHub::snapshotEvent() const {
+  return "id: " + QByteArray::number(quint64(m_version)) +
+         "\nevent: snapshot\ndata: " + snapshotJson() + "\n\n";
+}
@@ -0,0 +1,74 @@
+#ifndef STATUSHUB_H
+#define STATUSHUB_H
+
+#include "httpserver.h"
+#include <QByteArray>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QVector>
+#include <atomic>
+
+class QTcpSocket;
+class QTimer;
+
+/**
+ * StatusHub
+ * 把警報/倒數/解鎖/感測器狀態以記憶體中的單一 JSON 物件對外提供：
+ *  - GET /api/status          完整快照 (含 version)
+ *  - GET /api/status?since=N  長輪詢：版本已更新立即回應，否則等到下次變動或逾時
+ *  - GET /api/events          SSE，先送 snapshot，之後每次變動送一筆 delta
+ * 每筆 delta 帶遞增的 version 作為 SSE id，最近的 delta 保留在環形緩衝區；
+ * 重新連線帶 Last-Event-ID 時只補送缺少的 delta，太舊才重送快照。
+ * 閒置訂閱者只佔一個 socket，整個 hub 只有一個 keep-alive 計時器
+ */
+class StatusHub : public QObject {
+  Q_OBJECT
+public:
+  struct Config {
+    int historySize = 256;        // 可補送的 delta 數量
+    int keepAliveMs = 25000;      // SSE 註解心跳，避免代理伺服器斷線
+    int longPollTimeoutMs = 25000;
+    int maxSubscribers = 400;
+  };
+
+  // 物件會被移到伺服器執行緒，不可設 parent；隨伺服器執行緒結束而釋放
+  explicit StatusHub(HttpServer *server);
+  StatusHub(HttpServer *server, const Config &config);
+
+  quint64 version() const { return m_version; }
+  int subscriberCount() const { return m_subscriberCount; }
+
+public slots:
+  // 任意執行緒呼叫；只有值真的改變的欄位才會成為 delta (null 代表移除欄位)
+  void update(const QJsonObject &fields);
+
+private:
+  struct Delta {
+    quint64 version;
+    QByteArray event; // 已編碼好的 SSE 區塊，所有訂閱者共用
+  };
+
+  Config m_config;
+  QJsonObject m_state;
+  QVector<Delta> m_history; // 環形緩衝區
+  int m_historyHead = 0;
+  QList<QTcpSocket *> m_subscribers;
+  QList<QTcpSocket *> m_waiters; // 長輪詢
+  QTimer *m_keepAlive;
+
+  std::atomic<quint64> m_version{0};
+  std::atomic<int> m_subscriberCount{0};
+
+  void applyUpdate(const QJsonObject &fields);
+  void subscribe(QTcpSocket *socket, const HttpRequest &request);
+  void handleStatus(QTcpSocket *socket, const HttpRequest &request);
+  void respondSnapshot(QTcpSocket *socket);
+  void sendKeepAlive();
+  void dropSocket(QTcpSocket *socket);
+  bool replaySince(QTcpSocket *socket, quint64 since) const;
+  QByteArray snapshotJson() const;
+  QByteArray snapshotEvent() const;
+};
+
+#endif // STATUSHUB_H
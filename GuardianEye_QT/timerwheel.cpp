@@ -0,0 +1,268 @@
+#include "timerwheel.h"
+#include "metrics.h"
+#include <QTimer>
+#include <climits>
+
+static MetricGauge &pendingGauge() {
+  static MetricGauge &gauge = MetricsRegistry::instance().gauge(
+      "guardian_timer_pending", "Deadlines waiting on the timer wheel");
+  return gauge;
+}
+
+TimerWheel::TimerWheel(QObject *parent) : TimerWheel(Config(), parent) {}
+
+TimerWheel::TimerWheel(const Config &config, QObject *parent)
+    : QObject(parent), m_config(config), m_timer(new QTimer(this)) {
+  m_config.tickMs = qMax(1, m_config.tickMs);
+  m_clock.start();
+
+  // 喚醒時間已依 slack 選定，不再讓 Qt 自行調整 (CoarseTimer 會再偏移 5%)
+  m_timer->setSingleShot(true);
+  m_timer->setTimerType(Qt::PreciseTimer);
+  connect(m_timer, &QTimer::timeout, this, [this]() {
+    static MetricCounter &wakeups = MetricsRegistry::instance().counter(
+        "guardian_timer_wakeups_total", "Timer wheel wakeups");
+    static MetricGauge &rate = MetricsRegistry::instance().gauge(
+        "guardian_timer_wakeups_per_second",
+        "Timer wheel wakeups per second over the last stats window");
+    wakeups.inc();
+
+    const qint64 now = nowMs();
+    m_windowWakeups++;
+    if (now - m_windowStartMs >= m_config.statsWindowMs) {
+      m_wakeupsPerSecond = m_windowWakeups * 1000.0 / (now - m_windowStartMs);
+      rate.set(m_wakeupsPerSecond);
+      m_windowStartMs = now;
+      m_windowWakeups = 0;
+    }
+
+    advance();
+    rearm();
+  });
+}
+
+TimerWheel::~TimerWheel() { qDeleteAll(m_entries); }
+
+void TimerWheel::schedule(const QString &key, int delayMs, QObject *context,
+                          Action action, int slackMs) {
+  insert(key, nowMs() + qMax(0, delayMs), 0, context, std::move(action),
+         slackMs);
+}
+
+void TimerWheel::scheduleRepeating(const QString &key, int intervalMs,
+                                   QObject *context, Action action,
+                                   int slackMs) {
+  intervalMs = qMax(1, intervalMs);
+  // 對齊到排程器時間的下一個週期點，讓不同週期的輪詢盡量同時到期
+  const qint64 due = (nowMs() / intervalMs + 1) * intervalMs;
+  insert(key, due, intervalMs, context, std::move(action), slackMs);
+}
+
+bool TimerWheel::cancel(const QString &key) {
+  Entry *e = m_entries.take(key);
+  if (!e)
+    return false;
+  unlink(e);
+  delete e;
+  pendingGauge().set(m_entries.size());
+  // 已設定的喚醒保留：最多多醒一次，醒來時會重新計算
+  if (m_entries.isEmpty() && !m_advancing) {
+    m_timer->stop();
+    m_armedTick = -1;
+  }
+  return true;
+}
+
+void TimerWheel::insert(const QString &key, qint64 dueMs, int intervalMs,
+                        QObject *context, Action action, int slackMs) {
+  static MetricCounter &replaced = MetricsRegistry::instance().counter(
+      "guardian_timer_replaced_total",
+      "Deadlines replaced by a newer schedule of the same key");
+
+  // 輪上沒有項目時把目前 tick 拉到現在，新項目不必從很久以前開始 cascade
+  if (m_entries.isEmpty() && !m_advancing)
+    m_nextTick = qMax(m_nextTick, nowMs() / m_config.tickMs);
+
+  Entry *e = m_entries.value(key);
+  if (e) {
+    replaced.inc();
+    unlink(e);
+  } else {
+    e = new Entry;
+    e->key = key;
+    m_entries.insert(key, e);
+  }
+  e->intervalMs = intervalMs;
+  e->slackMs = slackMs < 0 ? m_config.defaultSlackMs : slackMs;
+  e->hasContext = context != nullptr;
+  e->context = context;
+  e->action = std::move(action);
+  setDeadline(e, dueMs);
+  place(e);
+  pendingGauge().set(m_entries.size());
+
+  // 執行動作期間的排程由 advance 結束後統一重新設定
+  if (m_advancing)
+    return;
+  if (!m_timer->isActive() || e->latestTick < m_armedTick) {
+    m_armedTick = e->latestTick;
+    const qint64 delay = m_armedTick * m_config.tickMs - nowMs();
+    m_timer->start(int(qBound<qint64>(0, delay, INT_MAX)));
+  }
+}
+
+void TimerWheel::setDeadline(Entry *e, qint64 dueMs) {
+  const int tick = m_config.tickMs;
+  const int slack = m_config.coalesce ? e->slackMs : 0;
+  e->dueMs = dueMs;
+  // 不早於下一個尚未處理的 tick：已處理過的 tick 不會再被喚醒處理
+  e->dueTick = qMax((dueMs + tick - 1) / tick, m_nextTick);
+  e->latestTick = qMax(e->dueTick, (dueMs + slack) / tick);
+}
+
+void TimerWheel::place(Entry *e) {
+  qint64 expires = e->dueTick;
+  const qint64 delta = expires - m_nextTick;
+  int level = 0;
+  int index;
+  if (delta < 0) {
+    // 已經過期：放在下一個要處理的槽
+    index = int(m_nextTick & kMask);
+  } else {
+    while (level < kLevels - 1 && delta >= (qint64(1) << (kBits * (level + 1))))
+      level++;
+    // 超過最上層範圍者先放在最遠的槽，cascade 時再依實際期限放置
+    const qint64 maxDelta = (qint64(1) << (kBits * kLevels)) - 1;
+    if (delta > maxDelta)
+      expires = m_nextTick + maxDelta;
+    index = int((expires >> (kBits * level)) & kMask);
+  }
+
+  Entry **head = &m_slots[level][index];
+  e->next = *head;
+  if (e->next)
+    e->next->pprev = &e->next;
+  e->pprev = head;
+  *head = e;
+  e->level = level;
+  m_levelCount[level]++;
+}
+
+void TimerWheel::unlink(Entry *e) {
+  if (e->level < 0)
+    return;
+  *e->pprev = e->next;
+  if (e->next)
+    e->next->pprev = e->pprev;
+  m_levelCount[e->level]--;
+  e->level = -1;
+  e->next = nullptr;
+  e->pprev = nullptr;
+}
+
+void TimerWheel::cascade(int level, int index) {
+  Entry *list = m_slots[level][index];
+  m_slots[level][index] = nullptr;
+  while (list) {
+    Entry *e = list;
+    list = e->next;
+    m_levelCount[level]--;
+    e->level = -1;
+    place(e);
+  }
+}
+
+void TimerWheel::runTick() {
+  const int index = int(m_nextTick & kMask);
+  // 第 0 層繞完一圈：從上層搬下一個區塊 (上層也繞完時繼續往上)
+  if (index == 0) {
+    for (int level = 1; level < kLevels; level++) {
+      const int i = int((m_nextTick >> (kBits * level)) & kMask);
+      cascade(level, i);
+      if (i != 0)
+        break;
+    }
+  }
+
+  // 整串取下再逐一執行：動作內可能排程或取消其他項目 (含同一串的)
+  Entry *expired = m_slots[0][index];
+  m_slots[0][index] = nullptr;
+  if (expired)
+    expired->pprev = &expired;
+  m_nextTick++;
+
+  const qint64 now = nowMs();
+  while (expired) {
+    Entry *e = expired;
+    unlink(e);
+    fire(e, now);
+  }
+}
+
+void TimerWheel::fire(Entry *e, qint64 now) {
+  static MetricCounter &fired = MetricsRegistry::instance().counter(
+      "guardian_timer_fired_total", "Timer wheel actions run");
+  static MetricHistogram &lateness = MetricsRegistry::instance().histogram(
+      "guardian_timer_lateness_seconds",
+      "Delay between a deadline and its action running (includes slack)");
+
+  if (e->hasContext && !e->context) {
+    m_entries.remove(e->key);
+    delete e;
+    return;
+  }
+  fired.inc();
+  lateness.observe(qMax<qint64>(0, now - e->dueMs) / 1000.0);
+
+  Action action;
+  if (e->intervalMs > 0) {
+    // 以 due 累加維持週期；錯過的週期直接略過，不補跑
+    qint64 due = e->dueMs + e->intervalMs;
+    if (due <= now)
+      due += ((now - due) / e->intervalMs + 1) * e->intervalMs;
+    setDeadline(e, due);
+    place(e);
+    action = e->action; // 動作內可能取消自己，先複製
+  } else {
+    m_entries.remove(e->key);
+    action = std::move(e->action);
+    delete e;
+  }
+  action();
+}
+
+void TimerWheel::advance() {
+  const qint64 target = qMax(nowMs() / m_config.tickMs, m_armedTick);
+  m_advancing = true;
+  while (m_nextTick <= target) {
+    if (m_levelCount[0] == 0 && (m_nextTick & kMask) != 0) {
+      // 第 0 層是空的：直接跳到下一個 cascade 邊界
+      const qint64 boundary = (m_nextTick | kMask) + 1;
+      if (boundary > target) {
+        m_nextTick = target + 1;
+        break;
+      }
+      m_nextTick = boundary;
+    }
+    runTick();
+  }
+  m_advancing = false;
+  pendingGauge().set(m_entries.size());
+}
+
+void TimerWheel::rearm() {
+  if (m_entries.isEmpty()) {
+    m_timer->stop();
+    m_armedTick = -1;
+    return;
+  }
+  // 下次喚醒 = 所有項目最晚時間中的最早者；項目只有數十個，直接掃描
+  qint64 wake = LLONG_MAX;
+  for (const Entry *e : qAsConst(m_entries))
+    wake = qMin(wake, e->latestTick);
+  if (m_timer->isActive() && wake == m_armedTick)
+    return;
+  m_armedTick = wake;
+  const qint64 delay = wake * m_config.tickMs - nowMs();
+  m_timer->start(int(qBound<qint64>(0, delay, INT_MAX)));
+}
@@ -0,0 +1,102 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <functional>
+
+class QTimer;
+
+/**
+ * TimerWheel
+ * 裝置與控制器期限的集中排程 (階層式時間輪，4 層 x 64 槽)：
+ *  - 每個動作以 key 識別，重複排程同一個 key 會取代前一次
+ *    (連按兩次開門只會保留最後一次「關門」)，cancel(key) 可隨時取消
+ *  - 每個期限是一個區間 [due, due + slack]：整個排程器只有一個 QTimer，
+ *    設在所有項目最晚時間中的最早者；醒來時把已進入區間的項目一起執行，
+ *    期限相近的動作因此共用一次喚醒
+ *  - 週期項目以排程器啟動時間為基準對齊週期 (500ms 與 1s 的輪詢會落在
+ *    同一刻)，之後以 due 累加，不隨延遲漂移
+ * 只能在擁有者執行緒使用；context 被刪除後對應的動作不再執行
+ */
+class TimerWheel : public QObject {
+  Q_OBJECT
+public:
+  struct Config {
+    int tickMs = 10;         // 時間輪的最小粒度
+    int defaultSlackMs = 50; // slackMs < 0 時使用
+    bool coalesce = true;    // false：忽略 slack，一律準時喚醒 (比較用)
+    int statsWindowMs = 10000; // 每秒喚醒次數的統計區間
+  };
+
+  typedef std::function<void()> Action;
+
+  explicit TimerWheel(QObject *parent = nullptr);
+  TimerWheel(const Config &config, QObject *parent = nullptr);
+  ~TimerWheel();
+
+  // delayMs 後 (最多再晚 slackMs) 執行一次
+  void schedule(const QString &key, int delayMs, QObject *context,
+                Action action, int slackMs = -1);
+  // 每 intervalMs 執行一次，直到 cancel
+  void scheduleRepeating(const QString &key, int intervalMs, QObject *context,
+                         Action action, int slackMs = -1);
+  bool cancel(const QString &key);
+  bool isPending(const QString &key) const { return m_entries.contains(key); }
+  int pendingCount() const { return m_entries.size(); }
+
+  // 最近一個統計區間內的每秒喚醒次數
+  double wakeupsPerSecond() const { return m_wakeupsPerSecond; }
+
+private:
+  static const int kLevels = 4;
+  static const int kBits = 6;
+  static const int kSlots = 1 << kBits;
+  static const qint64 kMask = kSlots - 1;
+
+  struct Entry {
+    QString key;
+    qint64 dueMs;
+    qint64 dueTick;
+    qint64 latestTick;
+    int intervalMs; // 0 = 單次
+    int slackMs;
+    bool hasContext;
+    QPointer<QObject> context;
+    Action action;
+    int level = -1; // 不在輪上時為 -1
+    Entry *next = nullptr;
+    Entry **pprev = nullptr;
+  };
+
+  Config m_config;
+  QElapsedTimer m_clock;
+  QTimer *m_timer;
+  QHash<QString, Entry *> m_entries;
+  Entry *m_slots[kLevels][kSlots] = {};
+  int m_levelCount[kLevels] = {};
+  qint64 m_nextTick = 0;   // 下一個尚未處理的 tick
+  qint64 m_armedTick = -1; // QTimer 目前設定的喚醒 tick
+  bool m_advancing = false;
+
+  qint64 m_windowStartMs = 0;
+  quint64 m_windowWakeups = 0;
+  double m_wakeupsPerSecond = 0;
+
+  void insert(const QString &key, qint64 dueMs, int intervalMs,
+              QObject *context, Action action, int slackMs);
+  void setDeadline(Entry *e, qint64 dueMs);
+  void place(Entry *e);
+  void unlink(Entry *e);
+  void cascade(int level, int index);
+  void runTick();
+  void fire(Entry *e, qint64 nowMs);
+  void advance();
+  void rearm();
+  qint64 nowMs() const { return m_clock.elapsed(); }
+};
+
+#endif // TIMERWHEEL_H
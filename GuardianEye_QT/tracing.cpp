@@ -0,0 +1,244 @@
+#include "tracing.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QQueue>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <QThreadStorage>
+#include <QVector>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+std::atomic<bool> Tracer::s_enabled{false};
+
+namespace {
+
+// 每個緩衝區約 8192 * 24 bytes。開啟追蹤時先配置 PREALLOCATED 個放進閒置清單，
+// 執行緒第一次記錄時取用，執行緒結束時歸還；總量只跟同時記錄的執行緒數有關
+struct TraceRing {
+  static const quint64 CAPACITY = 8192;
+  struct Slot {
+    std::atomic<const char *> name{nullptr};
+    std::atomic<qint64> beginNs{0};
+    std::atomic<qint64> endNs{0};
+  };
+
+  std::atomic<quint64> head{0}; // 已寫入的總筆數 (只有擁有者執行緒遞增)
+  Slot slots[CAPACITY];
+  // 以下受 g_ringsMutex 保護，於取用時設定
+  std::atomic<quint32> generation{0}; // 每次被新的執行緒取用時遞增
+  quint64 base = 0; // 取用時的 head，之前的槽位屬於上一個執行緒
+  int tid = 0;
+  QByteArray threadName;
+};
+
+struct TraceEvent {
+  const char *name;
+  qint64 beginNs;
+  qint64 endNs;
+};
+
+const int PREALLOCATED = 16;
+
+// 已結束執行緒的緩衝區在被重用前內容照舊保留，警報後仍能匯出它們的 span；
+// 重用時從最早歸還的開始
+QMutex g_ringsMutex;
+QVector<TraceRing *> g_rings; // 所有緩衝區
+QQueue<TraceRing *> g_free;   // 預先配置或執行緒已結束的緩衝區
+thread_local TraceRing *t_ring = nullptr;
+
+void preallocateRings() {
+  QMutexLocker locker(&g_ringsMutex);
+  while (g_rings.size() < PREALLOCATED) {
+    TraceRing *ring = new TraceRing;
+    g_rings.append(ring);
+    g_free.enqueue(ring);
+  }
+}
+
+// 隨執行緒結束而刪除 (QThreadStorage)，把緩衝區歸還閒置清單
+struct RingLease {
+  TraceRing *ring;
+  ~RingLease() {
+    t_ring = nullptr; // 結束過程中若再記錄，不能寫進已歸還的緩衝區
+    QMutexLocker locker(&g_ringsMutex);
+    g_free.enqueue(ring);
+  }
+};
+
+TraceRing *threadRing() {
+  if (t_ring)
+    return t_ring;
+  static QThreadStorage<RingLease *> leases;
+
+  const int tid = int(syscall(SYS_gettid));
+  char name[32] = {0};
+  const QByteArray threadName =
+      pthread_getname_np(pthread_self(), name, sizeof(name)) == 0 && name[0]
+          ? QByteArray(name)
+          : QByteArray("thread-") + QByteArray::number(tid);
+
+  TraceRing *ring;
+  {
+    QMutexLocker locker(&g_ringsMutex);
+    if (!g_free.isEmpty()) {
+      ring = g_free.dequeue();
+    } else {
+      // 同時記錄的執行緒多於預先配置的數量時才配置
+      ring = new TraceRing;
+      g_rings.append(ring);
+    }
+    ring->generation.fetch_add(1, std::memory_order_relaxed);
+    ring->base = ring->head.load(std::memory_order_relaxed);
+    ring->tid = tid;
+    ring->threadName = threadName;
+  }
+  leases.setLocalData(new RingLease{ring});
+  t_ring = ring;
+  return ring;
+}
+
+QByteArray jsonString(const QByteArray &s) {
+  QByteArray out = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\')
+      out += '\\';
+    if (uchar(c) >= 0x20)
+      out += c;
+  }
+  return out + "\"";
+}
+
+QByteArray microseconds(qint64 ns) {
+  return QByteArray::number(ns / 1000) + "." +
+         QByteArray::number(ns % 1000).rightJustified(3, '0');
+}
+
+class TraceDumpTask : public QRunnable {
+public:
+  TraceDumpTask(const QString &path, qint64 sinceNs)
+      : m_path(path), m_sinceNs(sinceNs) {}
+
+  void run() override {
+    QDir().mkpath(QFileInfo(m_path).absolutePath());
+    QSaveFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+      qDebug() << "Tracer: 無法寫入" << m_path;
+      return;
+    }
+    file.write(Tracer::chromeJson(m_sinceNs));
+    if (file.commit())
+      qDebug() << "Tracer: 已輸出追蹤檔" << m_path;
+  }
+
+private:
+  QString m_path;
+  qint64 m_sinceNs;
+};
+
+} // namespace
+
+void Tracer::setEnabled(bool enabled) {
+  // 先配置好緩衝區，記錄時不必再配置
+  if (enabled)
+    preallocateRings();
+  if (s_enabled.exchange(enabled) != enabled)
+    qDebug() << "Tracer: 追蹤" << (enabled ? "開啟" : "關閉");
+}
+
+void Tracer::registerThread() { threadRing(); }
+
+int Tracer::ringCount() {
+  QMutexLocker locker(&g_ringsMutex);
+  return g_rings.size();
+}
+
+void Tracer::record(const char *name, qint64 beginNs, qint64 endNs) {
+  TraceRing *ring = threadRing();
+  const quint64 index = ring->head.load(std::memory_order_relaxed);
+  TraceRing::Slot &slot = ring->slots[index & (TraceRing::CAPACITY - 1)];
+  slot.name.store(name, std::memory_order_relaxed);
+  slot.beginNs.store(beginNs, std::memory_order_relaxed);
+  slot.endNs.store(endNs, std::memory_order_relaxed);
+  ring->head.store(index + 1, std::memory_order_release);
+}
+
+QByteArray Tracer::chromeJson(qint64 sinceNs) {
+  const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+
+  // 取用資訊在鎖內複製；槽位在鎖外讀取，期間被重用的緩衝區整個略過
+  struct RingView {
+    TraceRing *ring;
+    quint32 generation;
+    quint64 base;
+    int tid;
+    QByteArray threadName;
+  };
+  QVector<RingView> rings;
+  {
+    QMutexLocker locker(&g_ringsMutex);
+    for (TraceRing *ring : g_rings) {
+      if (ring->head.load(std::memory_order_relaxed) > ring->base)
+        rings.append({ring, ring->generation.load(std::memory_order_relaxed),
+                      ring->base, ring->tid, ring->threadName});
+    }
+  }
+
+  QByteArray out;
+  out.reserve(1 << 20);
+  out += "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  bool first = true;
+  QVector<TraceEvent> events;
+  for (const RingView &view : rings) {
+    TraceRing *ring = view.ring;
+    // 擁有者執行緒仍在寫入：先複製，再丟棄複製期間可能已被覆寫的舊槽位
+    const quint64 head = ring->head.load(std::memory_order_acquire);
+    const quint64 start = qMax(
+        view.base, head > TraceRing::CAPACITY ? head - TraceRing::CAPACITY : 0);
+    events.clear();
+    events.reserve(int(head - start));
+    for (quint64 i = start; i < head; i++) {
+      const TraceRing::Slot &slot = ring->slots[i & (TraceRing::CAPACITY - 1)];
+      events.append({slot.name.load(std::memory_order_relaxed),
+                     slot.beginNs.load(std::memory_order_relaxed),
+                     slot.endNs.load(std::memory_order_relaxed)});
+    }
+    const quint64 after = ring->head.load(std::memory_order_acquire);
+    const quint64 overwritten =
+        after > TraceRing::CAPACITY ? after - TraceRing::CAPACITY : 0;
+    const int skip = overwritten > start ? int(overwritten - start) : 0;
+    if (ring->generation.load(std::memory_order_acquire) != view.generation)
+      continue;
+
+    const QByteArray tid = QByteArray::number(view.tid);
+    out += QByteArray(first ? "" : ",") +
+           "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + pid +
+           ",\"tid\":" + tid + ",\"args\":{\"name\":" +
+           jsonString(view.threadName) + "}}";
+    first = false;
+
+    for (int i = skip; i < events.size(); i++) {
+      const TraceEvent &e = events[i];
+      if (!e.name || e.endNs < sinceNs)
+        continue;
+      out += ",{\"name\":" + jsonString(e.name) + ",\"ph\":\"X\",\"ts\":" +
+             microseconds(e.beginNs) +
+             ",\"dur\":" + microseconds(e.endNs - e.beginNs) +
+             ",\"pid\":" + pid + ",\"tid\":" + tid + "}";
+    }
+  }
+  out += "]}\n";
+  return out;
+}
+
+void Tracer::dumpAsync(const QString &path, qint64 sinceNs) {
+  TraceDumpTask *task = new TraceDumpTask(path, sinceNs);
+  task->setAutoDelete(true);
+  QThreadPool::globalInstance()->start(task);
+}
@@ -0,0 +1,71 @@
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <QByteArray>
+#include <QString>
+#include <atomic>
+#include <time.h>
+
+/**
+ * Tracer
+ * 影格與警報路徑的 span 記錄器：每個執行緒一個固定大小的環形緩衝區，
+ * span 開始與結束各取一次 CLOCK_MONOTONIC，結束時寫入一筆 (name, begin, end)。
+ * 熱路徑只有一次 relaxed 讀取 (是否啟用) 與三個 relaxed 寫入，不上鎖、不配置記憶體；
+ * 開啟追蹤時預先配置一批緩衝區，執行緒第一次記錄時從閒置清單取用 (即時執行緒可先
+ * 呼叫 registerThread())，執行緒結束時歸還，內容保留到被其他執行緒重用為止。
+ * 匯出為 Chrome/Perfetto 可讀的 trace JSON (chrome://tracing、ui.perfetto.dev)。
+ *
+ * 預設編入、執行期關閉 (GUARDIAN_TRACE=1 或 HTTP /trace/control?enabled=1 開啟)；
+ * 以 qmake CONFIG+=notrace 建置時 TRACE_SCOPE 完全消失
+ */
+class Tracer {
+public:
+  static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+  static void setEnabled(bool enabled);
+
+  static qint64 nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return qint64(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+  }
+
+  // name 必須是生命週期涵蓋整個行程的字串 (字串常值或靜態表)
+  static void record(const char *name, qint64 beginNs, qint64 endNs);
+  static void registerThread();
+  // 目前配置的緩衝區數 (使用中 + 閒置)
+  static int ringCount();
+
+  // 各執行緒環形緩衝區中 sinceNs 之後結束的 span (0 = 全部)
+  static QByteArray chromeJson(qint64 sinceNs = 0);
+  // 在背景執行緒 (QThreadPool) 序列化並以 QSaveFile 寫檔
+  static void dumpAsync(const QString &path, qint64 sinceNs = 0);
+
+private:
+  static std::atomic<bool> s_enabled;
+};
+
+class TraceScope {
+public:
+  explicit TraceScope(const char *name)
+      : m_name(name), m_beginNs(Tracer::isEnabled() ? Tracer::nowNs() : 0) {}
+  ~TraceScope() {
+    if (m_beginNs)
+      Tracer::record(m_name, m_beginNs, Tracer::nowNs());
+  }
+
+private:
+  const char *m_name;
+  qint64 m_beginNs;
+};
+
+#ifdef GUARDIAN_TRACING
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name)
+#else
+#define TRACE_SCOPE(name)                                                      \
+  do {                                                                         \
+  } while (0)
+#endif
+
+#endif // TRACING_H
@@ -0,0 +1,127 @@
+#include "workerstream.h"
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QTimer>
+
+static const char STREAM_MAGIC[] = "GESTRM1\n";
+static const int STREAM_MAGIC_LEN = 8;
+
+WorkerStreamRecorder::WorkerStreamRecorder(const QString &path)
+    : m_file(path) {
+  QDir().mkpath(QFileInfo(path).absolutePath());
+  if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    qDebug() << "WorkerStreamRecorder: 無法寫入" << path;
+    return;
+  }
+  m_file.write(STREAM_MAGIC, STREAM_MAGIC_LEN);
+  m_stream.setDevice(&m_file);
+  qDebug() << "WorkerStreamRecorder: 錄製 worker 輸出至" << path;
+}
+
+void WorkerStreamRecorder::write(const QByteArray &chunk) {
+  if (!m_file.isOpen() || chunk.isEmpty())
+    return;
+  if (!m_clock.isValid())
+    m_clock.start();
+  m_stream << qint64(m_clock.nsecsElapsed()) << chunk;
+  // 每個區塊都落盤：行程當機時錄製檔仍可用來重現
+  m_file.flush();
+}
+
+WorkerStreamReplay::WorkerStreamReplay(const QString &path, double speed,
+                                       QObject *parent)
+    : QObject(parent), m_path(path), m_speed(speed) {}
+
+bool WorkerStreamReplay::load(QString *error) {
+  auto fail = [error](const QString &msg) {
+    if (error)
+      *error = msg;
+    return false;
+  };
+
+  QFile file(m_path);
+  if (!file.open(QIODevice::ReadOnly))
+    return fail(QString("無法開啟錄製檔 %1").arg(m_path));
+  if (file.read(STREAM_MAGIC_LEN) !=
+      QByteArray(STREAM_MAGIC, STREAM_MAGIC_LEN))
+    return fail(QString("%1 不是 worker 錄製檔").arg(m_path));
+
+  // 一次讀入：重播期間不讓磁碟 I/O 混進量測
+  QDataStream in(&file);
+  m_chunks.clear();
+  m_bytes = 0;
+  while (!in.atEnd()) {
+    Chunk chunk;
+    in >> chunk.offsetNs >> chunk.data;
+    if (in.status() != QDataStream::Ok) {
+      // 錄製中斷留下的半筆資料：保留前面完整的區塊
+      qDebug() << "WorkerStreamReplay: 錄製檔結尾不完整，已讀取"
+               << m_chunks.size() << "個區塊";
+      break;
+    }
+    m_bytes += chunk.data.size();
+    m_chunks.append(chunk);
+  }
+  m_next = 0;
+  if (m_chunks.isEmpty())
+    return fail(QString("%1 沒有任何區塊").arg(m_path));
+  return true;
+}
+
+void WorkerStreamReplay::start() {
+  m_next = 0;
+  m_maxLagNs = 0;
+  m_wall.start();
+  scheduleNext();
+}
+
+void WorkerStreamReplay::scheduleNext() {
+  if (isFinished()) {
+    m_wallNs = m_wall.nsecsElapsed();
+    emit finished();
+    return;
+  }
+  int delayMs = 0;
+  if (m_speed > 0) {
+    const qint64 dueNs = qint64(m_chunks[m_next].offsetNs / m_speed);
+    delayMs = int(qMax<qint64>(0, (dueNs - m_wall.nsecsElapsed()) / 1000000));
+  }
+  QTimer::singleShot(delayMs, Qt::PreciseTimer, this,
+                     &WorkerStreamReplay::emitNext);
+}
+
+void WorkerStreamReplay::emitNext() {
+  if (isFinished())
+    return;
+  const Chunk &chunk = m_chunks[m_next++];
+  if (m_speed > 0) {
+    const qint64 lagNs =
+        m_wall.nsecsElapsed() - qint64(chunk.offsetNs / m_speed);
+    m_maxLagNs = qMax(m_maxLagNs, lagNs);
+  }
+  emit chunkReady(chunk.data, chunk.offsetNs);
+  scheduleNext();
+}
+
+QJsonObject WorkerStreamReplay::stats() const {
+  const qint64 wallNs = isFinished() ? m_wallNs : m_wall.nsecsElapsed();
+  const double wallS = wallNs / 1e9;
+  const double streamS =
+      m_chunks.isEmpty() ? 0 : m_chunks.last().offsetNs / 1e9;
+  QJsonObject obj{{"file", m_path},
+                  {"speed", m_speed > 0 ? m_speed : 0},
+                  {"chunks", m_chunks.size()},
+                  {"chunks_replayed", m_next},
+                  {"bytes", double(m_bytes)},
+                  {"stream_s", streamS},
+                  {"wall_s", wallS}};
+  if (wallS > 0) {
+    obj.insert("chunks_per_s", m_next / wallS);
+    obj.insert("mb_per_s", m_bytes / wallS / (1024.0 * 1024.0));
+    obj.insert("realtime_factor", streamS / wallS);
+  }
+  if (m_speed > 0)
+    obj.insert("max_lag_ms", m_maxLagNs / 1e6);
+  return obj;
+}
@@ -0,0 +1,75 @@
+#ifndef WORKERSTREAM_H
+#define WORKERSTREAM_H
+
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonObject>
+#include <QObject>
+#include <QVector>
+
+/**
+ * worker 原始輸出的錄製與重播 (無頭量測整條 Qt 管線用)
+ *
+ * 檔案格式：8 bytes 標頭 "GESTRM1\n"，之後以 QDataStream 依序寫入
+ * (qint64 距第一個區塊的 ns, QByteArray 區塊)。區塊是 readAllStandardOutput()
+ * 讀到的原樣資料，不保證對齊行界，重播時交給同一份 AiWorkerProcess::feed()
+ * 切行與解析，才能重現管線實際看到的分段
+ */
+class WorkerStreamRecorder {
+public:
+  explicit WorkerStreamRecorder(const QString &path);
+
+  bool isOpen() const { return m_file.isOpen(); }
+  QString path() const { return m_file.fileName(); }
+  void write(const QByteArray &chunk);
+
+private:
+  QFile m_file;
+  QDataStream m_stream;
+  QElapsedTimer m_clock; // 第一個區塊開始計時，模型載入時間不進入錄製檔
+};
+
+/**
+ * WorkerStreamReplay
+ * 將整個錄製檔讀入記憶體後依原始間隔 (speed = 1)、加速/減速 (speed > 0)
+ * 或盡快 (speed <= 0) 逐一送出區塊；每個區塊都回到事件迴圈一次，
+ * 讓計時器、HTTP 與跨執行緒的佇列訊號照常運作
+ */
+class WorkerStreamReplay : public QObject {
+  Q_OBJECT
+public:
+  explicit WorkerStreamReplay(const QString &path, double speed = 1.0,
+                              QObject *parent = nullptr);
+
+  bool load(QString *error = nullptr);
+  void start();
+  bool isFinished() const { return m_next >= m_chunks.size(); }
+
+  // 檔案、區塊數、位元組、錄製長度、實際耗時、吞吐量與最大落後時間
+  QJsonObject stats() const;
+
+signals:
+  void chunkReady(const QByteArray &chunk, qint64 streamNs);
+  void finished();
+
+private:
+  struct Chunk {
+    qint64 offsetNs;
+    QByteArray data;
+  };
+
+  QString m_path;
+  double m_speed;
+  QVector<Chunk> m_chunks;
+  qint64 m_bytes = 0;
+  int m_next = 0;
+  QElapsedTimer m_wall;
+  qint64 m_wallNs = 0;
+  qint64 m_maxLagNs = 0; // 依原始間隔重播時，送出時間落後預定時間的最大值
+
+  void scheduleNext();
+  void emitNext();
+};
+
+#endif // WORKERSTREAM_H
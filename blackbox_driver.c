@@ -1,17 +1,46 @@
+#include <linux/atomic.h>
+#include <linux/debugfs.h>
 #include <linux/fs.h>
 #include <linux/gpio.h>
 #include <linux/ioctl.h>
 #include <linux/jiffies.h>
 #include <linux/kernel.h>
+#include <linux/math64.h>
 #include <linux/module.h>
+#include <linux/moduleparam.h>
+#include <linux/mutex.h>
+#include <linux/percpu.h>
+#include <linux/ratelimit.h>
 #include <linux/rtc.h>
+#include <linux/sched.h>
+#include <linux/seq_file.h>
 #include <linux/slab.h>
 #include <linux/timekeeping.h>
 #include <linux/timer.h>
 #include <linux/uaccess.h>
+#include <linux/vmalloc.h>
+
+#include "blackbox_ring.h"
 
 #define DEVICE_NAME "blackbox"
-#define BUFFER_SIZE 4096
+
+// 各優先級日誌保留的筆數 (每筆約 280 bytes，每個 CPU 各一份)：
+// INFO 洪水只會覆蓋 INFO；最新的 N 筆一定保留，分散在多顆 CPU 時可能保留更多。
+// 載入後可由 debugfs 的同名檔案調整，這裡的值會跟著更新
+#define BB_MAX_RECORDS 4096
+// 調整容量時每次持鎖最多搬移的筆數 (約 70 KB)，搬移之間寫入端照常寫入
+#define BB_RESIZE_CHUNK 256
+static int info_records = 128;
+static int warning_records = 64;
+static int critical_records = 64;
+module_param(info_records, int, 0444);
+MODULE_PARM_DESC(info_records, "INFO log capacity in records (default 128)");
+module_param(warning_records, int, 0444);
+MODULE_PARM_DESC(warning_records,
+                 "WARNING log capacity in records (default 64)");
+module_param(critical_records, int, 0444);
+MODULE_PARM_DESC(critical_records,
+                 "CRITICAL log capacity in records (default 64)");
 
 // 緊急倒數相關
 #define DEFAULT_COUNTDOWN_MINUTES 5
@@ -19,7 +48,6 @@ static struct timer_list emergency_timer;
 static int remaining_seconds = 0;
 static int emergency_active = 0;
 static DEFINE_SPINLOCK(emergency_lock);
-static DEFINE_SPINLOCK(log_lock); // 新增：保護日誌緩衝區的鎖
 
 // GPIO 腳位定義 (根據企劃書)
 #define LED_GREEN 398
@@ -40,6 +68,13 @@ struct gpio_command {
   int value; // 0 為低電位 (OFF), 1 為高電位 (ON)
 };
 
+// 批次 GPIO：由使用者空間合併同一輪事件迴圈的寫入
+#define GPIO_BATCH_MAX 8
+struct gpio_batch {
+  int count;
+  struct gpio_command cmds[GPIO_BATCH_MAX];
+};
+
 #define LOG_EVENT _IOW('B', 1, struct event_data)
 #define CLEAR_LOG _IO('B', 2)
 #define SET_GPIO_VALUE _IOW('B', 3, struct gpio_command)
@@ -49,30 +84,168 @@ struct gpio_command {
 #define STOP_EMERGENCY _IO('B', 5)
 #define GET_EMERGENCY_STATUS _IOR('B', 6, int) // 取得剩餘秒數
 
+#define SET_GPIO_BATCH _IOW('B', 7, struct gpio_batch)
+
+// 各優先級的容量、使用量、累計寫入與覆蓋筆數
+#define GET_LOG_STATS _IOR('B', 8, struct bb_log_stats)
+
+// 驅動統計：與 debugfs 的 stats 內容相同，供不具 root 的程式讀取
+// ioctl_* 以 _IOC_NR 為索引 (1..9)
+#define BB_IOCTL_SLOTS 10
+struct blackbox_stats {
+  unsigned long long events[BB_PRIO_COUNT];
+  unsigned long long overwritten[BB_PRIO_COUNT];
+  unsigned long long dropped_bytes; // 被覆蓋記錄的訊息位元組數
+  unsigned long long reads;
+  unsigned long long read_bytes;
+  unsigned long long ioctl_calls[BB_IOCTL_SLOTS];
+  unsigned long long ioctl_ns[BB_IOCTL_SLOTS]; // 累計執行時間
+  unsigned long long lock_max_hold_ns;
+  unsigned long long emergency_timer_fires;
+  unsigned long long printk_suppressed;
+  unsigned int capacity[BB_PRIO_COUNT];
+  unsigned int used[BB_PRIO_COUNT];
+};
+#define GET_DRIVER_STATS _IOR('B', 9, struct blackbox_stats)
+
+static const char *const ioctl_names[BB_IOCTL_SLOTS] = {
+    NULL,
+    "log_event",
+    "clear_log",
+    "set_gpio",
+    "start_emergency",
+    "stop_emergency",
+    "get_emergency_status",
+    "set_gpio_batch",
+    "get_log_stats",
+    "get_driver_stats",
+};
+
 static int major;
-static char *log_buffer;
-static int write_ptr = 0;
-static int read_ptr = 0;
-static int is_full = 0;
 
-// 輔助函式：寫入緩衝區
-static void write_to_buffer(const char *text) {
-  unsigned long flags;
-  spin_lock_irqsave(&log_lock, flags);
-
-  while (*text) {
-    log_buffer[write_ptr] = *text++;
-    write_ptr = (write_ptr + 1) % BUFFER_SIZE;
-    if (write_ptr == read_ptr) {
-      // 如果寫入追上讀取，表示滿了，強制移動讀取指標（覆蓋舊資料）
-      read_ptr = (read_ptr + 1) % BUFFER_SIZE;
-      is_full = 1;
-    } else {
-      is_full = 0;
+/*
+ * 每個 CPU 一份依優先級分開的記錄環 (邏輯見 blackbox_ring.h)
+ * 寫入端固定在目前的 CPU、只取這顆 CPU 的鎖，不關中斷；不同 CPU 的寫入互不
+ * 競爭，這把鎖只會和讀取/清除/調整容量碰到。全域只有配發序號的原子遞增。
+ * 所有寫入都來自 process context (ioctl)；若日後要從中斷或 softirq 寫入，
+ * 這裡與讀取端都必須改用 _irqsave / _bh
+ */
+struct bb_cpu_log {
+  spinlock_t lock;
+  struct bb_log log;
+  u64 max_hold_ns; // 這把鎖最長持有時間
+} ____cacheline_aligned;
+
+static DEFINE_PER_CPU(struct bb_cpu_log, cpu_logs);
+static atomic64_t log_seq = ATOMIC64_INIT(0); // 已配發的序號數
+
+// 計數器；記錄環本身的計數 (寫入/覆蓋) 在各 CPU 的 bb_log 內
+static atomic64_t stat_reads = ATOMIC64_INIT(0);
+static atomic64_t stat_read_bytes = ATOMIC64_INIT(0);
+static atomic64_t stat_ioctl_calls[BB_IOCTL_SLOTS];
+static atomic64_t stat_ioctl_ns[BB_IOCTL_SLOTS];
+static atomic64_t stat_timer_fires = ATOMIC64_INIT(0);
+static atomic64_t stat_printk_suppressed = ATOMIC64_INIT(0);
+
+// 每筆事件的 KERN_INFO 限速：預設每 5 秒最多 10 行，洪水時不灌爆 dmesg
+static DEFINE_RATELIMIT_STATE(event_printk_rs, 5 * HZ, 10);
+
+static struct dentry *debug_dir;
+
+// 取得/釋放某顆 CPU 的日誌鎖，並記錄最長持有時間
+static inline u64 cpu_log_lock(struct bb_cpu_log *c) {
+  spin_lock(&c->lock);
+  return ktime_get_ns();
+}
+
+static inline void cpu_log_unlock(struct bb_cpu_log *c, u64 start) {
+  u64 held = ktime_get_ns() - start;
+  if (held > c->max_hold_ns)
+    c->max_hold_ns = held;
+  spin_unlock(&c->lock);
+}
+
+// 輔助函式：寫入目前 CPU 對應優先級的記錄環 (滿了只覆蓋同優先級最舊的一筆)
+static void write_to_log(int priority, const char *message) {
+  long long now = ktime_get_real_ns();
+  struct bb_cpu_log *c = get_cpu_ptr(&cpu_logs); // 關閉搶佔，固定在這顆 CPU
+  u64 start = cpu_log_lock(c);
+  // 序號在鎖內取得：讀取端拿到這顆 CPU 的鎖時，已配發的序號必定已寫入
+  bb_log_write_seq(&c->log, priority, atomic64_inc_return(&log_seq) - 1, now,
+                   message);
+  cpu_log_unlock(c, start);
+  put_cpu_ptr(&cpu_logs);
+}
+
+/*
+ * 依序號取出所有 CPU 中最早的一筆 (複製到 rec)，回傳所在 CPU，沒有資料時回傳 -1
+ * 掃描前先讀已配發的序號數 fetched：序號小於 fetched 的記錄在掃到該 CPU 時
+ * 都已寫入，所以最小者若小於 fetched 就不會有更早的記錄還在別的 CPU 寫入中；
+ * 否則它是掃描期間才寫入的，重新掃描一次
+ */
+static int peek_next_record(struct bb_record *rec) {
+  for (;;) {
+    u64 fetched = atomic64_read(&log_seq);
+    int best = -1;
+    int cpu;
+
+    for_each_possible_cpu(cpu) {
+      struct bb_cpu_log *c = per_cpu_ptr(&cpu_logs, cpu);
+      const struct bb_record *next;
+      u64 start = cpu_log_lock(c);
+      next = bb_log_peek(&c->log);
+      if (next && (best < 0 || next->seq < rec->seq)) {
+        *rec = *next;
+        best = cpu;
+      }
+      cpu_log_unlock(c, start);
     }
+    if (best < 0 || rec->seq < fetched)
+      return best;
   }
+}
+
+static void collect_stats(struct blackbox_stats *st) {
+  int cpu, i;
+
+  memset(st, 0, sizeof(*st));
+  for_each_possible_cpu(cpu) {
+    struct bb_cpu_log *c = per_cpu_ptr(&cpu_logs, cpu);
+    struct bb_log_stats ls;
+    u64 start = cpu_log_lock(c);
+    bb_log_get_stats(&c->log, &ls);
+    for (i = 0; i < BB_PRIO_COUNT; i++)
+      st->dropped_bytes += c->log.rings[i].overwritten_bytes;
+    if (c->max_hold_ns > st->lock_max_hold_ns)
+      st->lock_max_hold_ns = c->max_hold_ns;
+    cpu_log_unlock(c, start);
+
+    // 容量為每個 CPU 的筆數 (各 CPU 相同)，其餘為所有 CPU 的總和
+    for (i = 0; i < BB_PRIO_COUNT; i++) {
+      st->events[i] += ls.written[i];
+      st->overwritten[i] += ls.overwritten[i];
+      st->capacity[i] = ls.capacity[i];
+      st->used[i] += ls.used[i];
+    }
+  }
+  st->reads = atomic64_read(&stat_reads);
+  st->read_bytes = atomic64_read(&stat_read_bytes);
+  for (i = 0; i < BB_IOCTL_SLOTS; i++) {
+    st->ioctl_calls[i] = atomic64_read(&stat_ioctl_calls[i]);
+    st->ioctl_ns[i] = atomic64_read(&stat_ioctl_ns[i]);
+  }
+  st->emergency_timer_fires = atomic64_read(&stat_timer_fires);
+  st->printk_suppressed = atomic64_read(&stat_printk_suppressed);
+}
 
-  spin_unlock_irqrestore(&log_lock, flags);
+// 格式化為一行文字：[時間] [優先級] 訊息
+static int format_record(const struct bb_record *rec, char *line, int size) {
+  struct rtc_time tm;
+  rtc_time64_to_tm(div_s64(rec->time_ns, NSEC_PER_SEC), &tm);
+  return snprintf(line, size,
+                  "[%04d-%02d-%02d %02d:%02d:%02d] PRIO:%d MSG:%s\n",
+                  tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour,
+                  tm.tm_min, tm.tm_sec, rec->priority, rec->message);
 }
 
 // Timer 回調函數：每秒執行一次
@@ -81,6 +254,7 @@ static void emergency_timer_callback(unsigned long data) {
   int trigger_explosion = 0;
   int current_seconds = 0;
 
+  atomic64_inc(&stat_timer_fires);
   spin_lock_irqsave(&emergency_lock, flags);
   if (emergency_active && remaining_seconds > 0) {
     remaining_seconds--;
@@ -109,50 +283,51 @@ static int dev_open(struct inode *inodep, struct file *filep) { return 0; }
 
 static int dev_release(struct inode *inodep, struct file *filep) { return 0; }
 
+// 依序號合併各優先級，一次讀出整行；緩衝區連一行都放不下時回傳 -EINVAL
 static ssize_t dev_read(struct file *filep, char *buffer, size_t len,
                         loff_t *offset) {
-  size_t available;
-  int bytes_to_read;
-  int i;
-  unsigned long flags;
-
-  spin_lock_irqsave(&log_lock, flags);
-
-  if (write_ptr == read_ptr && !is_full) {
-    spin_unlock_irqrestore(&log_lock, flags);
-    return 0; // 空的
-  }
-
-  if (is_full) {
-    available = BUFFER_SIZE;
-  } else {
-    available = (write_ptr - read_ptr + BUFFER_SIZE) % BUFFER_SIZE;
-  }
-
-  bytes_to_read = (len < available) ? len : available;
-
-  for (i = 0; i < bytes_to_read; i++) {
-    char data = log_buffer[read_ptr];
-    read_ptr = (read_ptr + 1) % BUFFER_SIZE;
-    is_full = 0;
-    spin_unlock_irqrestore(&log_lock, flags);
-
-    if (copy_to_user(&buffer[i], &data, 1))
-      return -EFAULT;
+  struct bb_record rec;
+  char line[BB_MSG_MAX + 64];
+  size_t copied = 0;
+  ssize_t err = 0;
+
+  atomic64_inc(&stat_reads);
+  while (copied < len) {
+    struct bb_cpu_log *c;
+    int cpu, n;
+    u64 start;
+
+    cpu = peek_next_record(&rec);
+    if (cpu < 0)
+      break; // 讀完了
+
+    // 格式化與 copy_to_user 都在鎖外；確定放得下才從記錄環移除
+    n = format_record(&rec, line, sizeof(line));
+    if (n >= sizeof(line))
+      n = sizeof(line) - 1;
+    if (n > len - copied) {
+      err = -EINVAL;
+      break;
+    }
+    if (copy_to_user(buffer + copied, line, n)) {
+      err = -EFAULT;
+      break;
+    }
+    copied += n;
 
-    spin_lock_irqsave(&log_lock, flags);
+    c = per_cpu_ptr(&cpu_logs, cpu);
+    start = cpu_log_lock(c);
+    bb_log_pop(&c->log, rec.seq); // 期間被覆蓋則什麼都不做
+    cpu_log_unlock(c, start);
   }
 
-  spin_unlock_irqrestore(&log_lock, flags);
-  return bytes_to_read;
+  atomic64_add(copied, &stat_read_bytes);
+  return copied ? copied : err;
 }
 
-static long dev_ioctl(struct file *filep, unsigned int cmd, unsigned long arg) {
+static long do_ioctl(struct file *filep, unsigned int cmd, unsigned long arg) {
   struct event_data event;
   struct gpio_command g_cmd;
-  struct timespec64 ts;
-  struct rtc_time tm;
-  char timestamped_msg[512];
 
   switch (cmd) {
   case LOG_EVENT:
@@ -160,33 +335,52 @@ static long dev_ioctl(struct file *filep, unsigned int cmd, unsigned long arg) {
                        sizeof(struct event_data))) {
       return -EFAULT;
     }
-
-    // 取得當前時間
-    ktime_get_real_ts64(&ts);
-    rtc_time64_to_tm(ts.tv_sec, &tm);
-
-    // 格式化訊息：[時間] [優先級] 訊息
-    snprintf(timestamped_msg, sizeof(timestamped_msg),
-             "[%04d-%02d-%02d %02d:%02d:%02d] PRIO:%d MSG:%s\n",
-             tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour,
-             tm.tm_min, tm.tm_sec, event.priority, event.message);
-
-    write_to_buffer(timestamped_msg);
-    printk(KERN_INFO "Blackbox: Logged event - %s\n", event.message);
+    event.message[sizeof(event.message) - 1] = '\0';
+
+    // 時間戳記於寫入時取得，讀取時才格式化成文字
+    write_to_log(event.priority, event.message);
+    if (__ratelimit(&event_printk_rs))
+      printk(KERN_INFO "Blackbox: Logged event - %s\n", event.message);
+    else
+      atomic64_inc(&stat_printk_suppressed);
     break;
 
   case CLEAR_LOG: {
-    unsigned long flags;
-    spin_lock_irqsave(&log_lock, flags);
-    write_ptr = 0;
-    read_ptr = 0;
-    is_full = 0;
-    memset(log_buffer, 0, BUFFER_SIZE);
-    spin_unlock_irqrestore(&log_lock, flags);
+    int cpu;
+    for_each_possible_cpu(cpu) {
+      struct bb_cpu_log *c = per_cpu_ptr(&cpu_logs, cpu);
+      u64 start = cpu_log_lock(c);
+      bb_log_clear(&c->log);
+      cpu_log_unlock(c, start);
+    }
     printk(KERN_INFO "Blackbox: Log cleared\n");
     break;
   }
 
+  case GET_LOG_STATS: {
+    struct blackbox_stats ds;
+    struct bb_log_stats st;
+    int i;
+    collect_stats(&ds);
+    for (i = 0; i < BB_PRIO_COUNT; i++) {
+      st.capacity[i] = ds.capacity[i];
+      st.used[i] = ds.used[i];
+      st.written[i] = ds.events[i];
+      st.overwritten[i] = ds.overwritten[i];
+    }
+    if (copy_to_user((struct bb_log_stats *)arg, &st, sizeof(st)))
+      return -EFAULT;
+    break;
+  }
+
+  case GET_DRIVER_STATS: {
+    struct blackbox_stats st;
+    collect_stats(&st);
+    if (copy_to_user((struct blackbox_stats *)arg, &st, sizeof(st)))
+      return -EFAULT;
+    break;
+  }
+
   case SET_GPIO_VALUE:
     if (copy_from_user(&g_cmd, (struct gpio_command *)arg,
                        sizeof(struct gpio_command))) {
@@ -197,6 +391,22 @@ static long dev_ioctl(struct file *filep, unsigned int cmd, unsigned long arg) {
     }
     break;
 
+  case SET_GPIO_BATCH: {
+    struct gpio_batch batch;
+    int i;
+    if (copy_from_user(&batch, (struct gpio_batch *)arg,
+                       sizeof(struct gpio_batch))) {
+      return -EFAULT;
+    }
+    if (batch.count < 0 || batch.count > GPIO_BATCH_MAX)
+      return -EINVAL;
+    for (i = 0; i < batch.count; i++) {
+      if (gpio_is_valid(batch.cmds[i].pin))
+        gpio_set_value(batch.cmds[i].pin, batch.cmds[i].value);
+    }
+    break;
+  }
+
   case START_EMERGENCY: {
     int minutes;
     unsigned long flags;
@@ -259,6 +469,19 @@ static long dev_ioctl(struct file *filep, unsigned int cmd, unsigned long arg) {
   return 0;
 }
 
+// 統計每種 ioctl 的呼叫次數與累計時間
+static long dev_ioctl(struct file *filep, unsigned int cmd, unsigned long arg) {
+  unsigned int nr = _IOC_NR(cmd);
+  u64 start = ktime_get_ns();
+  long ret = do_ioctl(filep, cmd, arg);
+
+  if (_IOC_TYPE(cmd) == 'B' && nr > 0 && nr < BB_IOCTL_SLOTS) {
+    atomic64_inc(&stat_ioctl_calls[nr]);
+    atomic64_add(ktime_get_ns() - start, &stat_ioctl_ns[nr]);
+  }
+  return ret;
+}
+
 static struct file_operations fops = {
     .open = dev_open,
     .release = dev_release,
@@ -266,17 +489,235 @@ static struct file_operations fops = {
     .unlocked_ioctl = dev_ioctl,
 };
 
+static void free_log_records(void) {
+  int cpu, p;
+  for_each_possible_cpu(cpu) {
+    struct bb_cpu_log *c = per_cpu_ptr(&cpu_logs, cpu);
+    for (p = 0; p < BB_PRIO_COUNT; p++) {
+      vfree(c->log.rings[p].recs);
+      c->log.rings[p].recs = NULL;
+    }
+  }
+}
+
+/*
+ * debugfs：/sys/kernel/debug/blackbox/
+ *   stats                 所有計數 (每行 "名稱 值")
+ *   info_records 等       各優先級容量，寫入即重新配置，保留最新的記錄
+ *   printk_interval_ms    事件 printk 限速視窗，0 表示不限速
+ *   printk_burst          每個視窗最多幾行，0 表示不印
+ *   lock_max_hold_ns      各 CPU 日誌鎖的最長持有時間，寫入 0 重設
+ */
+static DEFINE_MUTEX(resize_mutex);
+static int *const capacity_params[BB_PRIO_COUNT] = {
+    &info_records, &warning_records, &critical_records};
+
+static int resize_log(int priority, u64 records) {
+  struct bb_record **recs;
+  int cpu;
+
+  if (records < 1 || records > BB_MAX_RECORDS)
+    return -EINVAL;
+  // 配置與釋放都在鎖外；保留的記錄分段搬移，每次持鎖最多 BB_RESIZE_CHUNK 筆。
+  // 每個 CPU 各換一份
+  recs = kcalloc(nr_cpu_ids, sizeof(*recs), GFP_KERNEL);
+  if (!recs)
+    return -ENOMEM;
+  for_each_possible_cpu(cpu) {
+    recs[cpu] = vzalloc(records * sizeof(struct bb_record));
+    if (!recs[cpu])
+      goto fail;
+  }
+
+  mutex_lock(&resize_mutex);
+  for_each_possible_cpu(cpu) {
+    struct bb_cpu_log *c = per_cpu_ptr(&cpu_logs, cpu);
+    struct bb_resize rs;
+    int done, rounds = 0;
+
+    bb_resize_init(&rs, recs[cpu], (int)records);
+    do {
+      // 寫入端一直比搬移快時，最後一次把剩下的 (至多 BB_MAX_RECORDS 筆) 搬完
+      int chunk = ++rounds < 2 * BB_MAX_RECORDS / BB_RESIZE_CHUNK
+                      ? BB_RESIZE_CHUNK
+                      : BB_MAX_RECORDS;
+      u64 start = cpu_log_lock(c);
+      done = bb_log_resize_step(&c->log, priority, &rs, chunk);
+      cpu_log_unlock(c, start);
+      if (!done)
+        cond_resched();
+    } while (!done);
+    recs[cpu] = rs.recs;
+  }
+  *capacity_params[priority] = (int)records;
+  mutex_unlock(&resize_mutex);
+
+  for_each_possible_cpu(cpu)
+    vfree(recs[cpu]); // 換下來的舊空間
+  kfree(recs);
+  printk(KERN_INFO "Blackbox: Log capacity for priority %d set to %llu "
+                   "records per CPU\n",
+         priority, records);
+  return 0;
+
+fail:
+  for_each_possible_cpu(cpu)
+    vfree(recs[cpu]);
+  kfree(recs);
+  return -ENOMEM;
+}
+
+static int records_get(void *data, u64 *val) {
+  *val = *capacity_params[(long)data];
+  return 0;
+}
+
+static int records_set(void *data, u64 val) {
+  return resize_log((int)(long)data, val);
+}
+
+DEFINE_SIMPLE_ATTRIBUTE(records_fops, records_get, records_set, "%llu\n");
+
+static int printk_interval_get(void *data, u64 *val) {
+  *val = jiffies_to_msecs(event_printk_rs.interval);
+  return 0;
+}
+
+static int printk_interval_set(void *data, u64 val) {
+  event_printk_rs.interval = msecs_to_jiffies(val);
+  return 0;
+}
+
+DEFINE_SIMPLE_ATTRIBUTE(printk_interval_fops, printk_interval_get,
+                        printk_interval_set, "%llu\n");
+
+static int printk_burst_get(void *data, u64 *val) {
+  *val = event_printk_rs.burst;
+  return 0;
+}
+
+static int printk_burst_set(void *data, u64 val) {
+  if (val > INT_MAX)
+    return -EINVAL;
+  event_printk_rs.burst = (int)val;
+  return 0;
+}
+
+DEFINE_SIMPLE_ATTRIBUTE(printk_burst_fops, printk_burst_get, printk_burst_set,
+                        "%llu\n");
+
+static int lock_max_hold_get(void *data, u64 *val) {
+  struct blackbox_stats st;
+  collect_stats(&st);
+  *val = st.lock_max_hold_ns;
+  return 0;
+}
+
+static int lock_max_hold_set(void *data, u64 val) {
+  int cpu;
+  for_each_possible_cpu(cpu) {
+    struct bb_cpu_log *c = per_cpu_ptr(&cpu_logs, cpu);
+    spin_lock(&c->lock);
+    c->max_hold_ns = val;
+    spin_unlock(&c->lock);
+  }
+  return 0;
+}
+
+DEFINE_SIMPLE_ATTRIBUTE(lock_max_hold_fops, lock_max_hold_get,
+                        lock_max_hold_set, "%llu\n");
+
+static int stats_show(struct seq_file *m, void *v) {
+  static const char *const prio_names[BB_PRIO_COUNT] = {"info", "warning",
+                                                        "critical"};
+  struct blackbox_stats st;
+  int i;
+
+  collect_stats(&st);
+  for (i = 0; i < BB_PRIO_COUNT; i++) {
+    seq_printf(m, "events_%s %llu\n", prio_names[i], st.events[i]);
+    seq_printf(m, "overwritten_%s %llu\n", prio_names[i], st.overwritten[i]);
+    seq_printf(m, "capacity_%s %u\n", prio_names[i], st.capacity[i]);
+    seq_printf(m, "used_%s %u\n", prio_names[i], st.used[i]);
+  }
+  seq_printf(m, "dropped_bytes %llu\n", st.dropped_bytes);
+  seq_printf(m, "reads %llu\n", st.reads);
+  seq_printf(m, "read_bytes %llu\n", st.read_bytes);
+  for (i = 1; i < BB_IOCTL_SLOTS; i++) {
+    seq_printf(m, "ioctl_%s_calls %llu\n", ioctl_names[i], st.ioctl_calls[i]);
+    seq_printf(m, "ioctl_%s_ns %llu\n", ioctl_names[i], st.ioctl_ns[i]);
+  }
+  seq_printf(m, "lock_max_hold_ns %llu\n", st.lock_max_hold_ns);
+  seq_printf(m, "emergency_timer_fires %llu\n", st.emergency_timer_fires);
+  seq_printf(m, "printk_suppressed %llu\n", st.printk_suppressed);
+  return 0;
+}
+
+static int stats_open(struct inode *inode, struct file *file) {
+  return single_open(file, stats_show, NULL);
+}
+
+static const struct file_operations stats_fops = {
+    .owner = THIS_MODULE,
+    .open = stats_open,
+    .read = seq_read,
+    .llseek = seq_lseek,
+    .release = single_release,
+};
+
+// debugfs 未啟用時只少了這些檔案，驅動照常運作
+static void create_debugfs(void) {
+  debug_dir = debugfs_create_dir(DEVICE_NAME, NULL);
+  if (IS_ERR_OR_NULL(debug_dir)) {
+    debug_dir = NULL;
+    return;
+  }
+  debugfs_create_file("stats", 0444, debug_dir, NULL, &stats_fops);
+  debugfs_create_file("info_records", 0644, debug_dir, (void *)0L,
+                      &records_fops);
+  debugfs_create_file("warning_records", 0644, debug_dir, (void *)1L,
+                      &records_fops);
+  debugfs_create_file("critical_records", 0644, debug_dir, (void *)2L,
+                      &records_fops);
+  debugfs_create_file("printk_interval_ms", 0644, debug_dir, NULL,
+                      &printk_interval_fops);
+  debugfs_create_file("printk_burst", 0644, debug_dir, NULL,
+                      &printk_burst_fops);
+  debugfs_create_file("lock_max_hold_ns", 0644, debug_dir, NULL,
+                      &lock_max_hold_fops);
+}
+
 static int __init blackbox_init(void) {
+  int capacity[BB_PRIO_COUNT] = {info_records, warning_records,
+                                 critical_records};
+  int cpu, p;
+
   major = register_chrdev(0, DEVICE_NAME, &fops);
   if (major < 0) {
     printk(KERN_ALERT "Blackbox: Failed to register major number\n");
     return major;
   }
 
-  log_buffer = kmalloc(BUFFER_SIZE, GFP_KERNEL);
-  if (!log_buffer) {
-    unregister_chrdev(major, DEVICE_NAME);
-    return -ENOMEM;
+  for (p = 0; p < BB_PRIO_COUNT; p++) {
+    if (capacity[p] < 1)
+      capacity[p] = 1;
+    if (capacity[p] > BB_MAX_RECORDS)
+      capacity[p] = BB_MAX_RECORDS;
+    *capacity_params[p] = capacity[p];
+  }
+  for_each_possible_cpu(cpu) {
+    struct bb_cpu_log *c = per_cpu_ptr(&cpu_logs, cpu);
+    spin_lock_init(&c->lock);
+    bb_log_init(&c->log);
+    for (p = 0; p < BB_PRIO_COUNT; p++) {
+      struct bb_record *recs = vzalloc(capacity[p] * sizeof(struct bb_record));
+      if (!recs) {
+        free_log_records();
+        unregister_chrdev(major, DEVICE_NAME);
+        return -ENOMEM;
+      }
+      bb_log_init_ring(&c->log, p, recs, capacity[p]);
+    }
   }
 
   // 初始化 GPIO
@@ -307,13 +748,20 @@ static int __init blackbox_init(void) {
   // 初始化 Timer
   setup_timer(&emergency_timer, emergency_timer_callback, 0);
 
-  memset(log_buffer, 0, BUFFER_SIZE);
+  create_debugfs();
+
   printk(KERN_INFO "Blackbox: Module loaded with major %d and GPIOs ready\n",
          major);
+  printk(KERN_INFO "Blackbox: Log capacity INFO %d / WARNING %d / CRITICAL %d "
+                   "records per CPU (%d CPUs)\n",
+         capacity[0], capacity[1], capacity[2], num_possible_cpus());
   return 0;
 }
 
 static void __exit blackbox_exit(void) {
+  // 先移除 debugfs，之後不會再有調整容量的請求
+  debugfs_remove_recursive(debug_dir);
+
   // 停止 Timer
   del_timer(&emergency_timer);
 
@@ -325,7 +773,7 @@ static void __exit blackbox_exit(void) {
   gpio_free(BUZZER);
   gpio_free(EXPLOSION_TRIGGER);
 
-  kfree(log_buffer);
+  free_log_records();
   unregister_chrdev(major, DEVICE_NAME);
   printk(KERN_INFO "Blackbox: Module unloaded\n");
 }
@@ -0,0 +1,263 @@
+/*
+ * blackbox_flood：黑盒子日誌洪水測試
+ * 以最快速度寫入大量 INFO，期間穿插 CRITICAL (「小豬炸彈倒數啟動 #k」)，
+ * 之後讀回整份日誌，確認 CRITICAL 全部保留、沒有半行，並列出各優先級的
+ * 寫入/覆蓋筆數。
+ *
+ *   make flood && ./blackbox_flood              # 對 /dev/blackbox (會清空日誌)
+ *   ./blackbox_flood --sim                      # 不需驅動，直接用 blackbox_ring.h
+ *   ./blackbox_flood -n 1000000 -c 32
+ *
+ * 全部保留時回傳 0，否則回傳 1
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "blackbox_ring.h"
+
+// 與 blackbox_driver.c 定義一致
+struct event_data {
+  char message[256];
+  int priority;
+};
+
+#define LOG_EVENT _IOW('B', 1, struct event_data)
+#define CLEAR_LOG _IO('B', 2)
+#define GET_LOG_STATS _IOR('B', 8, struct bb_log_stats)
+
+#define CRITICAL_TEXT "小豬炸彈倒數啟動 #"
+
+static const char *prio_names[BB_PRIO_COUNT] = {"INFO", "WARNING", "CRITICAL"};
+
+// --sim：與驅動預設容量相同的行程內記錄環
+static struct bb_log sim_log;
+
+static int dev_fd = -1;
+
+static long long now_ns(clockid_t clock) {
+  struct timespec ts;
+  clock_gettime(clock, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int log_event(int priority, const char *message) {
+  struct event_data ev;
+  if (dev_fd < 0) {
+    bb_log_write(&sim_log, priority, now_ns(CLOCK_REALTIME), message);
+    return 0;
+  }
+  memset(&ev, 0, sizeof(ev));
+  snprintf(ev.message, sizeof(ev.message), "%s", message);
+  ev.priority = priority;
+  return ioctl(dev_fd, LOG_EVENT, &ev);
+}
+
+static int get_stats(struct bb_log_stats *st) {
+  if (dev_fd < 0) {
+    bb_log_get_stats(&sim_log, st);
+    return 0;
+  }
+  return ioctl(dev_fd, GET_LOG_STATS, st);
+}
+
+// 讀回整份日誌 (與驅動 dev_read 相同的行格式)
+static char *read_all(size_t *size) {
+  size_t cap = 1 << 20, len = 0;
+  char *buf = malloc(cap);
+  if (!buf)
+    return NULL;
+
+  if (dev_fd < 0) {
+    const struct bb_record *rec;
+    while ((rec = bb_log_peek(&sim_log)) != NULL) {
+      time_t sec = (time_t)(rec->time_ns / 1000000000LL);
+      struct tm tm;
+      int n;
+      if (cap - len < BB_MSG_MAX + 64) {
+        cap *= 2;
+        buf = realloc(buf, cap);
+        if (!buf)
+          return NULL;
+      }
+      gmtime_r(&sec, &tm);
+      n = snprintf(buf + len, cap - len,
+                   "[%04d-%02d-%02d %02d:%02d:%02d] PRIO:%d MSG:%s\n",
+                   tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour,
+                   tm.tm_min, tm.tm_sec, rec->priority, rec->message);
+      len += n;
+      bb_log_pop(&sim_log, rec->seq);
+    }
+  } else {
+    for (;;) {
+      ssize_t n;
+      if (cap - len < 65536) {
+        cap *= 2;
+        buf = realloc(buf, cap);
+        if (!buf)
+          return NULL;
+      }
+      n = read(dev_fd, buf + len, cap - len);
+      if (n < 0) {
+        perror("read /dev/blackbox");
+        free(buf);
+        return NULL;
+      }
+      if (n == 0)
+        break;
+      len += n;
+    }
+  }
+  *size = len;
+  return buf;
+}
+
+static void usage(const char *argv0) {
+  fprintf(stderr,
+          "usage: %s [--sim] [-n info_events] [-c critical_events]\n"
+          "          [-d device]  (預設 /dev/blackbox)\n",
+          argv0);
+}
+
+int main(int argc, char **argv) {
+  const char *device = "/dev/blackbox";
+  long info_events = 200000;
+  int critical_events = 16;
+  int sim = 0;
+  int i;
+
+  for (i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--sim") == 0) {
+      sim = 1;
+    } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+      info_events = atol(argv[++i]);
+    } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+      critical_events = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+      device = argv[++i];
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (critical_events < 1 || info_events < critical_events) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  if (sim) {
+    static struct bb_record info[128], warning[64], critical[64];
+    bb_log_init(&sim_log);
+    bb_log_init_ring(&sim_log, 0, info, 128);
+    bb_log_init_ring(&sim_log, 1, warning, 64);
+    bb_log_init_ring(&sim_log, 2, critical, 64);
+  } else {
+    dev_fd = open(device, O_RDWR);
+    if (dev_fd < 0) {
+      fprintf(stderr, "無法開啟 %s: %s (可改用 --sim)\n", device,
+              strerror(errno));
+      return 2;
+    }
+    if (ioctl(dev_fd, CLEAR_LOG) < 0) {
+      perror("CLEAR_LOG");
+      return 2;
+    }
+  }
+
+  // 寫入：INFO 洪水中平均穿插 CRITICAL
+  {
+    const long every = info_events / critical_events;
+    int next_critical = 0;
+    long long start = now_ns(CLOCK_MONOTONIC);
+    double seconds;
+    char msg[BB_MSG_MAX];
+    long n;
+
+    log_event(1, "flood test start");
+    for (n = 0; n < info_events; n++) {
+      if (n % every == 0 && next_critical < critical_events) {
+        snprintf(msg, sizeof(msg), CRITICAL_TEXT "%d", next_critical++);
+        if (log_event(2, msg) < 0) {
+          perror("LOG_EVENT");
+          return 2;
+        }
+      }
+      snprintf(msg, sizeof(msg), "燈光模式切換: flood %ld", n);
+      if (log_event(0, msg) < 0) {
+        perror("LOG_EVENT");
+        return 2;
+      }
+    }
+    seconds = (now_ns(CLOCK_MONOTONIC) - start) / 1e9;
+    printf("wrote %ld INFO + %d CRITICAL in %.3f s (%.0f events/s)%s\n",
+           info_events, critical_events, seconds,
+           (info_events + critical_events) / seconds, sim ? " [sim]" : "");
+  }
+
+  // 各優先級計數
+  struct bb_log_stats st;
+  if (get_stats(&st) < 0) {
+    perror("GET_LOG_STATS");
+    return 2;
+  }
+  printf("%-9s %8s %8s %12s %12s\n", "priority", "capacity", "used",
+         "written", "overwritten");
+  for (i = 0; i < BB_PRIO_COUNT; i++)
+    printf("%-9s %8u %8u %12llu %12llu\n", prio_names[i], st.capacity[i],
+           st.used[i], st.written[i], st.overwritten[i]);
+
+  // 讀回並檢查：CRITICAL 至少保留最後 min(c, 容量) 筆，依序、沒有半行
+  // (驅動每個 CPU 各有一份記錄環，寫入分散在多顆 CPU 時會保留更早的)
+  size_t size = 0;
+  char *log = read_all(&size);
+  if (!log)
+    return 2;
+
+  const int expected_first =
+      critical_events > (int)st.capacity[2]
+          ? critical_events - (int)st.capacity[2]
+          : 0;
+  int prev = -1, retained = 0, lines = 0, broken = 0;
+  int out_of_order = 0;
+  char *line = log, *end = log + size;
+  while (line < end) {
+    char *nl = memchr(line, '\n', end - line);
+    char *marker;
+    if (!nl) {
+      broken++;
+      break;
+    }
+    *nl = '\0';
+    lines++;
+    if (line[0] != '[' || !strstr(line, " PRIO:") || !strstr(line, " MSG:"))
+      broken++;
+    if ((marker = strstr(line, CRITICAL_TEXT)) != NULL) {
+      int k = atoi(marker + strlen(CRITICAL_TEXT));
+      if (k <= prev) // 順序錯誤或重複
+        out_of_order++;
+      else if (k >= expected_first)
+        retained++; // 遞增且不重複，數量對了就表示沒有遺漏
+      prev = k;
+    }
+    line = nl + 1;
+  }
+  free(log);
+
+  printf("read back %d lines (%zu bytes): CRITICAL %d/%d retained, "
+         "%d malformed, %d out of order\n",
+         lines, size, retained, critical_events - expected_first, broken,
+         out_of_order);
+
+  if (retained != critical_events - expected_first || broken ||
+      out_of_order) {
+    printf("FAIL\n");
+    return 1;
+  }
+  printf("PASS\n");
+  return 0;
+}
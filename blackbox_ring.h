@@ -0,0 +1,247 @@
+#ifndef BLACKBOX_RING_H
+#define BLACKBOX_RING_H
+
+/*
+ * 黑盒子日誌的核心邏輯 (不含鎖)
+ * 由 blackbox_driver.c 在各 CPU 的日誌鎖保護下使用；不依賴任何 kernel 標頭，
+ * 也能以使用者空間程式編譯 (GuardianEye_QT/benchmarks、blackbox_flood、
+ * blackbox_stress) 量測與驗證
+ *
+ * 每個優先級一個以「筆」為單位的環形緩衝區：滿了只覆蓋同優先級最舊的一筆，
+ * 大量 INFO 不會擠掉 CRITICAL，也不會出現被截斷的半行。
+ * 每筆記錄帶全域遞增序號，讀取時依序號合併各優先級 (即寫入/時間順序)；
+ * 驅動每個 CPU 各有一份 bb_log，序號由全域原子計數器配發 (bb_log_write_seq)
+ */
+
+#define BB_PRIO_COUNT 3 // 0=INFO, 1=WARNING, 2=CRITICAL
+#define BB_MSG_MAX 256  // 與 event_data.message 相同
+
+struct bb_record {
+  unsigned long long seq; // 全域遞增序號，合併讀取依此排序
+  long long time_ns;      // 寫入時的 CLOCK_REALTIME，只用於顯示
+  int priority;
+  char message[BB_MSG_MAX];
+};
+
+struct bb_rec_ring {
+  struct bb_record *recs;
+  int capacity; // 筆數
+  int head;     // 最舊一筆
+  int count;
+  unsigned long long written;     // 累計寫入筆數
+  unsigned long long overwritten; // 因滿載被覆蓋 (未讀取) 的筆數
+  unsigned long long overwritten_bytes; // 被覆蓋記錄的訊息位元組數
+};
+
+struct bb_log {
+  struct bb_rec_ring rings[BB_PRIO_COUNT];
+  unsigned long long next_seq;
+};
+
+// GET_LOG_STATS ioctl 的輸出
+struct bb_log_stats {
+  unsigned int capacity[BB_PRIO_COUNT];
+  unsigned int used[BB_PRIO_COUNT];
+  unsigned long long written[BB_PRIO_COUNT];
+  unsigned long long overwritten[BB_PRIO_COUNT];
+};
+
+static inline int bb_prio_clamp(int priority) {
+  if (priority < 0)
+    return 0;
+  if (priority >= BB_PRIO_COUNT)
+    return BB_PRIO_COUNT - 1;
+  return priority;
+}
+
+static inline void bb_log_init(struct bb_log *log) {
+  int p;
+  for (p = 0; p < BB_PRIO_COUNT; p++) {
+    log->rings[p].recs = 0;
+    log->rings[p].capacity = 0;
+    log->rings[p].head = 0;
+    log->rings[p].count = 0;
+    log->rings[p].written = 0;
+    log->rings[p].overwritten = 0;
+    log->rings[p].overwritten_bytes = 0;
+  }
+  log->next_seq = 0;
+}
+
+// recs 由呼叫端配置 (capacity 筆)；capacity 至少為 1
+static inline void bb_log_init_ring(struct bb_log *log, int priority,
+                                    struct bb_record *recs, int capacity) {
+  struct bb_rec_ring *r = &log->rings[priority];
+  r->recs = recs;
+  r->capacity = capacity;
+  r->head = 0;
+  r->count = 0;
+  r->written = 0;
+  r->overwritten = 0;
+  r->overwritten_bytes = 0;
+}
+
+static inline int bb_msg_len(const char *message) {
+  int n = 0;
+  while (n < BB_MSG_MAX && message[n])
+    n++;
+  return n;
+}
+
+/*
+ * 分段改用新的儲存空間 (capacity 筆)，保留最新的記錄。呼叫端每次持鎖呼叫
+ * bb_log_resize_step()，每次最多搬 chunk 筆，兩次之間寫入端照常寫入舊的空間。
+ * 記錄以累計寫入序 (written) 定位：第 a 筆放在新空間的 a % capacity，
+ * 新空間放不下的最舊記錄計入覆蓋；搬移期間舊空間被覆蓋的記錄由寫入端計數，
+ * 已搬過的副本一併捨棄。回傳 1 表示已追上寫入端並完成切換，
+ * 此時 rs->recs 改為舊的儲存空間，由呼叫端在鎖外釋放
+ */
+struct bb_resize {
+  struct bb_record *recs; // 新的儲存空間；完成後為舊的
+  int capacity;
+  int started;
+  unsigned long long next; // 下一筆要搬的累計寫入序
+  unsigned long long lo;   // 新空間中最舊一筆的累計寫入序
+};
+
+static inline void bb_resize_init(struct bb_resize *rs, struct bb_record *recs,
+                                  int capacity) {
+  rs->recs = recs;
+  rs->capacity = capacity;
+  rs->started = 0;
+  rs->next = 0;
+  rs->lo = 0;
+}
+
+static inline int bb_log_resize_step(struct bb_log *log, int priority,
+                                     struct bb_resize *rs, int chunk) {
+  struct bb_rec_ring *r = &log->rings[priority];
+  const unsigned long long oldest = r->written - r->count;
+  const unsigned long long end = r->written;
+  struct bb_record *old;
+  int n;
+
+  if (!rs->started) {
+    rs->next = rs->lo = oldest;
+    rs->started = 1;
+  }
+  if (rs->next < oldest)
+    rs->next = oldest;
+  if (rs->lo < oldest)
+    rs->lo = oldest;
+
+  for (n = 0; n < chunk && rs->next < end; n++, rs->next++) {
+    struct bb_record *dst = &rs->recs[rs->next % rs->capacity];
+    if (rs->next - rs->lo >= (unsigned long long)rs->capacity) {
+      // 新空間已滿：dst 目前是最舊的副本
+      r->overwritten++;
+      r->overwritten_bytes += bb_msg_len(dst->message);
+      rs->lo++;
+    }
+    *dst = r->recs[(r->head + (int)(rs->next - oldest)) % r->capacity];
+  }
+  if (rs->next < end)
+    return 0;
+
+  old = r->recs;
+  r->recs = rs->recs;
+  r->capacity = rs->capacity;
+  r->head = (int)(rs->lo % rs->capacity);
+  r->count = (int)(rs->next - rs->lo);
+  rs->recs = old;
+  return 1;
+}
+
+// 清空內容，保留累計計數與序號
+static inline void bb_log_clear(struct bb_log *log) {
+  int p;
+  for (p = 0; p < BB_PRIO_COUNT; p++) {
+    log->rings[p].head = 0;
+    log->rings[p].count = 0;
+  }
+}
+
+// 以呼叫端配發的序號寫入一筆；同優先級已滿時覆蓋該級最舊的一筆。
+// 同一個 bb_log 內的序號必須遞增
+static inline void bb_log_write_seq(struct bb_log *log, int priority,
+                                    unsigned long long seq, long long time_ns,
+                                    const char *message) {
+  struct bb_rec_ring *r = &log->rings[bb_prio_clamp(priority)];
+  struct bb_record *rec;
+  int i;
+
+  if (r->count < r->capacity) {
+    rec = &r->recs[(r->head + r->count) % r->capacity];
+    r->count++;
+  } else {
+    rec = &r->recs[r->head];
+    r->head = (r->head + 1) % r->capacity;
+    r->overwritten++;
+    r->overwritten_bytes += bb_msg_len(rec->message);
+  }
+  r->written++;
+
+  rec->seq = seq;
+  rec->time_ns = time_ns;
+  rec->priority = bb_prio_clamp(priority);
+  for (i = 0; i < BB_MSG_MAX - 1 && message[i]; i++)
+    rec->message[i] = message[i];
+  rec->message[i] = '\0';
+}
+
+// 寫入一筆，序號由 log 自己配發。回傳這筆的序號
+static inline unsigned long long bb_log_write(struct bb_log *log, int priority,
+                                              long long time_ns,
+                                              const char *message) {
+  unsigned long long seq = log->next_seq++;
+  bb_log_write_seq(log, priority, seq, time_ns, message);
+  return seq;
+}
+
+static inline int bb_log_available(const struct bb_log *log) {
+  int p, total = 0;
+  for (p = 0; p < BB_PRIO_COUNT; p++)
+    total += log->rings[p].count;
+  return total;
+}
+
+// 下一筆該讀的記錄 (所有優先級中序號最小者)，沒有資料時回傳 0
+static inline const struct bb_record *bb_log_peek(const struct bb_log *log) {
+  const struct bb_record *next = 0;
+  int p;
+  for (p = 0; p < BB_PRIO_COUNT; p++) {
+    const struct bb_rec_ring *r = &log->rings[p];
+    const struct bb_record *head;
+    if (r->count == 0)
+      continue;
+    head = &r->recs[r->head];
+    if (!next || head->seq < next->seq)
+      next = head;
+  }
+  return next;
+}
+
+// 移除序號為 seq 的下一筆；期間已被覆蓋或讀走時回傳 0
+static inline int bb_log_pop(struct bb_log *log, unsigned long long seq) {
+  const struct bb_record *next = bb_log_peek(log);
+  struct bb_rec_ring *r;
+  if (!next || next->seq != seq)
+    return 0;
+  r = &log->rings[next->priority];
+  r->head = (r->head + 1) % r->capacity;
+  r->count--;
+  return 1;
+}
+
+static inline void bb_log_get_stats(const struct bb_log *log,
+                                    struct bb_log_stats *st) {
+  int p;
+  for (p = 0; p < BB_PRIO_COUNT; p++) {
+    st->capacity[p] = (unsigned int)log->rings[p].capacity;
+    st->used[p] = (unsigned int)log->rings[p].count;
+    st->written[p] = log->rings[p].written;
+    st->overwritten[p] = log->rings[p].overwritten;
+  }
+}
+
+#endif // BLACKBOX_RING_H
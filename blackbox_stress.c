@@ -0,0 +1,300 @@
+/*
+ * blackbox_stress：黑盒子日誌多執行緒寫入壓力測試
+ * 以 1、2、4 … 個執行緒同時寫入 LOG_EVENT，列出每種執行緒數的 events/s
+ * 與相對單執行緒的倍數，之後讀回日誌確認每個執行緒的事件依序、沒有半行
+ * (驗證各 CPU 記錄環依序號合併的結果)。
+ *
+ *   make stress && ./blackbox_stress            # 對 /dev/blackbox (會清空日誌)
+ *   ./blackbox_stress --sim                     # 不需驅動：每個執行緒一份記錄環
+ *   ./blackbox_stress --sim-global              # 對照組：所有執行緒共用一把鎖
+ *   ./blackbox_stress -t 8 -n 200000
+ *
+ * 檢查全部通過時回傳 0，否則回傳 1
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "blackbox_ring.h"
+
+// 與 blackbox_driver.c 定義一致
+struct event_data {
+  char message[256];
+  int priority;
+};
+
+#define LOG_EVENT _IOW('B', 1, struct event_data)
+#define CLEAR_LOG _IO('B', 2)
+
+#define MAX_THREADS 64
+#define STRESS_TEXT "stress t"
+
+enum mode { MODE_DEVICE, MODE_SIM, MODE_SIM_GLOBAL };
+
+// --sim：模擬驅動的每 CPU 記錄環 (每個執行緒一份)；--sim-global 只用 slots[0]
+struct sim_slot {
+  pthread_mutex_t lock;
+  struct bb_log log;
+  struct bb_record info[128], warning[64], critical[64];
+} __attribute__((aligned(64)));
+
+static struct sim_slot slots[MAX_THREADS];
+static unsigned long long sim_seq; // 以 __atomic 配發
+
+static enum mode run_mode = MODE_DEVICE;
+static int dev_fd = -1;
+static long events_per_thread = 100000;
+static pthread_barrier_t start_barrier;
+
+static long long now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int log_event(int slot, int priority, const char *message) {
+  struct event_data ev;
+
+  if (run_mode != MODE_DEVICE) {
+    struct sim_slot *s = &slots[run_mode == MODE_SIM_GLOBAL ? 0 : slot];
+    pthread_mutex_lock(&s->lock);
+    bb_log_write_seq(&s->log, priority,
+                     __atomic_fetch_add(&sim_seq, 1, __ATOMIC_RELAXED), 0,
+                     message);
+    pthread_mutex_unlock(&s->lock);
+    return 0;
+  }
+  memset(&ev, 0, sizeof(ev));
+  snprintf(ev.message, sizeof(ev.message), "%s", message);
+  ev.priority = priority;
+  return ioctl(dev_fd, LOG_EVENT, &ev);
+}
+
+static void *writer(void *arg) {
+  const int id = (int)(long)arg;
+  char msg[BB_MSG_MAX];
+  long n;
+
+  pthread_barrier_wait(&start_barrier);
+  for (n = 0; n < events_per_thread; n++) {
+    snprintf(msg, sizeof(msg), STRESS_TEXT "%d #%ld", id, n);
+    // 大多是 INFO，偶爾穿插 WARNING/CRITICAL，三個優先級都會被合併讀取
+    if (log_event(id, n % 64 == 0 ? (n % 128 == 0 ? 2 : 1) : 0, msg) < 0) {
+      perror("LOG_EVENT");
+      return (void *)1L;
+    }
+  }
+  return NULL;
+}
+
+static void sim_reset(void) {
+  int i;
+  for (i = 0; i < MAX_THREADS; i++) {
+    struct sim_slot *s = &slots[i];
+    bb_log_init(&s->log);
+    bb_log_init_ring(&s->log, 0, s->info, 128);
+    bb_log_init_ring(&s->log, 1, s->warning, 64);
+    bb_log_init_ring(&s->log, 2, s->critical, 64);
+  }
+  sim_seq = 0;
+}
+
+// 下一筆的訊息 (依序號合併)；讀完回傳 0。device 模式以 read() 一次讀一批
+static int next_message(char *message, size_t size) {
+  static char buf[1 << 16];
+  static size_t len, pos;
+
+  if (run_mode != MODE_DEVICE) {
+    const struct bb_record *best = NULL;
+    int i, best_slot = -1;
+    for (i = 0; i < MAX_THREADS; i++) {
+      const struct bb_record *rec = bb_log_peek(&slots[i].log);
+      if (rec && (!best || rec->seq < best->seq)) {
+        best = rec;
+        best_slot = i;
+      }
+    }
+    if (!best)
+      return 0;
+    snprintf(message, size, "%s", best->message);
+    bb_log_pop(&slots[best_slot].log, best->seq);
+    return 1;
+  }
+
+  for (;;) {
+    char *nl = pos < len ? memchr(buf + pos, '\n', len - pos) : NULL;
+    if (nl) {
+      char *msg;
+      *nl = '\0';
+      msg = strstr(buf + pos, " MSG:");
+      // 沒有 MSG 欄位的行以空字串回傳，由呼叫端計為格式錯誤
+      snprintf(message, size, "%s", msg ? msg + 5 : "");
+      pos = nl + 1 - buf;
+      return 1;
+    }
+    // 剩下的半行搬到開頭再讀；驅動只回傳整行，這裡應該永遠是空的
+    memmove(buf, buf + pos, len - pos);
+    len -= pos;
+    pos = 0;
+    {
+      ssize_t n = read(dev_fd, buf + len, sizeof(buf) - len);
+      if (n < 0) {
+        perror("read /dev/blackbox");
+        return 0;
+      }
+      if (n == 0) {
+        if (len) {
+          snprintf(message, size, "%s", ""); // 讀到半行
+          len = 0;
+          return 1;
+        }
+        return 0;
+      }
+      len += n;
+    }
+  }
+}
+
+// 讀回整份日誌：每個執行緒的序號必須遞增 (被覆蓋的可以缺)，沒有格式錯誤
+static int verify(int threads, int *lines_out) {
+  long last[MAX_THREADS];
+  char message[BB_MSG_MAX];
+  int i, lines = 0, bad = 0;
+
+  for (i = 0; i < MAX_THREADS; i++)
+    last[i] = -1;
+  while (next_message(message, sizeof(message))) {
+    int id;
+    long n;
+    lines++;
+    if (sscanf(message, STRESS_TEXT "%d #%ld", &id, &n) != 2 || id < 0 ||
+        id >= threads) {
+      bad++;
+      continue;
+    }
+    if (n <= last[id])
+      bad++;
+    last[id] = n;
+  }
+  *lines_out = lines;
+  return bad;
+}
+
+static void usage(const char *argv0) {
+  fprintf(stderr,
+          "usage: %s [--sim | --sim-global] [-t max_threads] "
+          "[-n events_per_thread]\n"
+          "          [-d device]  (預設 /dev/blackbox)\n",
+          argv0);
+}
+
+int main(int argc, char **argv) {
+  const char *device = "/dev/blackbox";
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  int max_threads = cpus > 1 ? (int)cpus : 4;
+  double base_rate = 0;
+  int failed = 0;
+  int threads, i;
+
+  for (i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--sim") == 0) {
+      run_mode = MODE_SIM;
+    } else if (strcmp(argv[i], "--sim-global") == 0) {
+      run_mode = MODE_SIM_GLOBAL;
+    } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+      max_threads = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+      events_per_thread = atol(argv[++i]);
+    } else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+      device = argv[++i];
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (max_threads < 1 || max_threads > MAX_THREADS || events_per_thread < 1) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  if (run_mode == MODE_DEVICE) {
+    dev_fd = open(device, O_RDWR);
+    if (dev_fd < 0) {
+      fprintf(stderr, "無法開啟 %s: %s (可改用 --sim)\n", device,
+              strerror(errno));
+      return 2;
+    }
+  }
+  for (i = 0; i < MAX_THREADS; i++)
+    pthread_mutex_init(&slots[i].lock, NULL);
+
+  printf("%s, %ld events per thread, %ld CPUs online\n",
+         run_mode == MODE_DEVICE ? device
+         : run_mode == MODE_SIM  ? "[sim] per-writer rings"
+                                 : "[sim] one global lock",
+         events_per_thread, cpus);
+  printf("%7s %10s %9s %12s %8s %8s %6s\n", "threads", "events", "seconds",
+         "events/s", "speedup", "lines", "check");
+
+  for (threads = 1;; threads *= 2) {
+    pthread_t tids[MAX_THREADS];
+    long long start;
+    double seconds, rate;
+    int lines, bad, errors = 0;
+
+    if (threads > max_threads)
+      threads = max_threads;
+
+    if (run_mode == MODE_DEVICE) {
+      if (ioctl(dev_fd, CLEAR_LOG) < 0) {
+        perror("CLEAR_LOG");
+        return 2;
+      }
+    } else {
+      sim_reset();
+    }
+
+    // 所有執行緒就緒後同時開始，計時從放行到最後一個結束
+    pthread_barrier_init(&start_barrier, NULL, threads + 1);
+    for (i = 0; i < threads; i++)
+      pthread_create(&tids[i], NULL, writer, (void *)(long)i);
+    pthread_barrier_wait(&start_barrier);
+    start = now_ns();
+    for (i = 0; i < threads; i++) {
+      void *ret;
+      pthread_join(tids[i], &ret);
+      if (ret)
+        errors++;
+    }
+    seconds = (now_ns() - start) / 1e9;
+    pthread_barrier_destroy(&start_barrier);
+    if (errors)
+      return 2;
+
+    rate = threads * events_per_thread / seconds;
+    if (threads == 1)
+      base_rate = rate;
+    bad = verify(threads, &lines);
+    printf("%7d %10ld %9.3f %12.0f %7.2fx %8d %6s\n", threads,
+           threads * events_per_thread, seconds, rate, rate / base_rate, lines,
+           bad ? "FAIL" : "ok");
+    if (bad)
+      failed = 1;
+
+    if (threads == max_threads)
+      break;
+  }
+
+  if (failed) {
+    printf("FAIL: events out of order or malformed\n");
+    return 1;
+  }
+  printf("PASS\n");
+  return 0;
+}
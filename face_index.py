@@ -0,0 +1,205 @@
+import os
+import sys
+import struct
+import pickle
+import argparse
+import fcntl
+import json
+import numpy as np
+
+# ========== 人臉特徵索引 (與 GuardianEye_QT/faceindex.h 相同的檔案格式) ==========
+# [0, 64)   Header: magic "GEFI", version, dim, dtype, count, capacity, labelBytes, recordBytes, reserved[32]
+# [64, ...) capacity 筆 Record，每筆 = label[32] (UTF-8, 以 0 補齊) + dim 維向量 (float32/float16)
+
+MAGIC = b'GEFI'
+VERSION = 1
+DIM = 128
+LABEL_BYTES = 32
+HEADER_FMT = '<4s7I32x'
+HEADER_SIZE = struct.calcsize(HEADER_FMT)
+INITIAL_CAPACITY = 64
+DTYPES = {0: np.float32, 1: np.float16}
+
+# 偵測到人臉卻取不到特徵向量 (側臉、模糊) 時的陌生人信心度，
+# 與 DetectionFusion 的 minConfidence 相同，連續出現仍會觸發警報
+UNIDENTIFIED_CONFIDENCE = 0.5
+
+
+def match_confidence(distance, tolerance):
+    """最近鄰距離換成 (是否為已登錄身分, 信心度)
+    已登錄：1 - 距離；陌生人：距離剛好等於容忍值時為 0.5，越遠越確定，線性升到 1.0"""
+    if distance < tolerance:
+        return True, float(1.0 - distance)
+    span = max(1e-6, 1.0 - tolerance)
+    return False, float(min(1.0, 0.5 + 0.5 * (distance - tolerance) / span))
+
+
+class FaceIndex:
+    def __init__(self, path, create=False, dtype='float32'):
+        self.path = path
+        if not os.path.exists(path):
+            if not create:
+                raise FileNotFoundError(path)
+            code = 1 if dtype == 'float16' else 0
+            record = LABEL_BYTES + DIM * np.dtype(DTYPES[code]).itemsize
+            with open(path, 'wb') as f:
+                f.write(struct.pack(HEADER_FMT, MAGIC, VERSION, DIM, code, 0,
+                                    INITIAL_CAPACITY, LABEL_BYTES, record))
+                f.truncate(HEADER_SIZE + INITIAL_CAPACITY * record)
+        self._map = None
+        self._count = -1
+        self.refresh()
+
+    def _read_header(self):
+        with open(self.path, 'rb') as f:
+            magic, ver, dim, dtype, count, cap, lbytes, rbytes = struct.unpack(
+                HEADER_FMT, f.read(HEADER_SIZE))
+        if magic != MAGIC or ver != VERSION or dim != DIM or lbytes != LABEL_BYTES:
+            raise ValueError(f"FaceIndex 格式不符: {self.path}")
+        return dtype, count, cap, rbytes
+
+    def refresh(self):
+        """重新讀取 header；Qt 端或其他行程新增身分後不需重啟即可看到"""
+        dtype, count, cap, rbytes = self._read_header()
+        if count == self._count:
+            return
+        self.dtype = DTYPES[dtype]
+        self.record_bytes = rbytes
+        self.capacity = cap
+        self._count = count
+        if count == 0:
+            self.labels, self.vectors = [], np.zeros((0, DIM), np.float32)
+            return
+        rec = np.dtype([('label', f'S{LABEL_BYTES}'), ('vec', self.dtype, (DIM,))])
+        assert rec.itemsize == rbytes
+        self._map = np.memmap(self.path, dtype=rec, mode='r', offset=HEADER_SIZE, shape=(count,))
+        self.labels = [l.decode('utf-8', 'ignore') for l in self._map['label']]
+        # 查詢用 float32 矩陣與其平方範數只在身分變動時計算一次
+        self.vectors = np.ascontiguousarray(self._map['vec'], dtype=np.float32)
+        self._norms = np.einsum('ij,ij->i', self.vectors, self.vectors)
+
+    def __len__(self):
+        return self._count
+
+    def enroll(self, label, vector):
+        vector = np.asarray(vector, dtype=np.float32).reshape(DIM)
+        with open(self.path, 'r+b') as f:
+            # 與 Qt 端 FaceIndex::enroll 相同的 flock：讀 header 到更新 count 之間不讓
+            # 其他行程插入，否則兩邊會寫到同一筆或各自擴充檔案
+            fcntl.flock(f, fcntl.LOCK_EX)
+            dtype, count, cap, rbytes = self._read_header()
+            if count >= cap:
+                cap *= 2
+                f.truncate(HEADER_SIZE + cap * rbytes)
+            f.seek(HEADER_SIZE + count * rbytes)
+            f.write(label.encode('utf-8')[:LABEL_BYTES - 1].ljust(LABEL_BYTES, b'\0'))
+            f.write(vector.astype(DTYPES[dtype]).tobytes())
+            f.flush()
+            # 紀錄先寫入，最後才更新 count / capacity
+            f.seek(16)
+            f.write(struct.pack('<II', count + 1, cap))
+        self.refresh()
+        return count
+
+    def search(self, queries, k=1, max_distance=0.0):
+        """批次查詢：queries 為 (n, 128)，回傳每個 query 的 [(label, distance), ...]"""
+        q = np.atleast_2d(np.asarray(queries, dtype=np.float32))
+        if self._count <= 0:
+            return [[] for _ in range(len(q))]
+        # |q - v|^2 = |q|^2 - 2 q.v + |v|^2，一次矩陣乘法算完所有距離
+        d2 = (np.einsum('ij,ij->i', q, q)[:, None] - 2.0 * q @ self.vectors.T + self._norms[None, :])
+        k = min(k, self._count)
+        idx = np.argpartition(d2, k - 1, axis=1)[:, :k]
+        results = []
+        for row, cand in zip(d2, idx):
+            cand = cand[np.argsort(row[cand])]
+            dist = np.sqrt(np.maximum(row[cand], 0.0))
+            results.append([(self.labels[i], float(d)) for i, d in zip(cand, dist)
+                            if max_distance <= 0 or d < max_distance])
+        return results
+
+
+# ========== 標籤角色 ==========
+# 索引只存標籤；哪些標籤算「主人」記在旁邊的 <index>.roles.json：{"owners": ["OWNER", ...]}
+# 沒有此檔時只有 OWNER 標籤 (migrate_pickle 的預設) 視為主人，其他已登錄身分仍當陌生人
+
+def roles_path(index_path):
+    return os.path.splitext(index_path)[0] + '.roles.json'
+
+
+def load_owner_labels(index_path):
+    try:
+        with open(roles_path(index_path), 'r', encoding='utf-8') as f:
+            return set(json.load(f).get('owners', []))
+    except FileNotFoundError:
+        return {'OWNER'}
+
+
+def set_owner_label(index_path, label, owner=True):
+    owners = load_owner_labels(index_path)
+    if owner:
+        owners.add(label)
+    else:
+        owners.discard(label)
+    tmp = roles_path(index_path) + '.tmp'
+    with open(tmp, 'w', encoding='utf-8') as f:
+        json.dump({'owners': sorted(owners)}, f, ensure_ascii=False)
+    os.replace(tmp, roles_path(index_path))  # 讀取端不會看到寫一半的檔案
+    return owners
+
+
+def classify_face(label, distance, tolerance, owner_labels):
+    """最近鄰結果換成 (face_id, 信心度, 標籤)：只有主人標籤才是 OWNER，
+    其他已登錄身分照樣當陌生人 (附上標籤)，未登錄者標籤為 None"""
+    known, conf = match_confidence(distance, tolerance)
+    if not known:
+        return "STRANGER", conf, None
+    return ("OWNER" if label in owner_labels else "STRANGER"), conf, label
+
+
+def migrate_pickle(pkl_path, index_path, label='OWNER'):
+    """將舊的 owner_face.pkl 轉入索引檔"""
+    with open(pkl_path, 'rb') as f:
+        encodings = pickle.load(f)
+    index = FaceIndex(index_path, create=True)
+    for enc in encodings:
+        index.enroll(label, enc)
+    return index
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description='Guardian Eye face index tool')
+    parser.add_argument('--index', default='./models/faces.idx')
+    sub = parser.add_subparsers(dest='cmd')
+    p = sub.add_parser('migrate', help='import owner_face.pkl')
+    p.add_argument('pkl', nargs='?', default='./models/owner_face.pkl')
+    p.add_argument('--label', default='OWNER')
+    p = sub.add_parser('enroll', help='enroll faces from image files')
+    p.add_argument('label')
+    p.add_argument('images', nargs='+')
+    p.add_argument('--owner', action='store_true', help='treat this label as an owner')
+    sub.add_parser('list', help='list enrolled identities')
+    args = parser.parse_args()
+
+    if args.cmd == 'migrate':
+        idx = migrate_pickle(args.pkl, args.index, args.label)
+        print(f"[INFO] Migrated {len(idx)} encodings into {args.index}")
+    elif args.cmd == 'enroll':
+        import face_recognition
+        idx = FaceIndex(args.index, create=True)
+        for path in args.images:
+            encs = face_recognition.face_encodings(face_recognition.load_image_file(path))
+            if not encs:
+                print(f"[WARN] No face found in {path}")
+                continue
+            print(f"[INFO] {path} -> id {idx.enroll(args.label, encs[0])}")
+        if args.owner:
+            set_owner_label(args.index, args.label)
+    elif args.cmd == 'list':
+        idx = FaceIndex(args.index)
+        owners = load_owner_labels(args.index)
+        for i, label in enumerate(idx.labels):
+            print(f"{i}\t{label}\t{'owner' if label in owners else 'known'}")
+    else:
+        parser.print_help()
+        sys.exit(1)
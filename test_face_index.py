@@ -0,0 +1,105 @@
+import multiprocessing
+import os
+import tempfile
+import unittest
+
+import numpy as np
+
+from face_index import (FaceIndex, match_confidence, classify_face, load_owner_labels,
+                        set_owner_label, UNIDENTIFIED_CONFIDENCE, DIM)
+
+# python3 -m unittest test_face_index (只需要 numpy)
+
+FUSION_MIN_CONFIDENCE = 0.5  # GuardianEye_QT/detectionfusion.h 的 minConfidence
+
+
+class MatchConfidenceTest(unittest.TestCase):
+    def test_stranger_near_tolerance_passes_fusion(self):
+        # 原本陌生人信心度是距離本身，0.45~0.5 永遠到不了門檻
+        for dist in (0.45, 0.47, 0.5, 0.6, 0.9, 1.3):
+            known, conf = match_confidence(dist, 0.45)
+            self.assertFalse(known)
+            self.assertGreaterEqual(conf, FUSION_MIN_CONFIDENCE)
+            self.assertLessEqual(conf, 1.0)
+
+    def test_stranger_confidence_grows_with_distance(self):
+        confs = [match_confidence(d, 0.45)[1] for d in (0.45, 0.6, 0.8, 1.0)]
+        self.assertEqual(confs, sorted(confs))
+        self.assertAlmostEqual(confs[0], 0.5)
+        self.assertAlmostEqual(confs[-1], 1.0)
+
+    def test_known_face(self):
+        known, conf = match_confidence(0.3, 0.45)
+        self.assertTrue(known)
+        self.assertAlmostEqual(conf, 0.7)
+
+    def test_unidentified_person_passes_fusion(self):
+        self.assertGreaterEqual(UNIDENTIFIED_CONFIDENCE, FUSION_MIN_CONFIDENCE)
+
+
+def _enroll_many(path, label, n):
+    index = FaceIndex(path)
+    for i in range(n):
+        index.enroll(label, np.full(DIM, i, np.float32))
+
+
+class ClassifyFaceTest(unittest.TestCase):
+    def test_only_owner_labels_are_owner(self):
+        owners = {'OWNER', 'mom'}
+        self.assertEqual(classify_face('mom', 0.3, 0.45, owners)[0], 'OWNER')
+        # 已登錄但不是主人 (例如訪客、黑名單) 仍要觸發陌生人警報
+        face_id, conf, label = classify_face('courier', 0.3, 0.45, owners)
+        self.assertEqual((face_id, label), ('STRANGER', 'courier'))
+        self.assertGreaterEqual(conf, FUSION_MIN_CONFIDENCE)
+
+    def test_unknown_face_has_no_label(self):
+        self.assertEqual(classify_face('OWNER', 0.6, 0.45, {'OWNER'})[::2], ('STRANGER', None))
+
+
+class FaceIndexSearchTest(unittest.TestCase):
+    def setUp(self):
+        fd, self.path = tempfile.mkstemp(suffix='.idx')
+        os.close(fd)
+        os.unlink(self.path)
+
+    def tearDown(self):
+        if os.path.exists(self.path):
+            os.unlink(self.path)
+
+    def test_concurrent_enroll_across_processes(self):
+        # 4 個行程同時註冊並跨過初始容量 (64)：每筆都要保留，沒有互相覆蓋
+        FaceIndex(self.path, create=True)
+        procs = [multiprocessing.Process(target=_enroll_many, args=(self.path, f'p{i}', 40))
+                 for i in range(4)]
+        for p in procs:
+            p.start()
+        for p in procs:
+            p.join()
+        index = FaceIndex(self.path)
+        self.assertEqual(len(index), 160)
+        for i in range(4):
+            self.assertEqual(index.labels.count(f'p{i}'), 40)
+
+    def test_owner_roles_file(self):
+        self.assertEqual(load_owner_labels(self.path), {'OWNER'})
+        set_owner_label(self.path, 'mom')
+        self.assertEqual(load_owner_labels(self.path), {'OWNER', 'mom'})
+        set_owner_label(self.path, 'OWNER', owner=False)
+        self.assertEqual(load_owner_labels(self.path), {'mom'})
+        os.unlink(os.path.splitext(self.path)[0] + '.roles.json')
+
+    def test_stranger_far_from_enrolled(self):
+        index = FaceIndex(self.path, create=True)
+        owner = np.zeros(DIM, np.float32)
+        index.enroll('OWNER', owner)
+        probe = owner.copy()
+        probe[0] = 0.8
+        label, dist = index.search(probe, k=1)[0][0]
+        self.assertEqual(label, 'OWNER')
+        known, conf = match_confidence(dist, 0.45)
+        self.assertFalse(known)
+        self.assertGreaterEqual(conf, FUSION_MIN_CONFIDENCE)
+
+
+if __name__ == '__main__':
+    unittest.main()
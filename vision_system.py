@@ -9,6 +9,8 @@ import json
 import base64
 import argparse
 import signal
+import threading
+from face_index import FaceIndex, migrate_pickle, classify_face, load_owner_labels, UNIDENTIFIED_CONFIDENCE
 
 warnings.filterwarnings("ignore", category=UserWarning)
 
@@ -23,6 +25,7 @@ signal.signal(signal.SIGINT, handle_signal)
 parser = argparse.ArgumentParser()
 parser.add_argument('--qt_mode', action='store_true', help='Enable Qt integration mode (JSON output)')
 parser.add_argument('--camera', type=str, default='0', help='Camera index (default: 0)')
+parser.add_argument('--standby', action='store_true', help='Load models, then wait for {"cmd": "activate"} on stdin before opening the camera')
 args, unknown = parser.parse_known_args()
 
 # 嘗試載入 PyTorch 和 Face Recognition
@@ -75,6 +78,51 @@ def get_csi_pipeline(sensor_id=0, flip_method=2):
         % (sensor_id, flip_method)
     )
 
+# ========== 預覽流量控制 (Qt 端經 stdin 發放 credit) ==========
+class PreviewFlowControl:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.enabled = True
+        self.credits = 0
+        self.credit_mode = False  # 收到第一個 credit 指令前不限制 (相容舊版 Qt)
+        self.min_fps = 0          # 無 credit/預覽關閉時仍保證的影格率 (錄影用)
+        self.last_encode = 0.0
+
+    def handle(self, cmd):
+        with self.lock:
+            if cmd.get('cmd') == 'credit':
+                self.credit_mode = True
+                self.credits += int(cmd.get('n', 1))
+            elif cmd.get('cmd') == 'preview':
+                self.enabled = bool(cmd.get('enabled', True))
+                if not self.enabled:
+                    self.credits = 0
+            elif cmd.get('cmd') == 'min_fps':
+                self.min_fps = max(0, int(cmd.get('fps', 0)))
+
+    def take(self):
+        """回傳 (是否編碼本幀, 是否為 min_fps 強制影格)；一般影格會消耗一點 credit"""
+        with self.lock:
+            now = time.time()
+            if self.enabled and (not self.credit_mode or self.credits > 0):
+                if self.credit_mode:
+                    self.credits -= 1
+                self.last_encode = now
+                return True, False
+            if self.min_fps > 0 and now - self.last_encode >= 1.0 / self.min_fps:
+                self.last_encode = now
+                return True, True
+            return False, False
+
+
+def read_commands(flow):
+    for line in sys.stdin:
+        try:
+            flow.handle(json.loads(line))
+        except ValueError:
+            pass
+
+
 class VisionSystem:
     def __init__(self, yolo_weights='./models/best_pig_model_v5n.pt', face_encoding_file='./models/owner_face.pkl',
                  yolo_conf=0.6, face_tolerance=0.45, motion_threshold=1000): 
@@ -119,17 +167,25 @@ class VisionSystem:
             print(json.dumps({"status": "loading", "msg": "正在載入人臉資料庫..."}))
             sys.stdout.flush()
         
-        print(f"[DEBUG] Loading face encodings from: {face_encoding_file}")
-        self.owner_encodings = []
-        if os.path.exists(face_encoding_file):
-            try:
-                with open(face_encoding_file, 'rb') as f:
-                    self.owner_encodings = pickle.load(f)
-                print(f"[INFO] Loaded {len(self.owner_encodings)} face identities.")
-            except Exception as e:
-                print(f"[ERROR] Failed to load face file: {e}")
-                import traceback
-                traceback.print_exc()
+        # 人臉特徵改存於記憶體映射索引 (models/faces.idx)，首次啟動時自動轉入舊的 pkl
+        index_file = os.path.join(os.path.dirname(face_encoding_file), 'faces.idx')
+        print(f"[DEBUG] Loading face index from: {index_file}")
+        self.face_index = None
+        self.index_file = index_file
+        self.owner_labels = load_owner_labels(index_file)
+        print(f"[INFO] Owner labels: {sorted(self.owner_labels)}")
+        try:
+            if not os.path.exists(index_file) and os.path.exists(face_encoding_file):
+                print(f"[INFO] Migrating {face_encoding_file} -> {index_file}")
+                self.face_index = migrate_pickle(face_encoding_file, index_file)
+            elif os.path.exists(index_file):
+                self.face_index = FaceIndex(index_file)
+            if self.face_index is not None:
+                print(f"[INFO] Loaded {len(self.face_index)} face identities.")
+        except Exception as e:
+            print(f"[ERROR] Failed to load face index: {e}")
+            import traceback
+            traceback.print_exc()
         
         self.face_tolerance = face_tolerance
         self.motion_threshold = motion_threshold
@@ -139,7 +195,8 @@ class VisionSystem:
         
         self.last_result = {
             'pig_detected': False, 'pig_conf': 0.0, 'pig_bbox': None,
-            'person_detected': False, 'face_id': 'Unknown', 'face_bbox': None
+            'person_detected': False, 'face_id': 'Unknown', 'face_bbox': None,
+            'face_conf': 0.0
         }
 
     def detect_motion(self, frame):
@@ -165,7 +222,8 @@ class VisionSystem:
             self.motion_cooldown -= 1
             current_res = {
                 'pig_detected': False, 'pig_conf': 0.0, 'pig_bbox': None,
-                'person_detected': False, 'face_id': 'Unknown', 'face_bbox': None
+                'person_detected': False, 'face_id': 'Unknown', 'face_bbox': None,
+                'face_conf': 0.0
             }
 
             # [軌道 A] : 找豬 (每 2 幀)
@@ -184,8 +242,8 @@ class VisionSystem:
                         break 
             else:
                 current_res['pig_detected'] = self.last_result['pig_detected']
-                current_res['pig_conf'] = self.last_result['pig_conf']
-                current_res['pig_bbox'] = self.last_result['pig_bbox']
+                current_res['pig_conf'] = self.last_result.get('pig_conf', 0.0)
+                current_res['pig_bbox'] = self.last_result.get('pig_bbox')
 
             # [軌道 B] : 找人 (每 5 幀)
             if frame_count % 5 == 0:
@@ -198,21 +256,32 @@ class VisionSystem:
                     current_res['person_detected'] = True
                     top, right, bottom, left = [v * 4 for v in locs[0]]
                     current_res['face_bbox'] = [left, top, right, bottom]
-                    if self.owner_encodings:
+                    if self.face_index is not None:
+                        self.face_index.refresh()  # 其他行程新增的身分免重啟即生效
+                        self.owner_labels = load_owner_labels(self.index_file)
+                    if self.face_index is not None and len(self.face_index) > 0:
                         t_enc = time.time()
                         encs = face_recognition.face_encodings(rgb, [(top, right, bottom, left)])
                         if len(encs) > 0:
-                            dists = face_recognition.face_distance(self.owner_encodings, encs[0])
-                            min_dist = np.min(dists)
-                            current_res['face_id'] = "OWNER" if min_dist < self.face_tolerance else "STRANGER"
-                            print(f"[DEBUG] >> Person identified: {current_res['face_id']} (Dist: {min_dist:.3f}, took {time.time() - t_enc:.3f}s)")
+                            label, min_dist = self.face_index.search(encs[0], k=1)[0][0]
+                            current_res['face_id'], current_res['face_conf'], current_res['face_label'] = \
+                                classify_face(label, min_dist, self.face_tolerance, self.owner_labels)
+                            print(f"[DEBUG] >> Person identified: {current_res['face_id']} {label} (Dist: {min_dist:.3f}, took {time.time() - t_enc:.3f}s)")
+                        else:
+                            # 有人但無法比對，一律當陌生人，不能讓信心度停在 0
+                            current_res['face_id'] = "STRANGER"
+                            current_res['face_conf'] = UNIDENTIFIED_CONFIDENCE
+                            print(f"[DEBUG] >> Person identified: STRANGER (no encoding, took {time.time() - t_enc:.3f}s)")
                     else:
                          current_res['face_id'] = "Human"
+                         current_res['face_conf'] = 0.5
                          print(f"[DEBUG] >> Person identified: Human (No encoding database)")
             else:
                 current_res['person_detected'] = self.last_result['person_detected']
                 current_res['face_id'] = self.last_result['face_id']
-                current_res['face_bbox'] = self.last_result['face_bbox']
+                current_res['face_bbox'] = self.last_result.get('face_bbox')
+                current_res['face_conf'] = self.last_result.get('face_conf', 0.0)
+                current_res['face_label'] = self.last_result.get('face_label')
 
             # [衝突解決：優先相信人臉]
             if current_res['person_detected']:
@@ -250,11 +319,28 @@ if __name__ == "__main__":
         print("Select Camera: [1] CSI Onboard  [2] USB Webcam")
         choice = input("Choice: ").strip()
     
+    system = VisionSystem()
+
+    # 備援模式：模型已載入 (暖機)，等主控端送出 activate 才搶攝影機
+    if args.standby:
+        print(json.dumps({"status": "standby", "msg": "備援 AI 已就緒"}))
+        sys.stdout.flush()
+        while True:
+            line = sys.stdin.readline()
+            if not line:
+                sys.exit(0)  # 主控端已關閉
+            try:
+                if json.loads(line).get('cmd') == 'activate':
+                    break
+            except ValueError:
+                pass
+
+    flow = PreviewFlowControl()
     if args.qt_mode:
+        threading.Thread(target=read_commands, args=(flow,), daemon=True).start()
         print(json.dumps({"status": "loading", "msg": "正在開啟攝影機..."}))
         sys.stdout.flush()
 
-    system = VisionSystem()
     cap = None
     if choice == '1':
         cap = cv2.VideoCapture(get_csi_pipeline(), cv2.CAP_GSTREAMER)
@@ -305,20 +391,31 @@ if __name__ == "__main__":
                 t_start = time.time()
 
             results = system.process_frame(frame, frame_counter)
-            display = system.draw_hud(frame, results)
             
             if args.qt_mode:
-                _, buffer = cv2.imencode('.jpg', display, [cv2.IMWRITE_JPEG_QUALITY, 80])
-                img_base64 = base64.b64encode(buffer).decode('utf-8')
+                # 偵測結果每幀都送 (很小、不需 credit)；影像只在持有 credit 時才編碼
                 output = {
-                    "img": img_base64,
+                    "seq": frame_counter,
                     "pig_detected": results['pig_detected'],
+                    "pig_conf": results.get('pig_conf', 0.0),
+                    "pig_bbox": results.get('pig_bbox'),
                     "person_detected": results['person_detected'],
-                    "face_id": results['face_id']
+                    "face_id": results['face_id'],
+                    "face_conf": results.get('face_conf', 0.0),
+                    "face_bbox": results.get('face_bbox'),
+                    "face_label": results.get('face_label')
                 }
+                encode, forced = flow.take()
+                if encode:
+                    display = system.draw_hud(frame, results)
+                    _, buffer = cv2.imencode('.jpg', display, [cv2.IMWRITE_JPEG_QUALITY, 80])
+                    output["img"] = base64.b64encode(buffer).decode('utf-8')
+                    if forced:
+                        output["forced"] = True
                 print(json.dumps(output))
                 sys.stdout.flush()
             else:
+                display = system.draw_hud(frame, results)
                 cv2.imshow("Guardian Eye", display)
                 if cv2.waitKey(1) & 0xFF == ord('q'): break
     finally: